@@ -9,7 +9,16 @@ MAX_PACKET_SIZE = 48
 
 class RequestType(enum.IntEnum):
     ReadMemory = 1,
-    WriteMemory = 2
+    WriteMemory = 2,
+    ProfilerControl = 5,
+    ProfilerRead = 6
+
+class ProfilerAction(enum.IntEnum):
+    Disable = 0,
+    Enable = 1,
+    Reset = 2,
+    SnapshotJson = 3,
+    SnapshotCsv = 4
 
 BORKED3DS_PORT = 45987
 
@@ -90,6 +99,50 @@ class Borked3DS:
                 return False
         return True
 
+    def _profiler_control(self, action):
+        request_data = struct.pack("I", action)
+        request, request_id = self._generate_header(RequestType.ProfilerControl, len(request_data))
+        request += request_data
+        self.socket.sendto(request, (self.address, BORKED3DS_PORT))
+
+        raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+        return self._read_and_validate_header(raw_reply, request_id, RequestType.ProfilerControl)
+
+    def set_profiler_enabled(self, enabled):
+        """
+        Turns the SVC and service command profiler on or off.
+        """
+        action = ProfilerAction.Enable if enabled else ProfilerAction.Disable
+        return self._profiler_control(action) is not None
+
+    def reset_profiler(self):
+        return self._profiler_control(ProfilerAction.Reset) is not None
+
+    def read_profile(self, csv=False):
+        """
+        Returns the data collected by the profiler as JSON or CSV text.
+        """
+        action = ProfilerAction.SnapshotCsv if csv else ProfilerAction.SnapshotJson
+        reply_data = self._profiler_control(action)
+        if not reply_data:
+            return None
+        size, = struct.unpack("I", reply_data[:4])
+
+        result = bytes()
+        while len(result) < size:
+            request_data = struct.pack("II", len(result), MAX_REQUEST_DATA_SIZE)
+            request, request_id = self._generate_header(RequestType.ProfilerRead, len(request_data))
+            request += request_data
+            self.socket.sendto(request, (self.address, BORKED3DS_PORT))
+
+            raw_reply = self.socket.recv(MAX_PACKET_SIZE)
+            reply_data = self._read_and_validate_header(raw_reply, request_id, RequestType.ProfilerRead)
+            if not reply_data:
+                return None
+            result += reply_data
+
+        return result.decode("utf-8")
+
 if "__main__" == __name__:
     import doctest
     doctest.testmod(extraglobs={'c': Borked3DS()})
@@ -3,17 +3,32 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
 #include <cstddef>
+#include <limits>
 #include "audio_core/dsp_interface.h"
 #include "audio_core/sink.h"
 #include "audio_core/sink_details.h"
 #include "common/assert.h"
 #include "common/settings.h"
 #include "core/core.h"
+#include "core/core_timing.h"
 #include "core/dumping/backend.h"
 
 namespace AudioCore {
 
+namespace {
+/// The output queue is allowed to hold this many sink callbacks worth of audio, plus a frame of
+/// slack. Less risks running dry between two callbacks, more only adds latency.
+constexpr std::size_t QueuedCallbacks = 3;
+/// The DSP produces a whole emulated video frame worth of audio at once.
+constexpr std::size_t VideoFrameSamples =
+    static_cast<std::size_t>(native_sample_rate / SCREEN_REFRESH_RATE) + 1;
+/// A backlog above the limit is only trimmed once it has lasted this long, so that the bursts
+/// in which the DSP produces audio are left alone.
+constexpr std::size_t TrimWindowSamples = native_sample_rate / 4;
+} // Anonymous namespace
+
 DspInterface::DspInterface(Core::System& system_) : system(system_) {}
 
 DspInterface::~DspInterface() = default;
@@ -37,12 +52,27 @@ void DspInterface::EnableStretching(bool enable) {
     enable_time_stretching = enable;
 }
 
+DspInterface::OutputStats DspInterface::GetOutputStats() const {
+    return {underruns.load(), overruns.load()};
+}
+
+void DspInterface::QueueFrame(const StereoFrame16& frame) {
+    // The callback trims any lasting backlog, so audio is only lost here when the sink stopped
+    // asking for it. Dropping a whole frame keeps the rest of the queued audio intact.
+    if (fifo.Capacity() - fifo.Size() < frame.size()) {
+        ++overruns;
+        return;
+    }
+    fifo.Push(frame.data(), frame.size());
+    fifo_fed = true;
+}
+
 void DspInterface::OutputFrame(StereoFrame16 frame) {
     if (!sink) {
         return;
     }
 
-    fifo.Push(frame.data(), frame.size());
+    QueueFrame(frame);
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -55,7 +85,11 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
         return;
     }
 
-    fifo.Push(&sample, 1);
+    pending_frame[pending_samples++] = sample;
+    if (pending_samples == pending_frame.size()) {
+        QueueFrame(pending_frame);
+        pending_samples = 0;
+    }
 
     auto video_dumper = system.GetVideoDumper();
     if (video_dumper && video_dumper->IsDumping()) {
@@ -63,6 +97,33 @@ void DspInterface::OutputSample(std::array<s16, 2> sample) {
     }
 }
 
+std::size_t DspInterface::QueueLimit(std::size_t num_frames) const {
+    // The queue has to absorb a video frame of audio arriving at once while the sink still asks
+    // for a callback worth of it. The limit follows the callback size down as well as up.
+    const std::size_t samples =
+        std::max(VideoFrameSamples + num_frames, QueuedCallbacks * num_frames);
+    const std::size_t frames = (samples + samples_per_frame - 1) / samples_per_frame + 1;
+    return std::min(frames * samples_per_frame, fifo.Capacity());
+}
+
+void DspInterface::TrimBacklog(std::size_t num_frames) {
+    // The lowest level the queue drained to over the window is audio that was never needed to
+    // cover a burst, only latency. Whatever of it is above the limit goes, in whole frames.
+    min_backlog = std::min(min_backlog, fifo.Size());
+    trim_window += num_frames;
+    if (trim_window < TrimWindowSamples) {
+        return;
+    }
+
+    const std::size_t limit = QueueLimit(num_frames);
+    if (min_backlog > limit) {
+        const std::size_t excess = (min_backlog - limit) / samples_per_frame * samples_per_frame;
+        overruns += fifo.Discard(excess) / samples_per_frame;
+    }
+    min_backlog = std::numeric_limits<std::size_t>::max();
+    trim_window = 0;
+}
+
 void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
     // Determine if we should stretch based on the current emulation speed.
     const auto perf_stats = system.GetLastPerfStats();
@@ -75,20 +136,26 @@ void DspInterface::OutputCallback(s16* buffer, std::size_t num_frames) {
 
     std::size_t frames_written = 0;
     if (performing_time_stretching) {
-        const std::vector<s16> in{fifo.Pop()};
-        const std::size_t num_in{in.size() / 2};
-        frames_written = time_stretcher.Process(in.data(), num_in, buffer, num_frames);
+        // The stretcher reads the queued samples in place.
+        const auto in = fifo.Peek();
+        frames_written = time_stretcher.Process(in, buffer, num_frames);
+        fifo.Discard((in[0].size() + in[1].size()) / 2);
     } else {
         if (flushing_time_stretcher) {
             time_stretcher.Flush();
-            frames_written = time_stretcher.Process(nullptr, 0, buffer, num_frames);
+            frames_written = time_stretcher.Process({}, buffer, num_frames);
             flushing_time_stretcher = false;
 
             // Make sure any frames that did not fit are cleared from the time stretcher,
             // so that they do not bleed into the next time the stretcher is enabled.
             time_stretcher.Clear();
         }
-        frames_written += fifo.Pop(buffer, num_frames - frames_written);
+        frames_written += fifo.Pop(buffer + 2 * frames_written, num_frames - frames_written);
+        TrimBacklog(num_frames);
+    }
+
+    if (fifo_fed.exchange(false) && frames_written < num_frames) {
+        ++underruns;
     }
 
     if (frames_written > 0) {
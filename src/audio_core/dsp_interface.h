@@ -5,6 +5,9 @@
 
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <span>
 #include <boost/serialization/access.hpp>
@@ -107,20 +110,50 @@ public:
     /// Enable/Disable audio stretching.
     void EnableStretching(bool enable);
 
+    struct OutputStats {
+        /// Sink callbacks that ran out of audio while the DSP was producing it
+        u64 underruns;
+        /// Frames dropped because the output queue was full, or trimmed from it because the DSP
+        /// kept more audio queued than the sink needed
+        u64 overruns;
+    };
+
+    /// Returns the output counters since the DSP was created.
+    OutputStats GetOutputStats() const;
+
 protected:
     void OutputFrame(StereoFrame16 frame);
     void OutputSample(std::array<s16, 2> sample);
+    /// Fills the buffer with `num_frames` stereo frames of queued audio, as the sink asks for.
+    void OutputCallback(s16* buffer, std::size_t num_frames);
 
 private:
     void FlushResidualStretcherAudio();
-    void OutputCallback(s16* buffer, std::size_t num_frames);
+    void QueueFrame(const StereoFrame16& frame);
+    std::size_t QueueLimit(std::size_t num_frames) const;
+    void TrimBacklog(std::size_t num_frames);
 
     Core::System& system;
 
     std::atomic<bool> enable_time_stretching = false;
     std::atomic<bool> performing_time_stretching = false;
     std::atomic<bool> flushing_time_stretcher = false;
-    Common::RingBuffer<s16, 0x2000, 2> fifo;
+
+    /// Samples between the DSP and the sink callback. Whole frames are queued as they are
+    /// produced, and the callback trims the queue back to QueueLimit when it stays above it.
+    Common::RingBuffer<s16, 0x4000, 2> fifo;
+    /// Lowest queue level seen by the callbacks of the current trim window, and its length
+    std::size_t min_backlog = std::numeric_limits<std::size_t>::max();
+    std::size_t trim_window = 0;
+    /// Set when a frame is queued, so that the callback can tell underruns from silence
+    std::atomic<bool> fifo_fed = false;
+    std::atomic<u64> underruns = 0;
+    std::atomic<u64> overruns = 0;
+
+    /// Samples from OutputSample that do not fill a frame yet
+    StereoFrame16 pending_frame{};
+    std::size_t pending_samples = 0;
+
     std::array<s16, 2> last_frame{};
     TimeStretcher time_stretcher;
     std::unique_ptr<Sink> sink;
@@ -4,6 +4,8 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <atomic>
+#include <thread>
 
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
@@ -25,6 +27,7 @@
 #include "common/hash.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
+#include "common/thread_worker.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 
@@ -76,6 +79,8 @@ private:
     HLE::SharedMemory& WriteRegion();
 
     StereoFrame16 GenerateCurrentFrame();
+    /// Ticks sources and generates their intermediate mixes, until every source has been claimed.
+    void TickSources(HLE::SharedMemory& read, HLE::SharedMemory& write);
     bool Tick();
     void AudioTickCallback(s64 cycles_late);
 
@@ -92,6 +97,14 @@ private:
     }};
     HLE::Mixers mixers{};
 
+    /// Intermediate mixes of each source, summed in source order so that the result does not
+    /// depend on which thread ticked a source.
+    std::array<std::array<QuadFrame32, 3>, HLE::num_sources> source_mixes{};
+    std::array<bool, HLE::num_sources> source_mixed{};
+    std::atomic<std::size_t> next_source{};
+    /// Workers that tick sources along with the emulation thread, if parallel mixing is enabled.
+    std::unique_ptr<Common::ThreadWorker> source_workers;
+
     DspHle& parent;
     Core::Timing& core_timing;
     Core::TimingEventType* tick_event{};
@@ -121,6 +134,12 @@ DspHle::Impl::Impl(DspHle& parent_, Memory::MemorySystem& memory, Core::Timing&
     }
 
     aac_decoder = std::make_unique<HLE::AACDecoder>(memory);
+
+    // The emulation thread ticks sources too, and a few workers are enough for 24 sources.
+    const std::size_t num_workers = std::min(std::thread::hardware_concurrency() / 2, 4U);
+    if (Settings::values.parallel_audio_mixing.GetValue() && num_workers > 1) {
+        source_workers = std::make_unique<Common::ThreadWorker>(num_workers - 1, "DspHle workers");
+    }
     tick_event =
         core_timing.RegisterEvent("AudioCore::DspHle::tick_event", [this](u64, s64 cycles_late) {
             this->AudioTickCallback(cycles_late);
@@ -368,18 +387,52 @@ HLE::SharedMemory& DspHle::Impl::WriteRegion() {
     return CurrentRegionIndex() != 0 ? dsp_memory.region_0 : dsp_memory.region_1;
 }
 
+void DspHle::Impl::TickSources(HLE::SharedMemory& read, HLE::SharedMemory& write) {
+    for (std::size_t i = next_source++; i < HLE::num_sources; i = next_source++) {
+        const auto status =
+            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        write.source_statuses.status[i] = status;
+
+        // Disabled sources do not contribute to the mixes
+        source_mixed[i] = status.is_enabled != 0;
+        if (!source_mixed[i]) {
+            continue;
+        }
+        for (std::size_t mix = 0; mix < 3; mix++) {
+            source_mixes[i][mix].fill({});
+            sources[i].MixInto(source_mixes[i][mix], mix);
+        }
+    }
+}
+
 StereoFrame16 DspHle::Impl::GenerateCurrentFrame() {
     HLE::SharedMemory& read = ReadRegion();
     HLE::SharedMemory& write = WriteRegion();
 
-    std::array<QuadFrame32, 3> intermediate_mixes = {};
-
     // Generate intermediate mixes
+    next_source = 0;
+    if (source_workers) {
+        for (std::size_t i = 0; i < source_workers->NumWorkers(); i++) {
+            source_workers->QueueWork([this, &read, &write] { TickSources(read, write); });
+        }
+    }
+    TickSources(read, write);
+    if (source_workers) {
+        source_workers->WaitForRequests();
+    }
+
+    std::array<QuadFrame32, 3> intermediate_mixes = {};
     for (std::size_t i = 0; i < HLE::num_sources; i++) {
-        write.source_statuses.status[i] =
-            sources[i].Tick(read.source_configurations.config[i], read.adpcm_coefficients.coeff[i]);
+        if (!source_mixed[i]) {
+            continue;
+        }
         for (std::size_t mix = 0; mix < 3; mix++) {
-            sources[i].MixInto(intermediate_mixes[mix], mix);
+            for (std::size_t samplei = 0; samplei < samples_per_frame; samplei++) {
+                for (std::size_t channeli = 0; channeli < 4; channeli++) {
+                    intermediate_mixes[mix][samplei][channeli] +=
+                        source_mixes[i][mix][samplei][channeli];
+                }
+            }
         }
     }
 
@@ -4,9 +4,19 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cmath>
+#include <tuple>
+#include <vector>
 #include "audio_core/interpolate.h"
+#include "common/arch.h"
 #include "common/assert.h"
 
+#if BORKED3DS_ARCH(x86_64)
+#include <emmintrin.h>
+#elif BORKED3DS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
 namespace AudioCore::AudioInterp {
 
 // Calculations are done in fixed point with 24 fractional bits.
@@ -14,9 +24,10 @@ namespace AudioCore::AudioInterp {
 constexpr u64 scale_factor = 1 << 24;
 constexpr u64 scale_mask = scale_factor - 1;
 
-/// Here we step over the input in steps of rate, until we consume all of the input.
-/// Three adjacent samples are passed to fn each step.
-template <typename Function>
+/// Here we step over the input in steps of rate, until we consume all of the input. The historical
+/// samples and the input are laid out in one contiguous window, and a pointer to Taps adjacent
+/// samples of the window is passed to fn each step.
+template <std::size_t Taps, typename Function>
 static void StepOverSamples(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
                             std::size_t& outputi, Function fn) {
     ASSERT(rate > 0);
@@ -24,54 +35,217 @@ static void StepOverSamples(State& state, StereoBuffer16& input, float rate, Ste
     if (input.empty())
         return;
 
-    input.insert(input.begin(), {state.xn2, state.xn1});
+    constexpr std::size_t history_size = std::tuple_size_v<decltype(state.history)>;
+    static_assert(Taps >= 1 && Taps <= history_size + 1);
+    // Each filter ends at the same sample, so that they all consume the input at the same pace.
+    constexpr std::size_t window_offset = history_size + 1 - Taps;
 
     const u64 step_size = static_cast<u64>(rate * scale_factor);
+
+    // Only the part of the input that can be reached before the output is full is copied.
+    const u64 last_fposition = state.fposition + (output.size() - outputi) * step_size;
+    const std::size_t input_size =
+        std::min<std::size_t>(input.size(), last_fposition / scale_factor + 1);
+
+    thread_local std::vector<StereoBuffer16::Sample> window;
+    window.resize(history_size + input_size);
+    std::copy(state.history.begin(), state.history.end(), window.begin());
+    std::copy_n(input.data(), input_size, window.begin() + history_size);
+
     u64 fposition = state.fposition;
     std::size_t inputi = 0;
 
     while (outputi < output.size()) {
         inputi = static_cast<std::size_t>(fposition / scale_factor);
 
-        if (inputi + 2 >= input.size()) {
-            inputi = input.size() - 2;
+        if (inputi >= input_size) {
+            inputi = input_size;
             break;
         }
 
         u64 fraction = fposition & scale_mask;
-        output[outputi++] = fn(fraction, input[inputi], input[inputi + 1], input[inputi + 2]);
+        output[outputi++] = fn(fraction, window.data() + window_offset + inputi);
 
         fposition += step_size;
     }
 
-    state.xn2 = input[inputi];
-    state.xn1 = input[inputi + 1];
+    std::copy_n(window.begin() + inputi, history_size, state.history.begin());
     state.fposition = fposition - inputi * scale_factor;
 
-    input.erase(input.begin(), std::next(input.begin(), inputi + 2));
+    input.Discard(inputi);
 }
 
 void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
           std::size_t& outputi) {
-    StepOverSamples(
+    StepOverSamples<3>(
         state, input, rate, output, outputi,
-        [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) { return x0; });
+        [](u64 fraction, const StereoBuffer16::Sample* x) { return x[0]; });
 }
 
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi) {
     // Note on accuracy: Some values that this produces are +/- 1 from the actual firmware.
-    StepOverSamples(state, input, rate, output, outputi,
-                    [](u64 fraction, const auto& x0, const auto& x1, const auto& x2) {
-                        // This is a saturated subtraction. (Verified by black-box fuzzing.)
-                        s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
-                        s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
-
-                        return std::array<s16, 2>{
-                            static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
-                            static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
-                        };
-                    });
+    StepOverSamples<3>(state, input, rate, output, outputi,
+                       [](u64 fraction, const StereoBuffer16::Sample* x) {
+                           const auto& x0 = x[0];
+                           const auto& x1 = x[1];
+
+                           // This is a saturated subtraction. (Verified by black-box fuzzing.)
+                           s64 delta0 = std::clamp<s64>(x1[0] - x0[0], -32768, 32767);
+                           s64 delta1 = std::clamp<s64>(x1[1] - x0[1], -32768, 32767);
+
+                           return std::array<s16, 2>{
+                               static_cast<s16>(x0[0] + fraction * delta0 / scale_factor),
+                               static_cast<s16>(x0[1] + fraction * delta1 / scale_factor),
+                           };
+                       });
+}
+
+namespace {
+
+// The filter is stored for 256 fractional positions between two input samples, with coefficients
+// in 1.15 fixed point. The coefficients of each phase sum to exactly 1.0, so DC passes unchanged.
+constexpr std::size_t PolyphasePhaseBits = 8;
+constexpr std::size_t PolyphasePhases = 1 << PolyphasePhaseBits;
+constexpr int PolyphaseCoeffBits = 15;
+
+struct PolyphaseFilter {
+    alignas(16) std::array<std::array<s16, PolyphaseTaps>, PolyphasePhases> phases;
+};
+
+/// Highest rate each filter is designed for. Its cutoff is the output Nyquist frequency at that rate.
+constexpr std::array<float, 5> PolyphaseRates{1.0f, 1.5f, 2.0f, 3.0f, 4.0f};
+
+/// Modified Bessel function of the first kind of order zero, for the Kaiser window.
+double BesselI0(double x) {
+    double sum = 1.0;
+    double term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+    }
+    return sum;
+}
+
+PolyphaseFilter MakePolyphaseFilter(float max_rate) {
+    // Cutoff relative to the input Nyquist frequency, with some room for the transition band.
+    const double cutoff = 0.9 / max_rate;
+    constexpr double beta = 6.0;
+    constexpr double half_width = PolyphaseTaps / 2;
+    constexpr double pi = 3.14159265358979323846;
+
+    PolyphaseFilter filter;
+    for (std::size_t phase = 0; phase < PolyphasePhases; phase++) {
+        const double fraction = static_cast<double>(phase) / PolyphasePhases;
+
+        // Tap PolyphaseTaps / 2 - 1 is x[n], the sample before the output position.
+        std::array<double, PolyphaseTaps> h;
+        double sum = 0.0;
+        for (std::size_t tap = 0; tap < PolyphaseTaps; tap++) {
+            const double t = static_cast<double>(tap) - (half_width - 1) - fraction;
+            const double x = pi * cutoff * t;
+            const double sinc = t == 0.0 ? 1.0 : std::sin(x) / x;
+            const double r = t / half_width;
+            const double window = BesselI0(beta * std::sqrt(std::max(0.0, 1.0 - r * r))) /
+                                  BesselI0(beta);
+            h[tap] = sinc * window;
+            sum += h[tap];
+        }
+
+        // Quantize, then put the rounding error in the largest tap so that the sum is exact.
+        auto& coeffs = filter.phases[phase];
+        int total = 0;
+        std::size_t largest = 0;
+        for (std::size_t tap = 0; tap < PolyphaseTaps; tap++) {
+            coeffs[tap] =
+                static_cast<s16>(std::lround(h[tap] / sum * (1 << PolyphaseCoeffBits)));
+            total += coeffs[tap];
+            if (std::abs(coeffs[tap]) > std::abs(coeffs[largest])) {
+                largest = tap;
+            }
+        }
+        coeffs[largest] = static_cast<s16>(coeffs[largest] + (1 << PolyphaseCoeffBits) - total);
+    }
+    return filter;
+}
+
+const PolyphaseFilter& GetPolyphaseFilter(float rate) {
+    static const auto filters = [] {
+        std::array<PolyphaseFilter, PolyphaseRates.size()> filters;
+        for (std::size_t i = 0; i < PolyphaseRates.size(); i++) {
+            filters[i] = MakePolyphaseFilter(PolyphaseRates[i]);
+        }
+        return filters;
+    }();
+
+    for (std::size_t i = 0; i < PolyphaseRates.size(); i++) {
+        if (rate <= PolyphaseRates[i]) {
+            return filters[i];
+        }
+    }
+    return filters.back();
+}
+
+/// Applies one phase of the filter to PolyphaseTaps adjacent samples.
+std::array<s16, 2> ApplyPolyphaseFilter(const StereoBuffer16::Sample* x, const s16* coeffs) {
+    s32 left;
+    s32 right;
+
+#if BORKED3DS_ARCH(x86_64)
+    __m128i acc = _mm_setzero_si128();
+    for (std::size_t tap = 0; tap < PolyphaseTaps; tap += 4) {
+        // L0 R0 L1 R1 L2 R2 L3 R3 -> L0 L1 R0 R1 L2 L3 R2 R3
+        __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + tap));
+        samples = _mm_shufflelo_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        samples = _mm_shufflehi_epi16(samples, _MM_SHUFFLE(3, 1, 2, 0));
+        // c0 c1 c2 c3 -> c0 c1 c0 c1 c2 c3 c2 c3
+        __m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(coeffs + tap));
+        c = _mm_unpacklo_epi32(c, c);
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(samples, c));
+    }
+    // acc holds partial sums L R L R
+    acc = _mm_add_epi32(acc, _mm_srli_si128(acc, 8));
+    left = _mm_cvtsi128_si32(acc);
+    right = _mm_cvtsi128_si32(_mm_srli_si128(acc, 4));
+#elif BORKED3DS_ARCH(arm64)
+    int32x4_t acc_left = vdupq_n_s32(0);
+    int32x4_t acc_right = vdupq_n_s32(0);
+    for (std::size_t tap = 0; tap < PolyphaseTaps; tap += 4) {
+        const int16x4x2_t samples = vld2_s16(reinterpret_cast<const s16*>(x + tap));
+        const int16x4_t c = vld1_s16(coeffs + tap);
+        acc_left = vmlal_s16(acc_left, samples.val[0], c);
+        acc_right = vmlal_s16(acc_right, samples.val[1], c);
+    }
+    left = vaddvq_s32(acc_left);
+    right = vaddvq_s32(acc_right);
+#else
+    left = 0;
+    right = 0;
+    for (std::size_t tap = 0; tap < PolyphaseTaps; tap++) {
+        left += x[tap][0] * coeffs[tap];
+        right += x[tap][1] * coeffs[tap];
+    }
+#endif
+
+    constexpr s32 round = 1 << (PolyphaseCoeffBits - 1);
+    return std::array<s16, 2>{
+        static_cast<s16>(std::clamp((left + round) >> PolyphaseCoeffBits, -32768, 32767)),
+        static_cast<s16>(std::clamp((right + round) >> PolyphaseCoeffBits, -32768, 32767)),
+    };
+}
+
+} // Anonymous namespace
+
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi) {
+    const PolyphaseFilter& filter = GetPolyphaseFilter(rate);
+    StepOverSamples<PolyphaseTaps>(
+        state, input, rate, output, outputi,
+        [&filter](u64 fraction, const StereoBuffer16::Sample* x) {
+            // The top bits of the 24-bit fraction select the phase.
+            const std::size_t phase = fraction >> (24 - PolyphasePhaseBits);
+            return ApplyPolyphaseFilter(x, filter.phases[phase].data());
+        });
 }
 
 } // namespace AudioCore::AudioInterp
@@ -6,19 +6,20 @@
 #pragma once
 
 #include <array>
-#include <deque>
 #include "audio_core/audio_types.h"
+#include "audio_core/stereo_buffer.h"
 #include "common/common_types.h"
 
 namespace AudioCore::AudioInterp {
 
-/// A variable length buffer of signed PCM16 stereo samples.
-using StereoBuffer16 = std::deque<std::array<s16, 2>>;
+using StereoBuffer16 = AudioCore::StereoBuffer16;
+
+/// Number of input samples each output sample of the polyphase filter is computed from.
+constexpr std::size_t PolyphaseTaps = 16;
 
 struct State {
-    /// Two historical samples.
-    std::array<s16, 2> xn1 = {}; ///< x[n-1]
-    std::array<s16, 2> xn2 = {}; ///< x[n-2]
+    /// Historical samples, oldest first. None and Linear only use the last two, x[n-2] and x[n-1].
+    std::array<std::array<s16, 2>, PolyphaseTaps - 1> history = {};
     /// Current fractional position.
     u64 fposition = 0;
 };
@@ -47,4 +48,18 @@ void None(State& state, StereoBuffer16& input, float rate, StereoFrame16& output
 void Linear(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
             std::size_t& outputi);
 
+/**
+ * Polyphase interpolation with a windowed sinc filter of PolyphaseTaps taps. The cutoff frequency
+ * is lowered when decimating, so that content above the output Nyquist frequency is attenuated
+ * instead of aliased. There is an eight-sample predelay.
+ * @param state Interpolation state.
+ * @param input Input buffer.
+ * @param rate Stretch factor. Must be a positive non-zero value.
+ *             rate > 1.0 performs decimation and rate < 1.0 performs upsampling.
+ * @param output The resampled audio buffer.
+ * @param outputi The index of output to start writing to.
+ */
+void Polyphase(State& state, StereoBuffer16& input, float rate, StereoFrame16& output,
+               std::size_t& outputi);
+
 } // namespace AudioCore::AudioInterp
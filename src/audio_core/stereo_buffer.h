@@ -0,0 +1,84 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <vector>
+#include <boost/serialization/array.hpp>
+#include <boost/serialization/split_member.hpp>
+#include <boost/serialization/vector.hpp>
+#include "common/common_types.h"
+
+namespace AudioCore {
+
+/**
+ * A variable length buffer of signed PCM16 stereo samples. The buffer is filled all at once by a
+ * decoder and consumed from the front, so the remaining samples are always contiguous in memory.
+ * The storage is kept when the buffer is refilled, which makes decoding allocation-free once the
+ * largest buffer of a source has been seen.
+ */
+class StereoBuffer16 {
+public:
+    using Sample = std::array<s16, 2>;
+
+    bool empty() const {
+        return read_index == samples.size();
+    }
+
+    std::size_t size() const {
+        return samples.size() - read_index;
+    }
+
+    const Sample* data() const {
+        return samples.data() + read_index;
+    }
+
+    const Sample& operator[](std::size_t i) const {
+        return samples[read_index + i];
+    }
+
+    void clear() {
+        samples.clear();
+        read_index = 0;
+    }
+
+    /// Replaces the contents with count samples, which the caller must write.
+    std::span<Sample> Reset(std::size_t count) {
+        samples.resize(count);
+        read_index = 0;
+        return samples;
+    }
+
+    /// Removes up to count samples from the front.
+    void Discard(std::size_t count) {
+        read_index += std::min(count, size());
+        if (empty()) {
+            clear();
+        }
+    }
+
+private:
+    std::vector<Sample> samples;
+    std::size_t read_index = 0;
+
+    template <class Archive>
+    void save(Archive& ar, const unsigned int) const {
+        const std::vector<Sample> remaining(samples.begin() + read_index, samples.end());
+        ar << remaining;
+    }
+
+    template <class Archive>
+    void load(Archive& ar, const unsigned int) {
+        ar >> samples;
+        read_index = 0;
+    }
+
+    BOOST_SERIALIZATION_SPLIT_MEMBER()
+    friend class boost::serialization::access;
+};
+
+} // namespace AudioCore
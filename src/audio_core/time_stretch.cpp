@@ -32,8 +32,13 @@ void TimeStretcher::SetOutputSampleRate(unsigned int sample_rate) {
     sound_touch->setSampleRate(sample_rate);
 }
 
-std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
+std::size_t TimeStretcher::Process(std::span<const std::span<const s16>> in, s16* out,
                                    std::size_t num_out) {
+    std::size_t num_in = 0;
+    for (const auto buffer : in) {
+        num_in += buffer.size() / 2;
+    }
+
     const double time_delta = static_cast<double>(num_out) / native_sample_rate; // seconds
     double current_ratio = static_cast<double>(num_in) / static_cast<double>(num_out);
 
@@ -68,22 +73,26 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
 
     if constexpr (std::is_floating_point<soundtouch::SAMPLETYPE>()) {
         // The SoundTouch library on most systems expects float samples
-        // use this vector to store input if soundtouch::SAMPLETYPE is a float
-        std::vector<soundtouch::SAMPLETYPE> float_in(2 * num_in);
-        std::vector<soundtouch::SAMPLETYPE> float_out(2 * num_out);
-
-        for (std::size_t i = 0; i < (2 * num_in); i++) {
-            // Conventional integer PCM uses a range of -32768 to 32767,
-            // but float samples use -1 to 1
-            // As a result we need to scale sample values during conversion
-            const float temp = static_cast<float>(in[i]) / std::numeric_limits<s16>::max();
-            float_in[i] = static_cast<soundtouch::SAMPLETYPE>(temp);
+        // use these buffers to store samples if soundtouch::SAMPLETYPE is a float
+        float_in.resize(2 * num_in);
+        float_out.resize(2 * num_out);
+
+        std::size_t float_i = 0;
+        for (std::size_t i = 0; i < in.size() && float_i < float_in.size(); i++) {
+            for (const s16 sample : in[i]) {
+                // Conventional integer PCM uses a range of -32768 to 32767,
+                // but float samples use -1 to 1
+                // As a result we need to scale sample values during conversion
+                float_in[float_i++] = static_cast<float>(sample) / std::numeric_limits<s16>::max();
+            }
         }
 
-        sound_touch->putSamples(float_in.data(), static_cast<u32>(num_in));
+        // Use reinterpret_cast to workaround compile error when SAMPLETYPE is s16.
+        sound_touch->putSamples(reinterpret_cast<const soundtouch::SAMPLETYPE*>(float_in.data()),
+                                static_cast<u32>(num_in));
 
-        const std::size_t samples_received =
-            sound_touch->receiveSamples(float_out.data(), static_cast<u32>(num_out));
+        const std::size_t samples_received = sound_touch->receiveSamples(
+            reinterpret_cast<soundtouch::SAMPLETYPE*>(float_out.data()), static_cast<u32>(num_out));
 
         // Converting output samples back to shorts so we can use them
         for (std::size_t i = 0; i < (2 * num_out); i++) {
@@ -94,8 +103,13 @@ std::size_t TimeStretcher::Process(const s16* in, std::size_t num_in, s16* out,
         return samples_received;
     } else if (std::is_same<soundtouch::SAMPLETYPE, s16>()) {
         // Use reinterpret_cast to workaround compile error when SAMPLETYPE is float.
-        sound_touch->putSamples(reinterpret_cast<const soundtouch::SAMPLETYPE*>(in),
-                                static_cast<u32>(num_in));
+        if (num_in != 0) {
+            for (const auto buffer : in) {
+                sound_touch->putSamples(
+                    reinterpret_cast<const soundtouch::SAMPLETYPE*>(buffer.data()),
+                    static_cast<u32>(buffer.size() / 2));
+            }
+        }
         return sound_touch->receiveSamples(reinterpret_cast<soundtouch::SAMPLETYPE*>(out),
                                            static_cast<u32>(num_out));
     } else {
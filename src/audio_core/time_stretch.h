@@ -8,6 +8,8 @@
 #include <array>
 #include <cstddef>
 #include <memory>
+#include <span>
+#include <vector>
 #include "common/common_types.h"
 
 namespace soundtouch {
@@ -23,12 +25,12 @@ public:
 
     void SetOutputSampleRate(unsigned int sample_rate);
 
-    /// @param in       Input sample buffer
-    /// @param num_in   Number of input frames in `in`
+    /// @param in       Input sample buffers, which are read in order. These are usually the two
+    ///                 halves of a ring buffer.
     /// @param out      Output sample buffer
     /// @param num_out  Desired number of output frames in `out`
     /// @returns Actual number of frames written to `out`
-    std::size_t Process(const s16* in, std::size_t num_in, s16* out, std::size_t num_out);
+    std::size_t Process(std::span<const std::span<const s16>> in, s16* out, std::size_t num_out);
 
     void Clear();
 
@@ -37,6 +39,9 @@ public:
 private:
     std::unique_ptr<soundtouch::SoundTouch> sound_touch;
     double stretch_ratio = 1.0;
+    /// Conversion buffers for when SoundTouch uses float samples, kept to avoid reallocating
+    std::vector<float> float_in;
+    std::vector<float> float_out;
 };
 
 } // namespace AudioCore
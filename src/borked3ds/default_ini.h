@@ -92,6 +92,11 @@ udp_pad_index=
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_cpu_jit =
 
+# Whether to map guest memory into the host address space so the CPU JIT can access it directly.
+# Only supported on Linux and Android. Requires the CPU JIT.
+# 0 (default): Off, 1: On
+use_fastmem =
+
 # The amount of frames to skip (power of two)
 # 0 (default): No frameskip, 1: x2 frameskip, 2: x4 frameskip, 3: x8 frameskip, 4: x16 frameskip.
 frame_skip =
@@ -160,6 +165,20 @@ shaders_accurate_mul =
 # 0: Interpreter (slow), 1 (default): JIT (fast)
 use_shader_jit =
 
+# Whether the software renderer defers triangles into screen tiles and rasterizes them per tile
+# 0 (default): Off, 1: On
+use_sw_tile_binning =
+
+# Whether to shade the vertices of large draws on worker threads when hardware shaders are not used
+# 0 (default): Off, 1: On
+use_parallel_vertex_shading =
+
+# Whether to run GSP commands and PICA command lists on a dedicated GPU thread
+# Only supported by the software renderer; ignored otherwise. Decoded textures are not cached
+# while it is enabled.
+# 0 (default): Off, 1: On
+use_async_gpu =
+
 # Perform presentation on seperate threads. Improves performance on Vulkan in most games.
 # 0: Off, 1 (default): On
 async_presentation =
@@ -338,6 +357,10 @@ enable_audio_stretching =
 # 0 (default): No, 1: Yes
 enable_realtime_audio =
 
+# Whether to process the HLE DSP sources on several threads. The output is the same either way.
+# 0: Off, 1 (default): On
+parallel_audio_mixing =
+
 # Output volume.
 # 1.0 (default): 100%, 0.0; mute
 volume =
@@ -363,6 +386,15 @@ input_device =
 # 1 (default): Yes, 0: No
 use_virtual_sd =
 
+# Size of the in-memory RomFS read cache in MiB. Larger values reduce reads from slow storage
+# 0: Disabled, 16 (default)
+romfs_cache_size =
+
+# Size of the on-disk cache of RomFS data streamed from an Artic Base server, in MiB.
+# Repeat boots of the same title read cached data from disk instead of the network.
+# 0 (default): Disabled
+artic_disk_cache_size =
+
 # Whether to use custom storage locations
 # 1: Yes, 0 (default): No
 use_custom_storage =
@@ -384,6 +416,10 @@ is_new_3ds =
 # 0 (default): No, 1: Yes
 lle_applets =
 
+# Whether savestates after a full savestate only store the memory pages changed since it
+# 0 (default): Off, 1: On
+incremental_savestates =
+
 # The system region that Borked3DS will use during emulation
 # -1: Auto-select (default), 0: Japan, 1: USA, 2: Europe, 3: Australia, 4: China, 5: Korea, 6: Taiwan
 region_value =
@@ -294,6 +294,7 @@ void Config::ReadAudioValues() {
     ReadGlobalSetting(Settings::values.volume);
 
     if (global) {
+        ReadBasicSetting(Settings::values.parallel_audio_mixing);
         ReadBasicSetting(Settings::values.output_type);
         ReadBasicSetting(Settings::values.output_device);
         ReadBasicSetting(Settings::values.input_type);
@@ -477,6 +478,7 @@ void Config::ReadCoreValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_cpu_jit);
+        ReadBasicSetting(Settings::values.use_fastmem);
         ReadBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -487,6 +489,8 @@ void Config::ReadDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
 
     ReadBasicSetting(Settings::values.use_virtual_sd);
+    ReadBasicSetting(Settings::values.romfs_cache_size);
+    ReadBasicSetting(Settings::values.artic_disk_cache_size);
     ReadBasicSetting(Settings::values.use_custom_storage);
 
     const std::string nand_dir =
@@ -717,6 +721,9 @@ void Config::ReadRendererValues() {
 
     if (global) {
         ReadBasicSetting(Settings::values.use_shader_jit);
+        ReadBasicSetting(Settings::values.use_sw_tile_binning);
+        ReadBasicSetting(Settings::values.use_parallel_vertex_shading);
+        ReadBasicSetting(Settings::values.use_async_gpu);
     }
 
     qt_config->endGroup();
@@ -759,6 +766,7 @@ void Config::ReadSystemValues() {
         ReadBasicSetting(Settings::values.steps_per_hour);
         ReadBasicSetting(Settings::values.plugin_loader_enabled);
         ReadBasicSetting(Settings::values.allow_plugin_loader);
+        ReadBasicSetting(Settings::values.incremental_savestates);
     }
 
     qt_config->endGroup();
@@ -937,6 +945,7 @@ void Config::SaveAudioValues() {
     WriteGlobalSetting(Settings::values.volume);
 
     if (global) {
+        WriteBasicSetting(Settings::values.parallel_audio_mixing);
         WriteBasicSetting(Settings::values.output_type);
         WriteBasicSetting(Settings::values.output_device);
         WriteBasicSetting(Settings::values.input_type);
@@ -1059,6 +1068,7 @@ void Config::SaveCoreValues() {
 
     if (global) {
         WriteBasicSetting(Settings::values.use_cpu_jit);
+        WriteBasicSetting(Settings::values.use_fastmem);
         WriteBasicSetting(Settings::values.delay_start_for_lle_modules);
     }
 
@@ -1069,6 +1079,8 @@ void Config::SaveDataStorageValues() {
     qt_config->beginGroup(QStringLiteral("Data Storage"));
 
     WriteBasicSetting(Settings::values.use_virtual_sd);
+    WriteBasicSetting(Settings::values.romfs_cache_size);
+    WriteBasicSetting(Settings::values.artic_disk_cache_size);
     WriteBasicSetting(Settings::values.use_custom_storage);
     WriteSetting(QStringLiteral("nand_directory"),
                  QString::fromStdString(FileUtil::GetUserPath(FileUtil::UserPath::NANDDir)),
@@ -1261,6 +1273,9 @@ void Config::SaveRendererValues() {
     if (global) {
         WriteSetting(QStringLiteral("use_shader_jit"), Settings::values.use_shader_jit.GetValue(),
                      true);
+        WriteBasicSetting(Settings::values.use_sw_tile_binning);
+        WriteBasicSetting(Settings::values.use_parallel_vertex_shading);
+        WriteBasicSetting(Settings::values.use_async_gpu);
     }
 
     qt_config->endGroup();
@@ -1302,6 +1317,7 @@ void Config::SaveSystemValues() {
         WriteBasicSetting(Settings::values.steps_per_hour);
         WriteBasicSetting(Settings::values.plugin_loader_enabled);
         WriteBasicSetting(Settings::values.allow_plugin_loader);
+        WriteBasicSetting(Settings::values.incremental_savestates);
     }
 
     qt_config->endGroup();
@@ -0,0 +1,120 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "common/assert.h"
+#include "common/host_memory.h"
+#include "common/logging/log.h"
+
+namespace Common {
+
+#ifdef __linux__
+
+HostMemory::HostMemory(std::size_t size_) {
+    // Called through syscall as older C libraries, such as Android's, lack the wrapper
+    fd = static_cast<int>(syscall(SYS_memfd_create, "Borked3DS guest memory", MFD_CLOEXEC));
+    if (fd < 0) {
+        LOG_ERROR(Common_Memory, "memfd_create failed: {}", strerror(errno));
+        return;
+    }
+    if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        LOG_ERROR(Common_Memory, "ftruncate failed: {}", strerror(errno));
+        close(fd);
+        fd = -1;
+        return;
+    }
+    void* ptr = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "mmap of the backing memory failed: {}", strerror(errno));
+        close(fd);
+        fd = -1;
+        return;
+    }
+    base = static_cast<u8*>(ptr);
+    size = size_;
+}
+
+HostMemory::~HostMemory() {
+    if (base) {
+        munmap(base, size);
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+}
+
+HostAddressSpace::HostAddressSpace(const HostMemory& backing_, std::size_t size_)
+    : backing{backing_} {
+    if (!backing.IsValid()) {
+        return;
+    }
+    void* ptr = mmap(nullptr, size_, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Reserving the host address space failed: {}", strerror(errno));
+        return;
+    }
+    base = static_cast<u8*>(ptr);
+    size = size_;
+}
+
+HostAddressSpace::~HostAddressSpace() {
+    if (base) {
+        munmap(base, size);
+    }
+}
+
+bool HostAddressSpace::Map(std::size_t offset, std::size_t backing_offset, std::size_t length) {
+    ASSERT(base && offset + length <= size && backing_offset + length <= backing.size);
+    void* ptr = mmap(base + offset, length, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                     backing.fd, static_cast<off_t>(backing_offset));
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Mapping a view of the backing memory failed: {}",
+                  strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+bool HostAddressSpace::Unmap(std::size_t offset, std::size_t length) {
+    ASSERT(base && offset + length <= size);
+    // Replacing the view keeps the range reserved, unlike munmap
+    void* ptr = mmap(base + offset, length, PROT_NONE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_FIXED, -1, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Common_Memory, "Unmapping a view of the backing memory failed: {}",
+                  strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+#else
+
+HostMemory::HostMemory(std::size_t) {}
+
+HostMemory::~HostMemory() = default;
+
+HostAddressSpace::HostAddressSpace(const HostMemory& backing_, std::size_t) : backing{backing_} {}
+
+HostAddressSpace::~HostAddressSpace() = default;
+
+bool HostAddressSpace::Map(std::size_t, std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+bool HostAddressSpace::Unmap(std::size_t, std::size_t) {
+    UNREACHABLE();
+}
+
+#endif
+
+} // namespace Common
@@ -0,0 +1,89 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <cstddef>
+#include <optional>
+#include "common/common_types.h"
+
+namespace Common {
+
+/**
+ * Memory backed by a shareable host memory object, so that views of it can be mapped at arbitrary
+ * offsets of a HostAddressSpace. This is only supported on Linux, where it uses memfd.
+ */
+class HostMemory {
+public:
+    explicit HostMemory(std::size_t size);
+    ~HostMemory();
+
+    HostMemory(const HostMemory&) = delete;
+    HostMemory& operator=(const HostMemory&) = delete;
+
+    /// Returns whether the backing memory was created. Callers should fall back to regular
+    /// allocations otherwise.
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    u8* BackingBasePointer() const {
+        return base;
+    }
+
+    /// Returns the offset of the pointer into the backing memory, or std::nullopt if it does not
+    /// point into it.
+    std::optional<std::size_t> GetOffset(const u8* pointer) const {
+        if (pointer < base || pointer >= base + size) {
+            return std::nullopt;
+        }
+        return static_cast<std::size_t>(pointer - base);
+    }
+
+private:
+    friend class HostAddressSpace;
+
+    int fd = -1;
+    u8* base = nullptr;
+    std::size_t size = 0;
+};
+
+/**
+ * Reserved range of the host address space into which views of HostMemory can be mapped. Any part
+ * without a view is inaccessible and faults when accessed.
+ */
+class HostAddressSpace {
+public:
+    HostAddressSpace(const HostMemory& backing, std::size_t size);
+    ~HostAddressSpace();
+
+    HostAddressSpace(const HostAddressSpace&) = delete;
+    HostAddressSpace& operator=(const HostAddressSpace&) = delete;
+
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    u8* BasePointer() const {
+        return base;
+    }
+
+    /**
+     * Maps the backing memory starting at backing_offset to offset of the address space.
+     * @returns whether the mapping succeeded. On failure the range is left in an unspecified
+     *          state, which callers must make inaccessible with Unmap before using the address
+     *          space again.
+     */
+    [[nodiscard]] bool Map(std::size_t offset, std::size_t backing_offset, std::size_t length);
+
+    /// Makes the range of the address space inaccessible. Returns whether it succeeded.
+    [[nodiscard]] bool Unmap(std::size_t offset, std::size_t length);
+
+private:
+    const HostMemory& backing;
+    u8* base = nullptr;
+    std::size_t size = 0;
+};
+
+} // namespace Common
@@ -93,6 +93,37 @@ public:
         return out;
     }
 
+    /// Gives access to filled slots without popping them. Only the consumer may call this.
+    /// @param max_slots  Maximum number of slots to return
+    /// @returns The slots in order, as up to two contiguous runs when they wrap around the end
+    std::array<std::span<const T>, 2> Peek(std::size_t max_slots = ~std::size_t(0)) const {
+        const std::size_t read_index = m_read_index.load();
+        const std::size_t slots_filled = m_write_index.load() - read_index;
+        const std::size_t peek_count = std::min(slots_filled, max_slots);
+
+        const std::size_t pos = read_index % capacity;
+        const std::size_t first_copy = std::min(capacity - pos, peek_count);
+        const std::size_t second_copy = peek_count - first_copy;
+
+        return {
+            std::span<const T>{m_data.data() + pos * granularity, first_copy * granularity},
+            std::span<const T>{m_data.data(), second_copy * granularity},
+        };
+    }
+
+    /// Pops slots without copying them, usually after reading them with Peek
+    /// @param max_slots  Maximum number of slots to pop
+    /// @returns The number of slots actually popped
+    std::size_t Discard(std::size_t max_slots) {
+        const std::size_t read_index = m_read_index.load();
+        const std::size_t slots_filled = m_write_index.load() - read_index;
+        const std::size_t pop_count = std::min(slots_filled, max_slots);
+
+        m_read_index.store(read_index + pop_count);
+
+        return pop_count;
+    }
+
     /// @returns Number of slots used
     [[nodiscard]] std::size_t Size() const {
         return m_write_index.load() - m_read_index.load();
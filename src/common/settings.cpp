@@ -96,6 +96,7 @@ void LogSettings() {
 
     LOG_INFO(Config, "Borked3DS Configuration:");
     log_setting("Core_UseCpuJit", values.use_cpu_jit.GetValue());
+    log_setting("Core_UseFastmem", values.use_fastmem.GetValue());
     log_setting("Core_CPUClockPercentage", values.cpu_clock_percentage.GetValue());
     log_setting("Core_EnableCustomCPUTicks", values.enable_custom_cpu_ticks.GetValue());
     log_setting("Core_CustomCPUTicks", values.custom_cpu_ticks.GetValue());
@@ -123,6 +124,9 @@ void LogSettings() {
     log_setting("Renderer_UseHwShader", values.use_hw_shader.GetValue());
     log_setting("Renderer_ShadersAccurateMul", values.shaders_accurate_mul.GetValue());
     log_setting("Renderer_UseShaderJit", values.use_shader_jit.GetValue());
+    log_setting("Renderer_UseSwTileBinning", values.use_sw_tile_binning.GetValue());
+    log_setting("Renderer_UseParallelVertexShading", values.use_parallel_vertex_shading.GetValue());
+    log_setting("Renderer_UseAsyncGpu", values.use_async_gpu.GetValue());
     log_setting("Renderer_UseResolutionFactor", values.resolution_factor.GetValue());
     log_setting("Renderer_FrameLimit", values.frame_limit.GetValue());
     log_setting("Renderer_FrameSkip", values.frame_skip.GetValue());
@@ -158,6 +162,7 @@ void LogSettings() {
     log_setting("Audio_InputDevice", values.input_device.GetValue());
     log_setting("Audio_EnableAudioStretching", values.enable_audio_stretching.GetValue());
     log_setting("Audio_EnableRealtime", values.enable_realtime_audio.GetValue());
+    log_setting("Audio_ParallelMixing", values.parallel_audio_mixing.GetValue());
     using namespace Service::CAM;
     log_setting("Camera_OuterRightName", values.camera_name[OuterRightCamera]);
     log_setting("Camera_OuterRightConfig", values.camera_config[OuterRightCamera]);
@@ -169,6 +174,8 @@ void LogSettings() {
     log_setting("Camera_OuterLeftConfig", values.camera_config[OuterLeftCamera]);
     log_setting("Camera_OuterLeftFlip", values.camera_flip[OuterLeftCamera]);
     log_setting("DataStorage_UseVirtualSd", values.use_virtual_sd.GetValue());
+    log_setting("DataStorage_RomFSCacheSize", values.romfs_cache_size.GetValue());
+    log_setting("DataStorage_ArticDiskCacheSize", values.artic_disk_cache_size.GetValue());
     log_setting("DataStorage_HideImages", values.hide_images.GetValue());
     log_setting("DataStorage_UseCustomStorage", values.use_custom_storage.GetValue());
     if (values.use_custom_storage) {
@@ -177,6 +184,7 @@ void LogSettings() {
     }
     log_setting("System_IsNew3ds", values.is_new_3ds.GetValue());
     log_setting("System_LLEApplets", values.lle_applets.GetValue());
+    log_setting("System_IncrementalSavestates", values.incremental_savestates.GetValue());
     log_setting("System_RegionValue", values.region_value.GetValue());
     log_setting("System_PluginLoader", values.plugin_loader_enabled.GetValue());
     log_setting("System_PluginLoaderAllowed", values.allow_plugin_loader.GetValue());
@@ -467,13 +467,17 @@ struct Values {
 
     // Core
     Setting<bool> use_cpu_jit{true, "use_cpu_jit"};
+    Setting<bool> use_fastmem{false, "use_fastmem"};
     SwitchableSetting<u8> frame_skip{0, "frame_skip"};
     SwitchableSetting<s32, true> cpu_clock_percentage{100, 5, 400, "cpu_clock_percentage"};
     SwitchableSetting<bool> is_new_3ds{true, "is_new_3ds"};
     SwitchableSetting<bool> lle_applets{false, "lle_applets"};
+    Setting<bool> incremental_savestates{false, "incremental_savestates"};
 
     // Data Storage
     Setting<bool> use_virtual_sd{true, "use_virtual_sd"};
+    Setting<u32> romfs_cache_size{16, "romfs_cache_size"};
+    Setting<u32> artic_disk_cache_size{0, "artic_disk_cache_size"};
     Setting<bool> use_custom_storage{false, "use_custom_storage"};
     Setting<bool> hide_images{false, "hide_images"};
 
@@ -516,6 +520,9 @@ struct Values {
     SwitchableSetting<bool> shaders_accurate_mul{false, "shaders_accurate_mul"};
     SwitchableSetting<bool> use_vsync_new{true, "use_vsync_new"};
     Setting<bool> use_shader_jit{true, "use_shader_jit"};
+    Setting<bool> use_sw_tile_binning{false, "use_sw_tile_binning"};
+    Setting<bool> use_parallel_vertex_shading{false, "use_parallel_vertex_shading"};
+    Setting<bool> use_async_gpu{false, "use_async_gpu"};
     SwitchableSetting<u32, true> resolution_factor{1, 0, 10, "resolution_factor"};
     SwitchableSetting<double, true> frame_limit{100, 0, 1000, "frame_limit"};
     SwitchableSetting<int, true> turbo_speed{200, 0, 1000, "turbo_speed"};
@@ -593,6 +600,7 @@ struct Values {
     SwitchableSetting<AudioEmulation> audio_emulation{AudioEmulation::HLE, "audio_emulation"};
     SwitchableSetting<bool> enable_audio_stretching{true, "enable_audio_stretching"};
     SwitchableSetting<bool> enable_realtime_audio{false, "enable_realtime_audio"};
+    Setting<bool> parallel_audio_mixing{true, "parallel_audio_mixing"};
     SwitchableSetting<float, true> volume{1.f, 0.f, 1.f, "volume"};
     Setting<AudioCore::SinkType> output_type{AudioCore::SinkType::Auto, "output_type"};
     Setting<std::string> output_device{"auto", "output_device"};
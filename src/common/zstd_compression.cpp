@@ -3,8 +3,10 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <cstring>
 #include <zstd.h>
 
+#include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/zstd_compression.h"
 
@@ -70,4 +72,169 @@ std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed) {
     return decompressed;
 }
 
+ZSTDOutputBuffer::ZSTDOutputBuffer(FileUtil::IOFile& file_, s32 compression_level)
+    : file{file_}, context{ZSTD_createCCtx()}, chunk(ZSTD_CStreamInSize()),
+      compressed(ZSTD_CStreamOutSize()) {
+    compression_level = std::clamp(compression_level, ZSTD_minCLevel(), ZSTD_maxCLevel());
+    ZSTD_CCtx_setParameter(context, ZSTD_c_compressionLevel, compression_level);
+    ZSTD_CCtx_setParameter(context, ZSTD_c_checksumFlag, 1);
+    auto* begin = reinterpret_cast<char*>(chunk.data());
+    setp(begin, begin + chunk.size());
+}
+
+ZSTDOutputBuffer::ZSTDOutputBuffer(FileUtil::IOFile& file_)
+    : ZSTDOutputBuffer(file_, ZSTD_CLEVEL_DEFAULT) {}
+
+ZSTDOutputBuffer::~ZSTDOutputBuffer() {
+    ZSTD_freeCCtx(context);
+}
+
+bool ZSTDOutputBuffer::Finish() {
+    const std::span pending{reinterpret_cast<const u8*>(pbase()),
+                            static_cast<std::size_t>(pptr() - pbase())};
+    Compress(pending, true);
+    setp(nullptr, nullptr);
+    return !failed;
+}
+
+ZSTDOutputBuffer::int_type ZSTDOutputBuffer::overflow(int_type ch) {
+    if (!FlushChunk()) {
+        return traits_type::eof();
+    }
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+        *pptr() = traits_type::to_char_type(ch);
+        pbump(1);
+    }
+    return traits_type::not_eof(ch);
+}
+
+std::streamsize ZSTDOutputBuffer::xsputn(const char_type* s, std::streamsize count) {
+    const auto size = static_cast<std::size_t>(count);
+    if (size <= static_cast<std::size_t>(epptr() - pptr())) {
+        std::memcpy(pptr(), s, size);
+        pbump(static_cast<int>(size));
+        return count;
+    }
+    if (!FlushChunk()) {
+        return 0;
+    }
+    if (size < chunk.size()) {
+        std::memcpy(pptr(), s, size);
+        pbump(static_cast<int>(size));
+        return count;
+    }
+    // Skip the chunk buffer for large writes such as guest memory
+    return Compress({reinterpret_cast<const u8*>(s), size}, false) ? count : 0;
+}
+
+int ZSTDOutputBuffer::sync() {
+    return FlushChunk() ? 0 : -1;
+}
+
+bool ZSTDOutputBuffer::Compress(std::span<const u8> source, bool end_frame) {
+    if (failed) {
+        return false;
+    }
+    const ZSTD_EndDirective mode = end_frame ? ZSTD_e_end : ZSTD_e_continue;
+    ZSTD_inBuffer input{source.data(), source.size(), 0};
+    while (true) {
+        ZSTD_outBuffer output{compressed.data(), compressed.size(), 0};
+        const std::size_t remaining = ZSTD_compressStream2(context, &output, &input, mode);
+        if (ZSTD_isError(remaining)) {
+            LOG_ERROR(Common, "Error compressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(remaining), remaining);
+            failed = true;
+            return false;
+        }
+        if (file.WriteBytes(compressed.data(), output.pos) != output.pos) {
+            LOG_ERROR(Common, "Could not write compressed ZSTD stream");
+            failed = true;
+            return false;
+        }
+        const bool done = end_frame ? remaining == 0 : input.pos == input.size;
+        if (done) {
+            return true;
+        }
+    }
+}
+
+bool ZSTDOutputBuffer::FlushChunk() {
+    const std::span pending{reinterpret_cast<const u8*>(pbase()),
+                            static_cast<std::size_t>(pptr() - pbase())};
+    const bool result = pending.empty() || Compress(pending, false);
+    auto* begin = reinterpret_cast<char*>(chunk.data());
+    setp(begin, begin + chunk.size());
+    return result;
+}
+
+ZSTDInputBuffer::ZSTDInputBuffer(FileUtil::IOFile& file_)
+    : file{file_}, context{ZSTD_createDCtx()}, compressed(ZSTD_DStreamInSize()),
+      chunk(ZSTD_DStreamOutSize()) {
+    auto* begin = reinterpret_cast<char*>(chunk.data());
+    setg(begin, begin, begin);
+}
+
+ZSTDInputBuffer::~ZSTDInputBuffer() {
+    ZSTD_freeDCtx(context);
+}
+
+ZSTDInputBuffer::int_type ZSTDInputBuffer::underflow() {
+    if (gptr() < egptr()) {
+        return traits_type::to_int_type(*gptr());
+    }
+    const std::size_t size = Decompress(chunk);
+    auto* begin = reinterpret_cast<char*>(chunk.data());
+    setg(begin, begin, begin + size);
+    return size == 0 ? traits_type::eof() : traits_type::to_int_type(*gptr());
+}
+
+std::streamsize ZSTDInputBuffer::xsgetn(char_type* s, std::streamsize count) {
+    const auto size = static_cast<std::size_t>(count);
+    std::size_t copied = 0;
+    while (copied < size) {
+        const auto available = static_cast<std::size_t>(egptr() - gptr());
+        if (available == 0 && size - copied >= chunk.size()) {
+            // Skip the chunk buffer for large reads such as guest memory
+            copied += Decompress({reinterpret_cast<u8*>(s) + copied, size - copied});
+            break;
+        }
+        if (available == 0 && traits_type::eq_int_type(underflow(), traits_type::eof())) {
+            break;
+        }
+        const std::size_t to_copy =
+            std::min(size - copied, static_cast<std::size_t>(egptr() - gptr()));
+        std::memcpy(s + copied, gptr(), to_copy);
+        gbump(static_cast<int>(to_copy));
+        copied += to_copy;
+    }
+    return static_cast<std::streamsize>(copied);
+}
+
+std::size_t ZSTDInputBuffer::Decompress(std::span<u8> destination) {
+    std::size_t produced = 0;
+    while (produced < destination.size() && !failed) {
+        // The decompressor may still hold output if the previous call filled its buffer
+        if (compressed_pos == compressed_size && !output_pending) {
+            compressed_size = file.ReadBytes(compressed.data(), compressed.size());
+            compressed_pos = 0;
+            if (compressed_size == 0) {
+                break;
+            }
+        }
+        ZSTD_inBuffer input{compressed.data(), compressed_size, compressed_pos};
+        ZSTD_outBuffer output{destination.data() + produced, destination.size() - produced, 0};
+        const std::size_t result = ZSTD_decompressStream(context, &output, &input);
+        if (ZSTD_isError(result)) {
+            LOG_ERROR(Common, "Error decompressing ZSTD stream: {} ({})",
+                      ZSTD_getErrorName(result), result);
+            failed = true;
+            break;
+        }
+        compressed_pos = input.pos;
+        produced += output.pos;
+        output_pending = output.pos == output.size;
+    }
+    return produced;
+}
+
 } // namespace Common::Compression
@@ -4,11 +4,20 @@
 
 #pragma once
 
+#include <memory>
 #include <span>
+#include <streambuf>
 #include <vector>
 
 #include "common/common_types.h"
 
+struct ZSTD_CCtx_s;
+struct ZSTD_DCtx_s;
+
+namespace FileUtil {
+class IOFile;
+}
+
 namespace Common::Compression {
 
 /**
@@ -40,4 +49,72 @@ namespace Common::Compression {
  */
 [[nodiscard]] std::vector<u8> DecompressDataZSTD(std::span<const u8> compressed);
 
+/**
+ * Stream buffer that compresses everything written to it with Zstandard and writes the compressed
+ * data to a file as it is produced. Small writes are gathered into fixed-size chunks, large writes
+ * are compressed straight from the caller's memory.
+ */
+class ZSTDOutputBuffer final : public std::streambuf {
+public:
+    /**
+     * @param file the file to write the compressed data to, starting at its current position.
+     * @param compression_level the used compression level. Should be between 1 and 22.
+     */
+    explicit ZSTDOutputBuffer(FileUtil::IOFile& file, s32 compression_level);
+
+    /// Uses the default compression level.
+    explicit ZSTDOutputBuffer(FileUtil::IOFile& file);
+    ~ZSTDOutputBuffer() override;
+
+    /**
+     * Compresses any pending data and ends the Zstandard frame. Nothing may be written afterwards.
+     *
+     * @return whether all data was compressed and written successfully.
+     */
+    [[nodiscard]] bool Finish();
+
+protected:
+    int_type overflow(int_type ch) override;
+    std::streamsize xsputn(const char_type* s, std::streamsize count) override;
+    int sync() override;
+
+private:
+    bool Compress(std::span<const u8> source, bool end_frame);
+    bool FlushChunk();
+
+    FileUtil::IOFile& file;
+    ZSTD_CCtx_s* context;
+    std::vector<u8> chunk;
+    std::vector<u8> compressed;
+    bool failed = false;
+};
+
+/**
+ * Stream buffer that reads Zstandard compressed data from a file and decompresses it on demand.
+ * Large reads are decompressed straight into the caller's memory.
+ */
+class ZSTDInputBuffer final : public std::streambuf {
+public:
+    /// @param file the file to read the compressed data from, starting at its current position.
+    explicit ZSTDInputBuffer(FileUtil::IOFile& file);
+    ~ZSTDInputBuffer() override;
+
+protected:
+    int_type underflow() override;
+    std::streamsize xsgetn(char_type* s, std::streamsize count) override;
+
+private:
+    /// Decompresses up to destination.size() bytes, returning the number of bytes produced.
+    std::size_t Decompress(std::span<u8> destination);
+
+    FileUtil::IOFile& file;
+    ZSTD_DCtx_s* context;
+    std::vector<u8> compressed;
+    std::size_t compressed_pos = 0;
+    std::size_t compressed_size = 0;
+    std::vector<u8> chunk;
+    bool output_pending = false;
+    bool failed = false;
+};
+
 } // namespace Common::Compression
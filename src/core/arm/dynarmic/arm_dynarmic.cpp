@@ -317,6 +317,11 @@ std::unique_ptr<Dynarmic::A32::Jit> ARM_Dynarmic::MakeJit() {
     config.callbacks = cb.get();
     if (current_page_table) {
         config.page_table = &current_page_table->GetPointerArray();
+        if (current_page_table->fastmem_base) {
+            // Faulting accesses, such as to rasterizer cached pages, fall back to the page table
+            config.fastmem_pointer = reinterpret_cast<uintptr_t>(current_page_table->fastmem_base);
+            config.recompile_on_fastmem_failure = true;
+        }
     }
     config.coprocessors[15] = std::make_shared<DynarmicCP15>(cp15_state);
     config.define_unpredictable_behaviour = true;
@@ -28,6 +28,7 @@
 #include "core/frontend/image_interface.h"
 #include "core/gdbstub/gdbstub.h"
 #include "core/global.h"
+#include "core/hle/kernel/async_executor.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/thread.h"
@@ -529,8 +530,14 @@ void System::PrepareReschedule() {
 }
 
 PerfStats::Results System::GetAndResetPerfStats() {
-    return (perf_stats && timing) ? perf_stats->GetAndResetStats(timing->GetGlobalTimeUs())
-                                  : PerfStats::Results{};
+    if (!perf_stats || !timing) {
+        return PerfStats::Results{};
+    }
+    if (dsp_core) {
+        const auto output_stats = dsp_core->GetOutputStats();
+        perf_stats->ReportAudioOutput(output_stats.underruns, output_stats.overruns);
+    }
+    return perf_stats->GetAndResetStats(timing->GetGlobalTimeUs());
 }
 
 PerfStats::Results System::GetLastPerfStats() {
@@ -753,6 +760,11 @@ void System::Shutdown(bool is_deserializing) {
     // Shutdown emulation session
     is_powered_on = false;
 
+    // Cancel pending async service requests before the services they use are destroyed
+    if (kernel) {
+        kernel->GetAsyncExecutor().Shutdown();
+    }
+
     gpu.reset();
     if (!is_deserializing) {
         GDBStub::Shutdown();
@@ -8,6 +8,7 @@
 #include <atomic>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <boost/optional.hpp>
 #include <boost/serialization/version.hpp>
@@ -18,6 +19,7 @@
 #include "core/hle/service/plgldr/plgldr.h"
 #include "core/movie.h"
 #include "core/perf_stats.h"
+#include "core/savestate.h"
 
 namespace Frontend {
 class EmuWindow;
@@ -346,7 +348,7 @@ public:
                (mic_permission_granted = mic_permission_func());
     }
 
-    void SaveState(u32 slot) const;
+    void SaveState(u32 slot);
 
     void LoadState(u32 slot);
 
@@ -452,6 +454,9 @@ private:
     u64 title_id;
     bool self_delete_pending;
 
+    /// Base of incremental savestates, set by the last full savestate saved or loaded
+    std::optional<SaveStateBase> savestate_base;
+
     std::mutex signal_mutex;
     Signal current_signal;
     u32 signal_param;
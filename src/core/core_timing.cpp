@@ -22,6 +22,162 @@ bool Timing::Event::operator<(const Timing::Event& right) const {
     return std::tie(time, fifo_order) < std::tie(right.time, right.fifo_order);
 }
 
+Timing::EventQueue::EventQueue() = default;
+
+Timing::EventQueue::~EventQueue() = default;
+
+void Timing::EventQueue::Push(const Event& event) {
+    u32 slot_index;
+    if (!free_slots.empty()) {
+        slot_index = free_slots.back();
+        free_slots.pop_back();
+    } else {
+        slot_index = static_cast<u32>(slots.size());
+        slots.emplace_back();
+    }
+
+    slots[slot_index] = Slot{.event = event, .heap_index = static_cast<u32>(heap.size())};
+    LinkFront(type_heads, event.type, slot_index, &Slot::by_type);
+    LinkFront(key_heads, EventKey{event.type, event.user_data}, slot_index, &Slot::by_key);
+
+    heap.push_back(HeapEntry{event.time, event.fifo_order, slot_index});
+    SiftUp(static_cast<u32>(heap.size() - 1));
+}
+
+Timing::Event Timing::EventQueue::Pop() {
+    const u32 slot_index = heap.front().slot;
+    const Event event = slots[slot_index].event;
+    Erase(slot_index);
+    return event;
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* event_type) {
+    const auto head = type_heads.find(event_type);
+    if (head == type_heads.end()) {
+        return;
+    }
+    for (u32 slot_index = head->second; slot_index != INVALID_INDEX;) {
+        const u32 next = slots[slot_index].by_type.next;
+        Erase(slot_index);
+        slot_index = next;
+    }
+}
+
+void Timing::EventQueue::Remove(const TimingEventType* event_type, std::uintptr_t user_data) {
+    const auto head = key_heads.find(EventKey{event_type, user_data});
+    if (head == key_heads.end()) {
+        return;
+    }
+    for (u32 slot_index = head->second; slot_index != INVALID_INDEX;) {
+        const u32 next = slots[slot_index].by_key.next;
+        Erase(slot_index);
+        slot_index = next;
+    }
+}
+
+std::vector<Timing::Event> Timing::EventQueue::GetEvents() const {
+    std::vector<Event> events;
+    events.reserve(heap.size());
+    for (const HeapEntry& entry : heap) {
+        events.push_back(slots[entry.slot].event);
+    }
+    return events;
+}
+
+void Timing::EventQueue::Clear() {
+    slots.clear();
+    free_slots.clear();
+    heap.clear();
+    type_heads.clear();
+    key_heads.clear();
+}
+
+void Timing::EventQueue::Place(u32 heap_index, const HeapEntry& entry) {
+    heap[heap_index] = entry;
+    slots[entry.slot].heap_index = heap_index;
+}
+
+void Timing::EventQueue::SiftUp(u32 heap_index) {
+    const HeapEntry entry = heap[heap_index];
+    while (heap_index > 0) {
+        const u32 parent = (heap_index - 1) / 2;
+        if (!(entry < heap[parent])) {
+            break;
+        }
+        Place(heap_index, heap[parent]);
+        heap_index = parent;
+    }
+    Place(heap_index, entry);
+}
+
+void Timing::EventQueue::SiftDown(u32 heap_index) {
+    const HeapEntry entry = heap[heap_index];
+    const u32 size = static_cast<u32>(heap.size());
+    while (true) {
+        u32 child = heap_index * 2 + 1;
+        if (child >= size) {
+            break;
+        }
+        if (child + 1 < size && heap[child + 1] < heap[child]) {
+            ++child;
+        }
+        if (!(heap[child] < entry)) {
+            break;
+        }
+        Place(heap_index, heap[child]);
+        heap_index = child;
+    }
+    Place(heap_index, entry);
+}
+
+template <typename Map>
+void Timing::EventQueue::LinkFront(Map& heads, const typename Map::key_type& key, u32 slot_index,
+                                   Link Slot::*link) {
+    const auto [head, inserted] = heads.try_emplace(key, slot_index);
+    if (!inserted) {
+        (slots[slot_index].*link).next = head->second;
+        (slots[head->second].*link).prev = slot_index;
+        head->second = slot_index;
+    }
+}
+
+template <typename Map>
+void Timing::EventQueue::Unlink(Map& heads, const typename Map::key_type& key, u32 slot_index,
+                                Link Slot::*link) {
+    const Link node = slots[slot_index].*link;
+    if (node.prev != INVALID_INDEX) {
+        (slots[node.prev].*link).next = node.next;
+    } else if (node.next != INVALID_INDEX) {
+        heads[key] = node.next;
+    } else {
+        heads.erase(key);
+    }
+    if (node.next != INVALID_INDEX) {
+        (slots[node.next].*link).prev = node.prev;
+    }
+}
+
+void Timing::EventQueue::Erase(u32 slot_index) {
+    const Event& event = slots[slot_index].event;
+    Unlink(type_heads, event.type, slot_index, &Slot::by_type);
+    Unlink(key_heads, EventKey{event.type, event.user_data}, slot_index, &Slot::by_key);
+
+    // Replace the entry with the last one in the heap and restore the heap property
+    const u32 heap_index = slots[slot_index].heap_index;
+    const HeapEntry last = heap.back();
+    heap.pop_back();
+    if (heap_index < heap.size()) {
+        Place(heap_index, last);
+        if (heap_index > 0 && last < heap[(heap_index - 1) / 2]) {
+            SiftUp(heap_index);
+        } else {
+            SiftDown(heap_index);
+        }
+    }
+
+    free_slots.push_back(slot_index);
+}
+
 Timing::Timing(std::size_t num_cores, u32 cpu_clock_percentage, s64 override_base_ticks) {
     // Generate non-zero base tick count to simulate time the system ran before launching the game.
     // This accounts for games that rely on the system tick to seed randomness.
@@ -93,9 +249,7 @@ void Timing::ScheduleEvent(s64 cycles_into_future, const TimingEventType* event_
             if (!timer->is_timer_sane)
                 timer->ForceExceptionCheck(cycles_into_future);
 
-            timer->event_queue.emplace_back(
-                Event{timeout, timer->event_fifo_id++, user_data, event_type});
-            std::push_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
+            timer->event_queue.Push(Event{timeout, timer->event_fifo_id++, user_data, event_type});
         } else {
             timer->ts_queue.Push(Event{static_cast<s64>(timer->GetTicks() + cycles_into_future), 0,
                                        user_data, event_type});
@@ -108,17 +262,10 @@ void Timing::UnscheduleEvent(const TimingEventType* event_type, std::uintptr_t u
         return;
     }
     for (auto timer : timers) {
-        auto itr = std::remove_if(
-            timer->event_queue.begin(), timer->event_queue.end(),
-            [&](const Event& e) { return e.type == event_type && e.user_data == user_data; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        // Events scheduled from other threads must be cancelled too.
+        timer->MoveEvents();
+        timer->event_queue.Remove(event_type, user_data);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::RemoveEvent(const TimingEventType* event_type) {
@@ -126,16 +273,9 @@ void Timing::RemoveEvent(const TimingEventType* event_type) {
         return;
     }
     for (auto timer : timers) {
-        auto itr = std::remove_if(timer->event_queue.begin(), timer->event_queue.end(),
-                                  [&](const Event& e) { return e.type == event_type; });
-
-        // Removing random items breaks the invariant so we have to re-establish it.
-        if (itr != timer->event_queue.end()) {
-            timer->event_queue.erase(itr, timer->event_queue.end());
-            std::make_heap(timer->event_queue.begin(), timer->event_queue.end(), std::greater<>());
-        }
+        timer->MoveEvents();
+        timer->event_queue.Remove(event_type);
     }
-    // TODO:remove events from ts_queue
 }
 
 void Timing::SetCurrentTimer(std::size_t core_id) {
@@ -198,16 +338,15 @@ void Timing::Timer::ForceExceptionCheck(s64 cycles) {
 void Timing::Timer::MoveEvents() {
     for (Event ev; ts_queue.Pop(ev);) {
         ev.fifo_order = event_fifo_id++;
-        event_queue.emplace_back(std::move(ev));
-        std::push_heap(event_queue.begin(), event_queue.end(), std::greater<>());
+        event_queue.Push(ev);
     }
 }
 
 s64 Timing::Timer::GetMaxSliceLength() const {
-    const auto& next_event = event_queue.begin();
-    if (next_event != event_queue.end()) {
-        ASSERT(next_event->time - executed_ticks > 0);
-        return next_event->time - executed_ticks;
+    if (!event_queue.Empty()) {
+        const Event& next_event = event_queue.Top();
+        ASSERT(next_event.time - executed_ticks > 0);
+        return next_event.time - executed_ticks;
     }
     return MAX_SLICE_LENGTH;
 }
@@ -224,10 +363,8 @@ void Timing::Timer::Advance() {
 
     is_timer_sane = true;
 
-    while (!event_queue.empty() && event_queue.front().time <= executed_ticks) {
-        Event evt = std::move(event_queue.front());
-        std::pop_heap(event_queue.begin(), event_queue.end(), std::greater<>());
-        event_queue.pop_back();
+    while (!event_queue.Empty() && event_queue.Top().time <= executed_ticks) {
+        const Event evt = event_queue.Pop();
         if (evt.type->callback != nullptr) {
             evt.type->callback(evt.user_data, static_cast<int>(executed_ticks - evt.time));
         } else {
@@ -242,9 +379,9 @@ void Timing::Timer::SetNextSlice(s64 max_slice_length) {
     slice_length = max_slice_length;
 
     // Still events left (scheduled in the future)
-    if (!event_queue.empty()) {
+    if (!event_queue.Empty()) {
         slice_length = static_cast<int>(
-            std::min<s64>(event_queue.front().time - executed_ticks, max_slice_length));
+            std::min<s64>(event_queue.Top().time - executed_ticks, max_slice_length));
     }
 
     downcount = slice_length >> downcount_hack;
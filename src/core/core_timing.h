@@ -184,6 +184,107 @@ public:
     // scheduled and repated.
     static constexpr int MAX_SLICE_LENGTH = BASE_CLOCK_RATE_ARM11 / 234;
 
+    /**
+     * Min-heap of events ordered by (time, fifo_order). Every event lives in a slot that tracks
+     * its position in the heap and links it to the other queued events of the same type, so
+     * cancelling events only visits the events of that type and removes each in O(log n).
+     */
+    class EventQueue {
+    public:
+        EventQueue();
+        ~EventQueue();
+
+        bool Empty() const {
+            return heap.empty();
+        }
+
+        std::size_t Size() const {
+            return heap.size();
+        }
+
+        /// Returns the earliest event. The queue must not be empty.
+        const Event& Top() const {
+            return slots[heap.front().slot].event;
+        }
+
+        void Push(const Event& event);
+
+        /// Removes the earliest event and returns it. The queue must not be empty.
+        Event Pop();
+
+        /// Removes all events of the specified type.
+        void Remove(const TimingEventType* event_type);
+
+        /// Removes all events of the specified type carrying the specified user data.
+        void Remove(const TimingEventType* event_type, std::uintptr_t user_data);
+
+        /// Returns a copy of all events in heap order.
+        std::vector<Event> GetEvents() const;
+
+        void Clear();
+
+    private:
+        static constexpr u32 INVALID_INDEX = std::numeric_limits<u32>::max();
+
+        /// Doubly linked list node threading the slots sharing a lookup key.
+        struct Link {
+            u32 prev = INVALID_INDEX;
+            u32 next = INVALID_INDEX;
+        };
+
+        struct Slot {
+            Event event;
+            u32 heap_index;
+            Link by_type;
+            Link by_key;
+        };
+
+        struct EventKey {
+            const TimingEventType* type;
+            std::uintptr_t user_data;
+
+            bool operator==(const EventKey&) const = default;
+        };
+
+        struct EventKeyHash {
+            std::size_t operator()(const EventKey& key) const {
+                return std::hash<const TimingEventType*>{}(key.type) ^
+                       (std::hash<std::uintptr_t>{}(key.user_data) * 0x9E3779B97F4A7C15ULL);
+            }
+        };
+
+        // The ordering key is duplicated in the heap so sifting does not touch the slots.
+        struct HeapEntry {
+            s64 time;
+            u64 fifo_order;
+            u32 slot;
+
+            bool operator<(const HeapEntry& other) const {
+                return time < other.time || (time == other.time && fifo_order < other.fifo_order);
+            }
+        };
+
+        void Place(u32 heap_index, const HeapEntry& entry);
+        void SiftUp(u32 heap_index);
+        void SiftDown(u32 heap_index);
+
+        template <typename Map>
+        void LinkFront(Map& heads, const typename Map::key_type& key, u32 slot_index,
+                       Link Slot::*link);
+        template <typename Map>
+        void Unlink(Map& heads, const typename Map::key_type& key, u32 slot_index,
+                    Link Slot::*link);
+
+        /// Unlinks the event in the slot from the heap and its lookup lists and frees the slot.
+        void Erase(u32 slot_index);
+
+        std::vector<Slot> slots;
+        std::vector<u32> free_slots;
+        std::vector<HeapEntry> heap;
+        std::unordered_map<const TimingEventType*, u32> type_heads;
+        std::unordered_map<EventKey, u32, EventKeyHash> key_heads;
+    };
+
     class Timer {
     public:
         Timer(s64 base_ticks = 0);
@@ -214,11 +315,7 @@ public:
 
     private:
         friend class Timing;
-        // The queue is a min-heap using std::make_heap/push_heap/pop_heap.
-        // We don't use std::priority_queue because we need to be able to serialize, unserialize and
-        // erase arbitrary events (RemoveEvent()) regardless of the queue order. These aren't
-        // accommodated by the standard adaptor class.
-        std::vector<Event> event_queue;
+        EventQueue event_queue;
         u64 event_fifo_id = 0;
         // the queue for storing the events from other threads threadsafe until they will be added
         // to the event_queue by the emu thread
@@ -245,7 +342,18 @@ public:
         template <class Archive>
         void serialize(Archive& ar, const unsigned int) {
             MoveEvents();
-            ar & event_queue;
+            // Stored as a plain list of events to keep the savestate format unchanged.
+            std::vector<Event> events;
+            if (Archive::is_saving::value) {
+                events = event_queue.GetEvents();
+            }
+            ar & events;
+            if (Archive::is_loading::value) {
+                event_queue.Clear();
+                for (const Event& event : events) {
+                    event_queue.Push(event);
+                }
+            }
             ar & event_fifo_id;
             ar & slice_length;
             ar & downcount;
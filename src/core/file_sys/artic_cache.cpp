@@ -11,6 +11,13 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
     if (length == 0)
         return size_t();
 
+    if (disk_cache) {
+        return disk_cache->Read(offset, length, buffer,
+                                [this, file_handle](u8* data, std::size_t len, std::size_t off) {
+                                    return ReadFromArtic(file_handle, data, len, off);
+                                });
+    }
+
     const auto segments = BreakupRead(offset, length);
     std::size_t read_progress = 0;
 
@@ -95,6 +102,9 @@ ResultVal<std::size_t> ArticCache::Read(s32 file_handle, std::size_t offset, std
 }
 
 bool ArticCache::CacheReady(std::size_t file_offset, std::size_t length) {
+    if (disk_cache) {
+        return disk_cache->Contains(file_offset, length);
+    }
     auto segments = BreakupRead(file_offset, length);
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         return false;
@@ -121,6 +131,7 @@ ResultVal<size_t> ArticCache::Write(s32 file_handle, std::size_t offset, std::si
     // Can probably do better, but write operations are usually done at the end, so it doesn't
     // matter much
     Clear();
+    disk_cache.reset();
 
     size_t written_amount = 0;
     while (written_amount != length) {
@@ -181,6 +192,32 @@ ResultVal<size_t> ArticCache::GetSize(s32 file_handle) {
     return data_size.value();
 }
 
+bool ArticCache::EnableDiskCache(s32 file_handle, u64 title_id, u16 content_version,
+                                 bool is_update, std::size_t capacity) {
+    auto size = GetSize(file_handle);
+    if (size.Failed() || size.Unwrap() == 0) {
+        return false;
+    }
+
+    // Check the cached content against what is on the console now.
+    std::array<u8, ArticDiskCache::BlockSize> first_block;
+    const std::size_t first_block_size = std::min(first_block.size(), size.Unwrap());
+    auto read = ReadFromArtic(file_handle, first_block.data(), first_block_size, 0);
+    if (read.Failed() || read.Unwrap() != first_block_size) {
+        return false;
+    }
+
+    const ArticDiskCache::Identity identity{
+        .title_id = title_id,
+        .content_version = content_version,
+        .is_update = is_update,
+        .data_size = size.Unwrap(),
+        .content_hash = ArticDiskCache::HashContent(first_block.data(), first_block_size),
+    };
+    disk_cache = ArticDiskCache::Open(identity, capacity);
+    return disk_cache != nullptr;
+}
+
 ResultVal<size_t> ArticCache::ReadFromArtic(s32 file_handle, u8* buffer, size_t len,
                                             size_t offset) {
     size_t read_amount = 0;
@@ -17,6 +17,7 @@
 #include "common/common_types.h"
 #include "common/static_lru_cache.h"
 #include "core/file_sys/archive_backend.h"
+#include "core/file_sys/artic_disk_cache.h"
 #include "core/hle/result.h"
 #include "network/artic_base/artic_base_client.h"
 
@@ -57,9 +58,18 @@ public:
         data_size = size;
     }
 
+    /**
+     * Makes reads go through a persistent disk cache for the content, which is validated against
+     * the first block of the file on the server. Only for files that are never written.
+     * @param capacity the size of the disk cache in bytes.
+     */
+    bool EnableDiskCache(s32 file_handle, u64 title_id, u16 content_version, bool is_update,
+                         std::size_t capacity);
+
 private:
     std::shared_ptr<Network::ArticBase::Client> client;
     std::optional<size_t> data_size;
+    std::shared_ptr<ArticDiskCache> disk_cache;
 
     // Total cache size: 32MB small, 512MB big (worst case), 160MB very big (worst case).
     // The worst case values are unrealistic, they will never happen in any real game.
@@ -0,0 +1,384 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <vector>
+#include <fmt/format.h>
+#include "common/alignment.h"
+#include "common/common_paths.h"
+#include "common/file_util.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "core/file_sys/artic_disk_cache.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include "common/string_util.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace FileSys {
+
+namespace {
+
+constexpr u32 CacheMagic = 0x4354'5241; // "ARTC"
+constexpr u32 CacheVersion = 1;
+constexpr std::size_t MaxSlots = std::numeric_limits<u32>::max();
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+    u32 block_size;
+    u32 slot_count;
+    u64 title_id;
+    u64 data_size;
+    u64 content_hash;
+    u16 content_version;
+    u8 is_update;
+    u8 reserved0;
+    u32 next_slot;
+    std::array<u8, 16> reserved;
+};
+static_assert(sizeof(CacheHeader) == 64, "CacheHeader has incorrect size");
+
+u32 Checksum(const u8* data, std::size_t length) {
+    return static_cast<u32>(Common::ComputeHash64(data, length));
+}
+
+/// Copies the part of data, located at data_start in the content, that overlaps the buffer.
+void CopyOverlap(u8* buffer, std::size_t offset, std::size_t length, const u8* data,
+                 std::size_t data_start, std::size_t data_length) {
+    const std::size_t start = std::max(offset, data_start);
+    const std::size_t end = std::min(offset + length, data_start + data_length);
+    if (start < end) {
+        std::memcpy(buffer + (start - offset), data + (start - data_start), end - start);
+    }
+}
+
+} // Anonymous namespace
+
+ArticDiskCache::ArticDiskCache(std::string path_, const Identity& identity_, std::size_t capacity)
+    : path{std::move(path_)}, identity{identity_},
+      slot_count{static_cast<u32>(std::clamp<std::size_t>(capacity / BlockSize, 1, MaxSlots))},
+      data_offset{Common::AlignUp<std::size_t>(
+          sizeof(CacheHeader) + std::size_t{slot_count} * sizeof(SlotEntry), BlockSize)} {
+    const std::string dir = path.substr(0, path.find_last_of(DIR_SEP_CHR) + 1);
+    if (!dir.empty() && !FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(Service_FS, "Failed to create directory {}", dir);
+        return;
+    }
+    if (!Map(data_offset + std::size_t{slot_count} * BlockSize)) {
+        return;
+    }
+
+    const auto* header = reinterpret_cast<const CacheHeader*>(base);
+    if (header->magic != CacheMagic || header->version != CacheVersion ||
+        header->block_size != BlockSize || header->slot_count != slot_count ||
+        header->title_id != identity.title_id || header->data_size != identity.data_size ||
+        header->content_hash != identity.content_hash ||
+        header->content_version != identity.content_version ||
+        header->is_update != static_cast<u8>(identity.is_update)) {
+        if (header->magic == CacheMagic) {
+            LOG_INFO(Service_FS, "Artic disk cache {} is outdated, discarding", path);
+        }
+        Reset();
+        return;
+    }
+
+    next_slot = header->next_slot % slot_count;
+    const SlotEntry* slots = Slots();
+    for (u32 slot = 0; slot < slot_count; slot++) {
+        if (slots[slot].block_plus_one != 0) {
+            block_slots.emplace(slots[slot].block_plus_one - 1, slot);
+        }
+    }
+    LOG_INFO(Service_FS, "Loaded {} blocks from the Artic disk cache", block_slots.size());
+}
+
+ArticDiskCache::~ArticDiskCache() {
+    Unmap();
+}
+
+std::shared_ptr<ArticDiskCache> ArticDiskCache::Open(const Identity& identity,
+                                                     std::size_t capacity) {
+    static std::mutex open_caches_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<ArticDiskCache>> open_caches;
+
+    const std::string path = fmt::format(
+        "{}artic" DIR_SEP "{:016X}{}.bin", FileUtil::GetUserPath(FileUtil::UserPath::CacheDir),
+        identity.title_id, identity.is_update ? "_update" : "");
+
+    std::scoped_lock lock{open_caches_mutex};
+    if (auto cache = open_caches[path].lock()) {
+        const Identity& open = cache->identity;
+        if (open.content_version == identity.content_version &&
+            open.data_size == identity.data_size && open.content_hash == identity.content_hash) {
+            return cache;
+        }
+        // The file is still in use for different content, leave it alone.
+        LOG_WARNING(Service_FS, "Artic disk cache {} is in use for other content", path);
+        return nullptr;
+    }
+
+    auto cache = std::make_shared<ArticDiskCache>(path, identity, capacity);
+    if (!cache->IsValid()) {
+        return nullptr;
+    }
+    open_caches[path] = cache;
+    return cache;
+}
+
+u64 ArticDiskCache::HashContent(const u8* first_block, std::size_t length) {
+    return Common::ComputeHash64(first_block, std::min(length, BlockSize));
+}
+
+ResultVal<std::size_t> ArticDiskCache::Read(std::size_t offset, std::size_t length, u8* buffer,
+                                            const FetchFunction& fetch) {
+    if (offset >= identity.data_size) {
+        return std::size_t{0};
+    }
+    length = std::min(length, identity.data_size - offset);
+    if (length == 0) {
+        return std::size_t{0};
+    }
+
+    const auto first_block = static_cast<u32>(offset / BlockSize);
+    const auto end_block = static_cast<u32>((offset + length + BlockSize - 1) / BlockSize);
+    std::vector<u8> fetched;
+    u32 block = first_block;
+    while (block < end_block) {
+        if (ReadBlock(block, offset, length, buffer)) {
+            hits++;
+            block++;
+            continue;
+        }
+
+        // Fetch the whole run of missing blocks with one request.
+        u32 run_end = block + 1;
+        while (run_end < end_block && !Contains(std::size_t{run_end} * BlockSize, 1)) {
+            run_end++;
+        }
+        const std::size_t run_offset = std::size_t{block} * BlockSize;
+        const std::size_t run_length =
+            std::min<std::size_t>(std::size_t{run_end} * BlockSize, identity.data_size) -
+            run_offset;
+        fetched.resize(run_length);
+        auto res = fetch(fetched.data(), run_length, run_offset);
+        if (res.Failed()) {
+            return res;
+        }
+        const std::size_t fetched_length = res.Unwrap();
+        misses += run_end - block;
+
+        CopyOverlap(buffer, offset, length, fetched.data(), run_offset, fetched_length);
+        for (u32 i = block; i < run_end; i++) {
+            const std::size_t block_start = std::size_t{i - block} * BlockSize;
+            if (block_start + BlockLength(i) > fetched_length) {
+                break;
+            }
+            StoreBlock(i, fetched.data() + block_start);
+        }
+
+        if (fetched_length != run_length) {
+            // The server returned less than expected, stop at the end of the valid data.
+            return run_offset + fetched_length > offset ? run_offset + fetched_length - offset
+                                                        : std::size_t{0};
+        }
+        block = run_end;
+    }
+    return length;
+}
+
+bool ArticDiskCache::Contains(std::size_t offset, std::size_t length) const {
+    if (length == 0 || offset + length > identity.data_size) {
+        return false;
+    }
+    const auto first_block = static_cast<u32>(offset / BlockSize);
+    const auto end_block = static_cast<u32>((offset + length + BlockSize - 1) / BlockSize);
+    std::shared_lock lock{mutex};
+    for (u32 block = first_block; block < end_block; block++) {
+        if (!block_slots.contains(block)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+ArticDiskCache::Stats ArticDiskCache::GetStats() const {
+    std::shared_lock lock{mutex};
+    return Stats{
+        .hits = hits,
+        .misses = misses,
+        .evictions = evictions,
+        .blocks = block_slots.size(),
+    };
+}
+
+bool ArticDiskCache::ReadBlock(u32 block, std::size_t offset, std::size_t length,
+                               u8* buffer) const {
+    std::shared_lock lock{mutex};
+    const auto it = block_slots.find(block);
+    if (it == block_slots.end()) {
+        return false;
+    }
+    const u8* data = SlotData(it->second);
+    const std::size_t block_length = BlockLength(block);
+    if (Checksum(data, block_length) != Slots()[it->second].checksum) {
+        // Left over from an interrupted write, it will be replaced when fetched again.
+        return false;
+    }
+    CopyOverlap(buffer, offset, length, data, std::size_t{block} * BlockSize, block_length);
+    return true;
+}
+
+void ArticDiskCache::StoreBlock(u32 block, const u8* data) {
+    std::unique_lock lock{mutex};
+    SlotEntry* slots = Slots();
+    u32 slot;
+    if (const auto it = block_slots.find(block); it != block_slots.end()) {
+        slot = it->second;
+    } else {
+        slot = next_slot;
+        next_slot = (next_slot + 1) % slot_count;
+        if (slots[slot].block_plus_one != 0) {
+            block_slots.erase(slots[slot].block_plus_one - 1);
+            evictions++;
+        }
+        block_slots.emplace(block, slot);
+    }
+
+    const std::size_t block_length = BlockLength(block);
+    slots[slot].block_plus_one = 0;
+    std::memcpy(SlotData(slot), data, block_length);
+    slots[slot] = SlotEntry{
+        .block_plus_one = block + 1,
+        .checksum = Checksum(data, block_length),
+    };
+    reinterpret_cast<CacheHeader*>(base)->next_slot = next_slot;
+}
+
+void ArticDiskCache::Reset() {
+    std::memset(base, 0, data_offset);
+    auto* header = reinterpret_cast<CacheHeader*>(base);
+    header->magic = CacheMagic;
+    header->version = CacheVersion;
+    header->block_size = BlockSize;
+    header->slot_count = slot_count;
+    header->title_id = identity.title_id;
+    header->data_size = identity.data_size;
+    header->content_hash = identity.content_hash;
+    header->content_version = identity.content_version;
+    header->is_update = static_cast<u8>(identity.is_update);
+    block_slots.clear();
+    next_slot = 0;
+}
+
+std::size_t ArticDiskCache::BlockLength(u32 block) const {
+    return std::min(BlockSize, identity.data_size - std::size_t{block} * BlockSize);
+}
+
+u8* ArticDiskCache::SlotData(u32 slot) const {
+    return base + data_offset + std::size_t{slot} * BlockSize;
+}
+
+ArticDiskCache::SlotEntry* ArticDiskCache::Slots() const {
+    return reinterpret_cast<SlotEntry*>(base + sizeof(CacheHeader));
+}
+
+#ifdef _WIN32
+
+bool ArticDiskCache::Map(std::size_t file_size) {
+    file_handle = CreateFileW(Common::UTF8ToUTF16W(path).c_str(), GENERIC_READ | GENERIC_WRITE,
+                              FILE_SHARE_READ, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL,
+                              nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        file_handle = nullptr;
+        LOG_ERROR(Service_FS, "Failed to open Artic disk cache {}", path);
+        return false;
+    }
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(file_size);
+    if (!SetFilePointerEx(file_handle, size, nullptr, FILE_BEGIN) || !SetEndOfFile(file_handle)) {
+        LOG_ERROR(Service_FS, "Failed to resize Artic disk cache {}", path);
+        Unmap();
+        return false;
+    }
+    mapping_handle = CreateFileMappingW(file_handle, nullptr, PAGE_READWRITE, size.HighPart,
+                                        size.LowPart, nullptr);
+    if (mapping_handle == nullptr) {
+        LOG_ERROR(Service_FS, "Failed to map Artic disk cache {}", path);
+        Unmap();
+        return false;
+    }
+    base = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, file_size));
+    if (base == nullptr) {
+        LOG_ERROR(Service_FS, "Failed to map Artic disk cache {}", path);
+        Unmap();
+        return false;
+    }
+    mapped_size = file_size;
+    return true;
+}
+
+void ArticDiskCache::Unmap() {
+    if (base != nullptr) {
+        UnmapViewOfFile(base);
+        base = nullptr;
+    }
+    if (mapping_handle != nullptr) {
+        CloseHandle(mapping_handle);
+        mapping_handle = nullptr;
+    }
+    if (file_handle != nullptr) {
+        CloseHandle(file_handle);
+        file_handle = nullptr;
+    }
+}
+
+#else
+
+bool ArticDiskCache::Map(std::size_t file_size) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        LOG_ERROR(Service_FS, "Failed to open Artic disk cache {}: {}", path, strerror(errno));
+        return false;
+    }
+    if (ftruncate(fd, static_cast<off_t>(file_size)) != 0) {
+        LOG_ERROR(Service_FS, "Failed to resize Artic disk cache {}: {}", path, strerror(errno));
+        Unmap();
+        return false;
+    }
+    void* ptr = mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        LOG_ERROR(Service_FS, "Failed to map Artic disk cache {}: {}", path, strerror(errno));
+        Unmap();
+        return false;
+    }
+    base = static_cast<u8*>(ptr);
+    mapped_size = file_size;
+    return true;
+}
+
+void ArticDiskCache::Unmap() {
+    if (base != nullptr) {
+        munmap(base, mapped_size);
+        base = nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+#endif
+
+} // namespace FileSys
@@ -0,0 +1,130 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include "common/common_types.h"
+#include "core/hle/result.h"
+
+namespace FileSys {
+
+/**
+ * Persistent, size-bounded store of blocks read from an Artic Base server. There is one file per
+ * title and content, which is memory-mapped. A block is read from the server on its first use and
+ * then stays on disk for later sessions.
+ *
+ * The file records the content it was filled from: the title ID and version, the data size and a
+ * hash of the first block. When it is opened, the current values must match. If they do not, the
+ * title was updated on the console and the file is discarded. When the file is full, the oldest
+ * blocks are replaced first.
+ */
+class ArticDiskCache {
+public:
+    static constexpr std::size_t BlockSize = 4 * 1024;
+
+    /// Identifies the content cached by a file.
+    struct Identity {
+        u64 title_id;
+        u16 content_version;
+        bool is_update;
+        u64 data_size;
+        u64 content_hash; ///< Hash of the first block of the content, see HashContent.
+    };
+
+    struct Stats {
+        u64 hits;      ///< Blocks read from disk
+        u64 misses;    ///< Blocks read from the server
+        u64 evictions; ///< Blocks replaced because the file was full
+        u64 blocks;    ///< Blocks currently stored
+    };
+
+    /// Reads length bytes at offset from the server into buffer, returning the bytes read.
+    using FetchFunction =
+        std::function<ResultVal<std::size_t>(u8* buffer, std::size_t length, std::size_t offset)>;
+
+    /**
+     * Opens or creates the cache file at path.
+     * @param capacity the space used by cached blocks in bytes, at least one block.
+     */
+    ArticDiskCache(std::string path, const Identity& identity, std::size_t capacity);
+    ~ArticDiskCache();
+
+    ArticDiskCache(const ArticDiskCache&) = delete;
+    ArticDiskCache& operator=(const ArticDiskCache&) = delete;
+
+    /**
+     * Opens the cache file for the content in the user cache directory. Readers of the same
+     * content share one instance, so that the file is never mapped twice.
+     * @returns the cache, or nullptr if the file could not be mapped.
+     */
+    static std::shared_ptr<ArticDiskCache> Open(const Identity& identity, std::size_t capacity);
+
+    /// Returns the hash of the first block of the content, for Identity::content_hash.
+    static u64 HashContent(const u8* first_block, std::size_t length);
+
+    /// Returns whether the file is mapped. The cache must not be used otherwise.
+    bool IsValid() const {
+        return base != nullptr;
+    }
+
+    /**
+     * Reads data from the cache. Any missing blocks are fetched from the server and stored.
+     * @returns the number of bytes read, which is short at the end of the content.
+     */
+    ResultVal<std::size_t> Read(std::size_t offset, std::size_t length, u8* buffer,
+                                const FetchFunction& fetch);
+
+    /// Returns whether every block of the range is stored.
+    bool Contains(std::size_t offset, std::size_t length) const;
+
+    Stats GetStats() const;
+
+private:
+    struct SlotEntry {
+        u32 block_plus_one; ///< Index of the stored block plus one, zero if the slot is empty
+        u32 checksum;       ///< Checksum of the block data, to detect torn writes
+    };
+
+    bool Map(std::size_t file_size);
+    void Unmap();
+    void Reset();
+
+    /// Copies a stored block, returning false if it is missing or fails its checksum.
+    bool ReadBlock(u32 block, std::size_t offset, std::size_t length, u8* buffer) const;
+    void StoreBlock(u32 block, const u8* data);
+
+    std::size_t BlockLength(u32 block) const;
+    u8* SlotData(u32 slot) const;
+    SlotEntry* Slots() const;
+
+    std::string path;
+    Identity identity;
+    u32 slot_count;
+    std::size_t data_offset;
+
+    u8* base = nullptr;
+    std::size_t mapped_size = 0;
+#ifdef _WIN32
+    void* file_handle = nullptr;
+    void* mapping_handle = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<u32, u32> block_slots; ///< Slot of each stored block
+    u32 next_slot = 0;                        ///< Next slot to fill, oldest first
+
+    std::atomic<u64> hits{};
+    std::atomic<u64> misses{};
+    std::atomic<u64> evictions{};
+};
+
+} // namespace FileSys
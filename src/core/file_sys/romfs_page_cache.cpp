@@ -0,0 +1,117 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include "common/assert.h"
+#include "core/file_sys/romfs_page_cache.h"
+
+namespace FileSys {
+
+RomFSPageCache::RomFSPageCache(std::size_t capacity)
+    : capacity_per_shard{capacity / PageSize / NumShards} {
+    // Round small non-zero capacities up to one page per shard
+    if (capacity != 0 && capacity_per_shard == 0) {
+        capacity_per_shard = 1;
+    }
+}
+
+RomFSPageCache::~RomFSPageCache() = default;
+
+std::optional<std::size_t> RomFSPageCache::Read(std::size_t page, std::size_t offset,
+                                                std::size_t length, u8* buffer) {
+    Shard& shard = GetShard(page);
+    std::scoped_lock lock{shard.mutex};
+    const auto it = shard.index.find(page);
+    if (it == shard.index.end()) {
+        return std::nullopt;
+    }
+
+    const u32 line_index = it->second;
+    if (line_index != shard.most_recent) {
+        shard.Unlink(line_index);
+        shard.PushFront(line_index);
+    }
+
+    const Line& line = shard.lines[line_index];
+    const std::size_t copy_amount =
+        line.size > offset ? std::min(offset + length, line.size) - offset : 0;
+    std::memcpy(buffer, line.data->data() + offset, copy_amount);
+    return copy_amount;
+}
+
+bool RomFSPageCache::Contains(std::size_t page) const {
+    const Shard& shard = GetShard(page);
+    std::scoped_lock lock{shard.mutex};
+    return shard.index.contains(page);
+}
+
+void RomFSPageCache::Insert(std::size_t page, std::span<const u8> data) {
+    if (capacity_per_shard == 0) {
+        return;
+    }
+    ASSERT(page % PageSize == 0 && data.size() <= PageSize);
+
+    Shard& shard = GetShard(page);
+    std::scoped_lock lock{shard.mutex};
+    u32 line_index;
+    if (const auto it = shard.index.find(page); it != shard.index.end()) {
+        // Another reader fetched the same page concurrently
+        line_index = it->second;
+        shard.Unlink(line_index);
+    } else if (shard.lines.size() < capacity_per_shard) {
+        line_index = static_cast<u32>(shard.lines.size());
+        shard.lines.push_back(Line{.data = std::make_unique<std::array<u8, PageSize>>()});
+        shard.index.emplace(page, line_index);
+    } else {
+        line_index = shard.least_recent;
+        shard.Unlink(line_index);
+        shard.index.erase(shard.lines[line_index].page);
+        shard.index.emplace(page, line_index);
+    }
+
+    Line& line = shard.lines[line_index];
+    line.page = page;
+    line.size = data.size();
+    std::memcpy(line.data->data(), data.data(), data.size());
+    shard.PushFront(line_index);
+}
+
+void RomFSPageCache::Clear() {
+    for (Shard& shard : shards) {
+        std::scoped_lock lock{shard.mutex};
+        shard.index.clear();
+        shard.lines.clear();
+        shard.most_recent = INVALID_LINE;
+        shard.least_recent = INVALID_LINE;
+    }
+}
+
+void RomFSPageCache::Shard::Unlink(u32 line_index) {
+    Line& line = lines[line_index];
+    if (line.prev != INVALID_LINE) {
+        lines[line.prev].next = line.next;
+    } else {
+        most_recent = line.next;
+    }
+    if (line.next != INVALID_LINE) {
+        lines[line.next].prev = line.prev;
+    } else {
+        least_recent = line.prev;
+    }
+}
+
+void RomFSPageCache::Shard::PushFront(u32 line_index) {
+    Line& line = lines[line_index];
+    line.prev = INVALID_LINE;
+    line.next = most_recent;
+    if (most_recent != INVALID_LINE) {
+        lines[most_recent].prev = line_index;
+    } else {
+        least_recent = line_index;
+    }
+    most_recent = line_index;
+}
+
+} // namespace FileSys
@@ -0,0 +1,87 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+
+namespace FileSys {
+
+/**
+ * Thread-safe cache of fixed-size RomFS pages. Pages are spread across independently locked
+ * shards so concurrent readers rarely contend, and each shard evicts its least recently used page.
+ */
+class RomFSPageCache {
+public:
+    static constexpr std::size_t PageSize = 8 * 1024;
+    static constexpr std::size_t NumShards = 16;
+
+    /// @param capacity total size of the cached pages in bytes. A capacity of zero disables it.
+    explicit RomFSPageCache(std::size_t capacity);
+    ~RomFSPageCache();
+
+    /**
+     * Copies part of a cached page into the buffer.
+     * @param page offset of the page, aligned to PageSize.
+     * @param offset offset inside the page to start copying from.
+     * @returns the number of bytes copied, or std::nullopt if the page is not cached.
+     */
+    std::optional<std::size_t> Read(std::size_t page, std::size_t offset, std::size_t length,
+                                    u8* buffer);
+
+    /// Returns whether the page is cached.
+    bool Contains(std::size_t page) const;
+
+    /// Caches the data of a page, which may be shorter than PageSize at the end of the file.
+    void Insert(std::size_t page, std::span<const u8> data);
+
+    void Clear();
+
+    /// Returns the maximum number of cached pages.
+    std::size_t GetCapacity() const {
+        return capacity_per_shard * NumShards;
+    }
+
+private:
+    static constexpr u32 INVALID_LINE = 0xFFFFFFFF;
+
+    struct Line {
+        std::size_t page;
+        std::size_t size;
+        u32 prev;
+        u32 next;
+        std::unique_ptr<std::array<u8, PageSize>> data;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::size_t, u32> index;
+        std::vector<Line> lines;
+        u32 most_recent = INVALID_LINE;
+        u32 least_recent = INVALID_LINE;
+
+        void Unlink(u32 line);
+        void PushFront(u32 line);
+    };
+
+    Shard& GetShard(std::size_t page) {
+        return shards[(page / PageSize) % NumShards];
+    }
+
+    const Shard& GetShard(std::size_t page) const {
+        return shards[(page / PageSize) % NumShards];
+    }
+
+    std::size_t capacity_per_shard;
+    std::array<Shard, NumShards> shards;
+};
+
+} // namespace FileSys
@@ -4,6 +4,7 @@
 #include <cryptopp/modes.h>
 #include "common/archives.h"
 #include "common/logging/log.h"
+#include "common/settings.h"
 #include "core/file_sys/archive_artic.h"
 #include "core/file_sys/archive_backend.h"
 #include "core/file_sys/romfs_reader.h"
@@ -14,54 +15,62 @@ SERIALIZE_EXPORT_IMPL(FileSys::DirectRomFSReader)
 
 namespace FileSys {
 
+struct DirectRomFSReader::Decryptor {
+    CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption cipher;
+};
+
+static std::size_t GetRomFSCacheCapacity() {
+    return static_cast<std::size_t>(Settings::values.romfs_cache_size.GetValue()) * 1024 * 1024;
+}
+
+DirectRomFSReader::DirectRomFSReader() : cache(GetRomFSCacheCapacity()) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size)
+    : is_encrypted(false), file(std::move(file)), file_offset(file_offset), data_size(data_size),
+      cache(GetRomFSCacheCapacity()) {}
+
+DirectRomFSReader::DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset,
+                                     std::size_t data_size, const std::array<u8, 16>& key,
+                                     const std::array<u8, 16>& ctr, std::size_t crypto_offset)
+    : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
+      crypto_offset(crypto_offset), data_size(data_size), cache(GetRomFSCacheCapacity()) {}
+
+DirectRomFSReader::~DirectRomFSReader() = default;
+
 std::size_t DirectRomFSReader::ReadFile(std::size_t offset, std::size_t length, u8* buffer) {
     length = std::min(length, static_cast<std::size_t>(data_size) - offset);
     if (length == 0)
         return 0; // Crypto++ does not like zero size buffer
 
     const auto segments = BreakupRead(offset, length);
-    std::size_t read_progress = 0;
+    const bool sequential =
+        next_sequential_offset.exchange(offset + length, std::memory_order_relaxed) == offset;
 
     // Skip cache if the read is too big
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         length = file.ReadAtBytes(buffer, length, file_offset + offset);
         if (is_encrypted) {
-            CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-            d.Seek(crypto_offset + offset);
-            d.ProcessData(buffer, buffer, length);
+            Decrypt(buffer, length, offset);
         }
         LOG_TRACE(Service_FS, "RomFS Cache SKIP: offset={}, length={}", offset, length);
         return length;
     }
 
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::unique_lock<std::shared_mutex> read_guard(cache_mutex);
+    std::size_t read_progress = 0;
     for (const auto& seg : segments) {
-        std::size_t read_size = cache_line_size;
-        std::size_t page = OffsetToPage(seg.first);
-        // Check if segment is in cache
-        auto cache_entry = cache.request(page);
-        if (!cache_entry.first) {
-            // If not found, read from disk and cache the data
-            read_size = file.ReadAtBytes(cache_entry.second.data(), read_size, file_offset + page);
-            if (is_encrypted && read_size) {
-                CryptoPP::CTR_Mode<CryptoPP::AES>::Decryption d(key.data(), key.size(), ctr.data());
-                d.Seek(crypto_offset + page);
-                d.ProcessData(cache_entry.second.data(), cache_entry.second.data(), read_size);
-            }
-            LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
-                      (seg.first - page));
-        } else {
+        const std::size_t page = OffsetToPage(seg.first);
+        const auto cached = cache.Read(page, seg.first - page, seg.second, buffer + read_progress);
+        if (cached) {
             LOG_TRACE(Service_FS, "RomFS Cache HIT: page={}, length={}, into={}", page, seg.second,
                       (seg.first - page));
+            read_progress += *cached;
+            continue;
         }
-        std::size_t copy_amount =
-            (read_size > (seg.first - page))
-                ? std::min((seg.first - page) + seg.second, read_size) - (seg.first - page)
-                : 0;
-        std::memcpy(buffer + read_progress, cache_entry.second.data() + (seg.first - page),
-                    copy_amount);
-        read_progress += copy_amount;
+        LOG_TRACE(Service_FS, "RomFS Cache MISS: page={}, length={}, into={}", page, seg.second,
+                  (seg.first - page));
+        read_progress += FetchPages(page, sequential ? readahead_pages : 1, seg.first - page,
+                                    seg.second, buffer + read_progress);
     }
     return read_progress;
 }
@@ -71,24 +80,64 @@ bool DirectRomFSReader::AllowsCachedReads() const {
 }
 
 bool DirectRomFSReader::CacheReady(std::size_t file_offset, std::size_t length) {
-    auto segments = BreakupRead(file_offset, length);
+    const auto segments = BreakupRead(file_offset, length);
     if (segments.size() == 1 && segments[0].second > cache_line_size) {
         return false;
-    } else {
-        // TODO(PabloMK7): Since the LRU cache is not thread safe, a lock must be used.
-        // However, this completely breaks the point of using a cache, because
-        // smaller reads may be blocked by bigger reads. For now, always return
-        // data being in cache to prevent the need of a lock, and only read data
-        // asynchronously if it is too big to use the cache.
-        /*
-        std::shared_lock<std::shared_mutex> read_guard(cache_mutex);
-        for (auto it = segments.begin(); it != segments.end(); it++) {
-            if (!cache.contains(OffsetToPage(it->first)))
-                return false;
+    }
+    return std::all_of(segments.begin(), segments.end(), [this](const auto& seg) {
+        return cache.Contains(OffsetToPage(seg.first));
+    });
+}
+
+std::size_t DirectRomFSReader::FetchPages(std::size_t page, std::size_t num_pages,
+                                          std::size_t offset, std::size_t length, u8* buffer) {
+    // Stop the readahead at the end of the RomFS or at the first page that is already cached
+    std::size_t count = 1;
+    while (count < num_pages && page + count * cache_line_size < data_size &&
+           !cache.Contains(page + count * cache_line_size)) {
+        ++count;
+    }
+
+    std::vector<u8> data(count * cache_line_size);
+    std::size_t read_size = file.ReadAtBytes(data.data(), data.size(), file_offset + page);
+    if (read_size > data.size()) {
+        // Read error
+        read_size = 0;
+    }
+    if (is_encrypted && read_size) {
+        Decrypt(data.data(), read_size, page);
+    }
+    for (std::size_t pos = 0; pos < read_size; pos += cache_line_size) {
+        cache.Insert(page + pos,
+                     {data.data() + pos, std::min(cache_line_size, read_size - pos)});
+    }
+
+    const std::size_t page_size = std::min(read_size, cache_line_size);
+    const std::size_t copy_amount =
+        page_size > offset ? std::min(offset + length, page_size) - offset : 0;
+    std::memcpy(buffer, data.data() + offset, copy_amount);
+    return copy_amount;
+}
+
+void DirectRomFSReader::Decrypt(u8* data, std::size_t length, std::size_t offset) {
+    std::unique_ptr<Decryptor> decryptor;
+    {
+        std::scoped_lock lock{decryptors_mutex};
+        if (!decryptors.empty()) {
+            decryptor = std::move(decryptors.back());
+            decryptors.pop_back();
         }
-        */
-        return true;
     }
+    if (!decryptor) {
+        decryptor = std::make_unique<Decryptor>();
+        decryptor->cipher.SetKeyWithIV(key.data(), key.size(), ctr.data());
+    }
+
+    decryptor->cipher.Seek(crypto_offset + offset);
+    decryptor->cipher.ProcessData(data, data, length);
+
+    std::scoped_lock lock{decryptors_mutex};
+    decryptors.push_back(std::move(decryptor));
 }
 
 std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
@@ -114,8 +163,8 @@ std::vector<std::pair<std::size_t, std::size_t>> DirectRomFSReader::BreakupRead(
 }
 
 ArticRomFSReader::ArticRomFSReader(std::shared_ptr<Network::ArticBase::Client>& cli,
-                                   bool is_update_romfs)
-    : client(cli), cache(cli) {
+                                   bool is_update_romfs_)
+    : client(cli), is_update_romfs(is_update_romfs_), cache(cli) {
     auto req = client->NewRequest("FSUSER_OpenFileDirectly");
 
     FileSys::Path archive(FileSys::LowPathType::Empty, {});
@@ -202,6 +251,12 @@ bool ArticRomFSReader::CacheReady(std::size_t file_offset, std::size_t length) {
     return cache.CacheReady(file_offset, length);
 }
 
+bool ArticRomFSReader::EnableDiskCache(u64 title_id, u16 content_version, std::size_t capacity) {
+    cache.ForceSetSize(data_size);
+    return cache.EnableDiskCache(romfs_handle, title_id, content_version, is_update_romfs,
+                                 capacity);
+}
+
 void ArticRomFSReader::CloseFile() {
     if (romfs_handle != -1) {
         auto req = client->NewRequest("FSFILE_Close");
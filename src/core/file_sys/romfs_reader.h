@@ -1,15 +1,17 @@
 #pragma once
 
 #include <array>
-#include <shared_mutex>
+#include <atomic>
+#include <memory>
+#include <mutex>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/export.hpp>
 #include "common/alignment.h"
 #include "common/common_types.h"
 #include "common/file_util.h"
-#include "common/static_lru_cache.h"
 #include "core/file_sys/artic_cache.h"
+#include "core/file_sys/romfs_page_cache.h"
 #include "network/artic_base/artic_base_client.h"
 
 namespace Loader {
@@ -41,17 +43,13 @@ private:
  */
 class DirectRomFSReader : public RomFSReader {
 public:
-    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size)
-        : is_encrypted(false), file(std::move(file)), file_offset(file_offset),
-          data_size(data_size) {}
+    DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size);
 
     DirectRomFSReader(FileUtil::IOFile&& file, std::size_t file_offset, std::size_t data_size,
                       const std::array<u8, 16>& key, const std::array<u8, 16>& ctr,
-                      std::size_t crypto_offset)
-        : is_encrypted(true), file(std::move(file)), key(key), ctr(ctr), file_offset(file_offset),
-          crypto_offset(crypto_offset), data_size(data_size) {}
+                      std::size_t crypto_offset);
 
-    ~DirectRomFSReader() override = default;
+    ~DirectRomFSReader() override;
 
     std::size_t GetSize() const override {
         return data_size;
@@ -72,15 +70,21 @@ private:
     u64 crypto_offset;
     u64 data_size;
 
-    // Total cache size: 128KB
-    static constexpr std::size_t cache_line_size = (1 << 13); // About 8KB
-    static constexpr std::size_t cache_line_count = 16;
+    static constexpr std::size_t cache_line_size = RomFSPageCache::PageSize;
+    // Pages fetched at once when the title reads the RomFS sequentially
+    static constexpr std::size_t readahead_pages = 8;
 
-    Common::StaticLRUCache<std::size_t, std::array<u8, cache_line_size>, cache_line_count> cache;
-    // TODO(PabloMK7): Make cache thread safe, read the comment in CacheReady function.
-    // std::shared_mutex cache_mutex;
+    // Thread-safe, so it may be used by reads running on the async FS worker threads
+    RomFSPageCache cache;
+    // Offset right after the previous read, used to detect sequential reads
+    std::atomic<std::size_t> next_sequential_offset{0};
 
-    DirectRomFSReader() = default;
+    // Keyed AES-CTR decryptors are reused across reads instead of being set up on each miss.
+    struct Decryptor;
+    std::mutex decryptors_mutex;
+    std::vector<std::unique_ptr<Decryptor>> decryptors;
+
+    DirectRomFSReader();
 
     std::size_t OffsetToPage(std::size_t offset) {
         return Common::AlignDown<std::size_t>(offset, cache_line_size);
@@ -89,6 +93,14 @@ private:
     std::vector<std::pair<std::size_t, std::size_t>> BreakupRead(std::size_t offset,
                                                                  std::size_t length);
 
+    /// Reads the page and up to num_pages - 1 following ones into the cache and copies the
+    /// requested part of the first page into the buffer. Returns the number of bytes copied.
+    std::size_t FetchPages(std::size_t page, std::size_t num_pages, std::size_t offset,
+                           std::size_t length, u8* buffer);
+
+    /// Decrypts data read from the specified offset of the RomFS in place.
+    void Decrypt(u8* data, std::size_t length, std::size_t offset);
+
     template <class Archive>
     void serialize(Archive& ar, const unsigned int) {
         ar& boost::serialization::base_object<RomFSReader>(*this);
@@ -131,12 +143,16 @@ public:
         cache.Clear();
     }
 
+    /// Keeps the data read from the server in a persistent disk cache of the given size in bytes.
+    bool EnableDiskCache(u64 title_id, u16 content_version, std::size_t capacity);
+
     void CloseFile();
 
 private:
     std::shared_ptr<Network::ArticBase::Client> client;
     size_t data_size = 0;
     s32 romfs_handle = -1;
+    bool is_update_romfs = false;
     Loader::ResultStatus load_status;
 
     ArticCache cache;
@@ -0,0 +1,222 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "common/assert.h"
+#include "common/logging/log.h"
+#include "common/thread.h"
+#include "core/hle/kernel/async_executor.h"
+
+namespace Kernel {
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+struct QueueConfig {
+    const char* name;
+    std::size_t max_workers;
+    std::size_t max_depth;
+};
+
+// Socket calls may block until the peer acts, so that queue gets the most workers.
+constexpr std::array<QueueConfig, static_cast<std::size_t>(AsyncQueue::Count)> QueueConfigs{{
+    {"HLE FileSystem", 4, 1024},
+    {"HLE Install", 2, 64},
+    {"HLE HTTP", 8, 256},
+    {"HLE Socket", 32, 256},
+    {"HLE Async", 4, 256},
+}};
+
+double ToMicroseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+} // Anonymous namespace
+
+class AsyncExecutor::Pool {
+public:
+    explicit Pool(const QueueConfig& config_) : config(config_) {}
+
+    ~Pool() {
+        Shutdown();
+    }
+
+    std::future<void> Run(Common::UniqueFunction<void> task) {
+        Request request{std::move(task), {}, Clock::now()};
+        std::future<void> future = request.done.get_future();
+
+        std::unique_lock lock{mutex};
+        if (stopping) {
+            ++cancelled;
+            request.done.set_value();
+            return future;
+        }
+        if (requests.size() >= config.max_depth) {
+            ++ran_inline;
+            RunRequest(request, lock);
+            return future;
+        }
+
+        requests.push_back(std::move(request));
+        max_depth = std::max(max_depth, requests.size());
+        if (idle_workers < requests.size() && workers.size() < config.max_workers) {
+            workers.emplace_back([this] { WorkerLoop(); });
+        }
+        lock.unlock();
+        work_available.notify_one();
+        return future;
+    }
+
+    void Shutdown() {
+        std::deque<Request> dropped;
+        std::vector<std::thread> stopped_workers;
+        {
+            std::scoped_lock lock{mutex};
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+            dropped = std::move(requests);
+            requests.clear();
+            cancelled += dropped.size();
+            stopped_workers = std::move(workers);
+        }
+        work_available.notify_all();
+
+        for (auto& request : dropped) {
+            request.done.set_value();
+        }
+        for (auto& worker : stopped_workers) {
+            worker.join();
+        }
+
+        const QueueStats stats = GetStats();
+        if (stats.completed != 0 || stats.cancelled != 0) {
+            LOG_DEBUG(Kernel,
+                      "{}: {} completed, {} cancelled, {} ran inline, max depth {}, wait mean "
+                      "{:.0f}us max {:.0f}us, run mean {:.0f}us max {:.0f}us",
+                      config.name, stats.completed, stats.cancelled, stats.ran_inline,
+                      stats.max_depth, stats.mean_wait_us, stats.max_wait_us, stats.mean_run_us,
+                      stats.max_run_us);
+        }
+    }
+
+    QueueStats GetStats() const {
+        std::scoped_lock lock{mutex};
+        const double started = static_cast<double>(std::max<u64>(completed + running, 1));
+        const double finished = static_cast<double>(std::max<u64>(completed, 1));
+        return QueueStats{
+            .completed = completed,
+            .cancelled = cancelled,
+            .ran_inline = ran_inline,
+            .depth = requests.size(),
+            .max_depth = max_depth,
+            .workers = started_workers,
+            .mean_wait_us = ToMicroseconds(total_wait) / started,
+            .max_wait_us = ToMicroseconds(max_wait),
+            .mean_run_us = ToMicroseconds(total_run) / finished,
+            .max_run_us = ToMicroseconds(max_run),
+        };
+    }
+
+private:
+    struct Request {
+        Common::UniqueFunction<void> task;
+        std::promise<void> done;
+        Clock::time_point queued;
+    };
+
+    void WorkerLoop() {
+        Common::SetCurrentThreadName(config.name);
+
+        std::unique_lock lock{mutex};
+        ++started_workers;
+        while (true) {
+            ++idle_workers;
+            work_available.wait(lock, [this] { return stopping || !requests.empty(); });
+            --idle_workers;
+            if (stopping) {
+                return;
+            }
+
+            Request request = std::move(requests.front());
+            requests.pop_front();
+            RunRequest(request, lock);
+        }
+    }
+
+    /// Runs the request with the mutex unlocked and records its statistics. Called with the mutex
+    /// held, and returns with it held again.
+    void RunRequest(Request& request, std::unique_lock<std::mutex>& lock) {
+        const auto start = Clock::now();
+        total_wait += start - request.queued;
+        max_wait = std::max(max_wait, start - request.queued);
+        ++running;
+        lock.unlock();
+
+        request.task();
+
+        const auto run_time = Clock::now() - start;
+        lock.lock();
+        --running;
+        ++completed;
+        total_run += run_time;
+        max_run = std::max(max_run, run_time);
+
+        // Completed only once the statistics include the request
+        request.done.set_value();
+    }
+
+    const QueueConfig& config;
+
+    mutable std::mutex mutex;
+    std::condition_variable work_available;
+    std::deque<Request> requests;
+    std::vector<std::thread> workers;
+    std::size_t idle_workers = 0;
+    bool stopping = false;
+
+    u64 completed = 0;
+    u64 cancelled = 0;
+    u64 ran_inline = 0;
+    u64 running = 0;
+    std::size_t max_depth = 0;
+    std::size_t started_workers = 0;
+    Clock::duration total_wait{};
+    Clock::duration max_wait{};
+    Clock::duration total_run{};
+    Clock::duration max_run{};
+};
+
+AsyncExecutor::AsyncExecutor() {
+    for (std::size_t i = 0; i < pools.size(); i++) {
+        pools[i] = std::make_unique<Pool>(QueueConfigs[i]);
+    }
+}
+
+AsyncExecutor::~AsyncExecutor() {
+    Shutdown();
+}
+
+std::future<void> AsyncExecutor::Run(AsyncQueue queue, Common::UniqueFunction<void> task) {
+    ASSERT(queue < AsyncQueue::Count);
+    return pools[static_cast<std::size_t>(queue)]->Run(std::move(task));
+}
+
+void AsyncExecutor::Shutdown() {
+    for (auto& pool : pools) {
+        pool->Shutdown();
+    }
+}
+
+AsyncExecutor::QueueStats AsyncExecutor::GetStats(AsyncQueue queue) const {
+    ASSERT(queue < AsyncQueue::Count);
+    return pools[static_cast<std::size_t>(queue)]->GetStats();
+}
+
+} // namespace Kernel
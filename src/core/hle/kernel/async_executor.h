@@ -0,0 +1,75 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include "common/common_types.h"
+#include "common/unique_function.h"
+
+namespace Kernel {
+
+/// Class of service an async HLE request belongs to. Each class has its own workers, so that slow
+/// requests of one service, like blocking socket calls, do not hold up the others.
+enum class AsyncQueue : u32 {
+    FileSystem,
+    Install,
+    Http,
+    Socket,
+    Other,
+    Count,
+};
+
+/**
+ * Runs the async sections of HLE requests (see HLERequestContext::RunAsync) on persistent worker
+ * threads. Workers of a queue are started on demand up to a fixed count and then reused. Each
+ * queue holds a bounded number of pending requests. A task submitted to a full queue runs on the
+ * submitting thread instead, because waiting for space could deadlock when the pending requests
+ * need the emulation thread to make progress.
+ */
+class AsyncExecutor {
+public:
+    struct QueueStats {
+        u64 completed;         ///< Requests that ran to completion
+        u64 cancelled;         ///< Requests dropped on shutdown before they started
+        u64 ran_inline;        ///< Requests run on the submitting thread as the queue was full
+        std::size_t depth;     ///< Requests currently waiting for a worker
+        std::size_t max_depth; ///< Most requests that waited at the same time
+        std::size_t workers;   ///< Worker threads started
+        double mean_wait_us;   ///< Mean time from submission until a worker picked it up
+        double max_wait_us;    ///< Longest time a request waited for a worker
+        double mean_run_us;    ///< Mean time a request ran for
+        double max_run_us;     ///< Longest time a request ran for
+    };
+
+    AsyncExecutor();
+    ~AsyncExecutor();
+
+    AsyncExecutor(const AsyncExecutor&) = delete;
+    AsyncExecutor& operator=(const AsyncExecutor&) = delete;
+
+    /**
+     * Queues a task, or runs it before returning if the queue is full.
+     * @returns A future that becomes ready when the task has run, or was cancelled by Shutdown.
+     */
+    std::future<void> Run(AsyncQueue queue, Common::UniqueFunction<void> task);
+
+    /**
+     * Cancels the pending tasks of every queue and waits for the running ones to finish. Tasks
+     * submitted afterwards are cancelled right away.
+     */
+    void Shutdown();
+
+    QueueStats GetStats(AsyncQueue queue) const;
+
+private:
+    class Pool;
+
+    std::array<std::unique_ptr<Pool>, static_cast<std::size_t>(AsyncQueue::Count)> pools;
+};
+
+} // namespace Kernel
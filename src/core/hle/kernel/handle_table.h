@@ -89,6 +89,28 @@ public:
         return DynamicObjectCast<T>(GetGeneric(handle));
     }
 
+    /**
+     * Looks up a handle without taking a reference to the object. The object is only kept alive
+     * by the handle, so the pointer may be used for the duration of an SVC that neither closes
+     * handles nor switches processes, but must not be stored.
+     *
+     * Signaling an object wakes its waiting threads and runs their wakeup callbacks, which may
+     * close handles, so SVCs that signal or release objects must use Get instead.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid.
+     */
+    Object* BorrowGeneric(Handle handle) const;
+
+    /**
+     * Looks up a handle without taking a reference to the object, while verifying its type. See
+     * BorrowGeneric for how long the pointer may be used.
+     * @return Pointer to the looked-up object, or `nullptr` if the handle is not valid or its
+     *         type differs from the requested one.
+     */
+    template <class T>
+    T* Borrow(Handle handle) const {
+        return DynamicObjectCast<T>(BorrowGeneric(handle));
+    }
+
     /// Closes all handles held in this table.
     void Clear();
 
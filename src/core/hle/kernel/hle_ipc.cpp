@@ -13,12 +13,14 @@
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "core/core.h"
+#include "core/hle/kernel/async_executor.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
 #include "core/hle/kernel/hle_ipc.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/process.h"
+#include "core/memory.h"
 
 SERIALIZE_EXPORT_IMPL(Kernel::SessionRequestHandler)
 SERIALIZE_EXPORT_IMPL(Kernel::SessionRequestHandler::SessionDataBase)
@@ -28,6 +30,46 @@ SERIALIZE_EXPORT_IMPL(Kernel::HLERequestContext::ThreadCallback)
 
 namespace Kernel {
 
+namespace {
+/**
+ * The command buffer of a thread, followed by its static buffer descriptors, which the
+ * translation needs in order to find the StaticBuffer target addresses. The area lives in the
+ * thread's TLS and is accessed in place when it is backed by plain memory, and through a copy
+ * otherwise.
+ */
+class ThreadCommandBuffer {
+public:
+    ThreadCommandBuffer(Memory::MemorySystem& memory_, const Process& process_, VAddr address_)
+        : memory(memory_), process(process_), address(address_) {
+        const auto span = memory.GetContiguousSpan(process, address, sizeof(copy));
+        if (!span.empty() && reinterpret_cast<uintptr_t>(span.data()) % alignof(u32_le) == 0) {
+            words = reinterpret_cast<u32_le*>(span.data());
+        } else {
+            memory.ReadBlock(process, address, copy.data(), sizeof(copy));
+            words = copy.data();
+        }
+    }
+
+    u32_le* data() {
+        return words;
+    }
+
+    /// Makes changes visible to the thread, which is only needed when accessing a copy.
+    void Commit() {
+        if (words == copy.data()) {
+            memory.WriteBlock(process, address, copy.data(), sizeof(copy));
+        }
+    }
+
+private:
+    Memory::MemorySystem& memory;
+    const Process& process;
+    VAddr address;
+    u32_le* words;
+    std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> copy;
+};
+} // Anonymous namespace
+
 class HLERequestContext::ThreadCallback : public Kernel::WakeupCallback {
 
 public:
@@ -43,18 +85,7 @@ public:
 
         auto process = thread->owner_process.lock();
         ASSERT(process);
-
-        // We must copy the entire command buffer *plus* the entire static buffers area, since
-        // the translation might need to read from it in order to retrieve the StaticBuffer
-        // target addresses.
-        std::array<u32_le, IPC::COMMAND_BUFFER_LENGTH + 2 * IPC::MAX_STATIC_BUFFERS> cmd_buff;
-        Memory::MemorySystem& memory = context->kernel.memory;
-        memory.ReadBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                         cmd_buff.size() * sizeof(u32));
-        context->WriteToOutgoingCommandBuffer(cmd_buff.data(), *process);
-        // Copy the translated command buffer back into the thread's command buffer area.
-        memory.WriteBlock(*process, thread->GetCommandBufferAddress(), cmd_buff.data(),
-                          cmd_buff.size() * sizeof(u32));
+        context->WriteToOutgoingCommandBuffer(*process);
     }
 
 private:
@@ -122,6 +153,12 @@ std::shared_ptr<Event> HLERequestContext::SleepClientThread(
     return event;
 }
 
+std::future<void> HLERequestContext::QueueAsync(Common::UniqueFunction<void> async_section) {
+    const auto& handler = session->hle_handler;
+    const AsyncQueue queue = handler ? handler->GetAsyncQueue() : AsyncQueue::Other;
+    return kernel.GetAsyncExecutor().Run(queue, std::move(async_section));
+}
+
 HLERequestContext::HLERequestContext() : kernel(Core::Global<KernelSystem>()) {}
 
 HLERequestContext::HLERequestContext(KernelSystem& kernel, std::shared_ptr<ServerSession> session,
@@ -165,13 +202,6 @@ Result HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cm
 
     std::copy_n(src_cmdbuf, untranslated_size, cmd_buf.begin());
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
-
-    std::vector<u32> untranslated_cmdbuf;
-    if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{src_cmdbuf, src_cmdbuf + command_size};
-    }
-
     std::size_t i = untranslated_size;
     while (i < command_size) {
         u32 descriptor = cmd_buf[i] = src_cmdbuf[i];
@@ -205,9 +235,17 @@ Result HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cm
             VAddr source_address = src_cmdbuf[i];
             IPC::StaticBufferDescInfo buffer_info{descriptor};
 
-            // Copy the input buffer into our own vector and store it.
-            std::vector<u8> data(buffer_info.size);
-            kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
+            // Copy the input buffer into our own vector and store it. The copy is taken straight
+            // from guest memory when the buffer does not cross into other kinds of pages.
+            std::vector<u8> data;
+            const auto source =
+                kernel.memory.GetContiguousSpan(src_process, source_address, buffer_info.size);
+            if (!source.empty()) {
+                data.assign(source.begin(), source.end());
+            } else {
+                data.resize(buffer_info.size);
+                kernel.memory.ReadBlock(src_process, source_address, data.data(), data.size());
+            }
 
             AddStaticBuffer(buffer_info.buffer_id, std::move(data));
             cmd_buf[i++] = source_address;
@@ -225,10 +263,12 @@ Result HLERequestContext::PopulateFromIncomingCommandBuffer(const u32_le* src_cm
         }
     }
 
-    if (should_record) {
-        std::vector<u32> translated_cmdbuf{cmd_buf.begin(), cmd_buf.begin() + command_size};
-        kernel.GetIPCRecorder().SetRequestInfo(thread, std::move(untranslated_cmdbuf),
-                                               std::move(translated_cmdbuf));
+    // The source is left untouched by the translation, so the debugger copies are only made
+    // here, when it is recording.
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().SetRequestInfo(
+            thread, std::vector<u32>{src_cmdbuf, src_cmdbuf + command_size},
+            std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size});
     }
 
     return ResultSuccess;
@@ -244,13 +284,6 @@ Result HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
 
     std::copy_n(cmd_buf.begin(), untranslated_size, dst_cmdbuf);
 
-    const bool should_record = kernel.GetIPCRecorder().IsEnabled();
-
-    std::vector<u32> untranslated_cmdbuf;
-    if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size};
-    }
-
     std::size_t i = untranslated_size;
     while (i < command_size) {
         u32 descriptor = dst_cmdbuf[i] = cmd_buf[i];
@@ -303,15 +336,27 @@ Result HLERequestContext::WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf,
         }
     }
 
-    if (should_record) {
-        std::vector<u32> translated_cmdbuf{dst_cmdbuf, dst_cmdbuf + command_size};
-        kernel.GetIPCRecorder().SetReplyInfo(thread, std::move(untranslated_cmdbuf),
-                                             std::move(translated_cmdbuf));
+    if (kernel.GetIPCRecorder().IsEnabled()) {
+        kernel.GetIPCRecorder().SetReplyInfo(
+            thread, std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size},
+            std::vector<u32>{dst_cmdbuf, dst_cmdbuf + command_size});
     }
 
     return ResultSuccess;
 }
 
+Result HLERequestContext::PopulateFromIncomingCommandBuffer(std::shared_ptr<Process> src_process) {
+    ThreadCommandBuffer src_cmdbuf{kernel.memory, *src_process, thread->GetCommandBufferAddress()};
+    return PopulateFromIncomingCommandBuffer(src_cmdbuf.data(), std::move(src_process));
+}
+
+Result HLERequestContext::WriteToOutgoingCommandBuffer(Process& dst_process) const {
+    ThreadCommandBuffer dst_cmdbuf{kernel.memory, dst_process, thread->GetCommandBufferAddress()};
+    const Result result = WriteToOutgoingCommandBuffer(dst_cmdbuf.data(), dst_process);
+    dst_cmdbuf.Commit();
+    return result;
+}
+
 MappedBuffer& HLERequestContext::GetMappedBuffer(u32 id_from_cmdbuf) {
     ASSERT_MSG(id_from_cmdbuf < request_mapped_buffers.size(), "Mapped Buffer ID out of range!");
     return request_mapped_buffers[id_from_cmdbuf];
@@ -18,6 +18,7 @@
 #include "common/serialization/boost_small_vector.hpp"
 #include "common/swap.h"
 #include "core/hle/ipc.h"
+#include "core/hle/kernel/async_executor.h"
 #include "core/hle/kernel/object.h"
 #include "core/hle/kernel/server_session.h"
 
@@ -68,6 +69,11 @@ public:
      */
     virtual void ClientDisconnected(std::shared_ptr<ServerSession> server_session);
 
+    /// Returns the queue that runs the async sections of this handler's requests, see RunAsync.
+    virtual AsyncQueue GetAsyncQueue() const {
+        return AsyncQueue::Other;
+    }
+
     /// Empty placeholder structure for services with no per-session data. The session data classes
     /// in each service must inherit from this.
     struct SessionDataBase {
@@ -227,6 +233,11 @@ public:
         return thread;
     }
 
+    /// Returns the kernel that is handling the service request.
+    KernelSystem& GetKernel() const {
+        return kernel;
+    }
+
     class WakeupCallback {
     public:
         virtual ~WakeupCallback() = default;
@@ -290,7 +301,9 @@ public:
      * while the one performing the blocking operation waits.
      * @param async_section Callable that takes Kernel::HLERequestContext& as argument
      * and returns the amount of nanoseconds to wait before calling result_function.
-     * This callable is ran asynchronously.
+     * This callable is ran asynchronously, on a worker of the queue returned by
+     * SessionRequestHandler::GetAsyncQueue. If that queue is full, it is ran on the emulator
+     * thread before RunAsync returns.
      * @param result_function Callable that takes Kernel::HLERequestContext& as argument
      * and doesn't return anything. This callable is ran from the emulator thread
      * and can be used to set the IPC result.
@@ -305,11 +318,10 @@ public:
             this->SleepClientThread(
                 "RunAsync", std::chrono::nanoseconds(-1),
                 std::make_shared<AsyncWakeUpCallback<ResultFunctor>>(
-                    result_function,
-                    std::move(std::async(std::launch::async, [this, async_section] {
+                    result_function, QueueAsync([this, async_section] {
                         s64 sleep_for = async_section(*this);
                         this->thread->WakeAfterDelay(sleep_for, true);
-                    }))));
+                    })));
 
         } else {
             s64 sleep_for = async_section(*this);
@@ -367,6 +379,12 @@ public:
     /// Writes data from this context back to the requesting process/thread.
     Result WriteToOutgoingCommandBuffer(u32_le* dst_cmdbuf, Process& dst_process) const;
 
+    /// Populates this context from the command buffer of the requesting thread. The command buffer
+    /// is read in place, without copying it out of guest memory first when possible.
+    Result PopulateFromIncomingCommandBuffer(std::shared_ptr<Process> src_process);
+    /// Writes data from this context back to the command buffer of the requesting thread.
+    Result WriteToOutgoingCommandBuffer(Process& dst_process) const;
+
     /// Reports an unimplemented function.
     void ReportUnimplemented() const;
 
@@ -374,6 +392,9 @@ public:
     friend class ThreadCallback;
 
 private:
+    /// Queues the async section of a request on the executor queue of the session's handler.
+    std::future<void> QueueAsync(Common::UniqueFunction<void> async_section);
+
     KernelSystem& kernel;
     std::array<u32, IPC::COMMAND_BUFFER_LENGTH> cmd_buf;
     std::shared_ptr<ServerSession> session;
@@ -0,0 +1,330 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <utility>
+#include <fmt/format.h>
+#include <json.hpp>
+#include "core/hle/kernel/hle_profiler.h"
+
+namespace Kernel {
+
+namespace {
+struct CommandInfo {
+    std::string service;
+    u32 command_id;
+    std::string name;
+};
+
+/// Commands are registered by the services of every system, so the registry is shared by all.
+struct CommandRegistry {
+    std::mutex mutex;
+    std::vector<CommandInfo> commands;
+    std::map<std::pair<std::string, u32>, u32> slots;
+};
+
+CommandRegistry& GetCommandRegistry() {
+    static CommandRegistry registry;
+    return registry;
+}
+
+std::atomic<u64> next_instance_id{1};
+
+u64 ToNanoseconds(HLEProfiler::Clock::duration time) {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(time).count();
+    return static_cast<u64>(std::max<decltype(ns)>(ns, 0));
+}
+} // Anonymous namespace
+
+struct HLEProfiler::Counter {
+    std::atomic<u64> count{0};
+    std::atomic<u64> total_ns{0};
+    std::atomic<u64> max_ns{0};
+    std::array<std::atomic<u64>, NumBuckets> histogram{};
+
+    void Clear() {
+        count.store(0, std::memory_order_relaxed);
+        total_ns.store(0, std::memory_order_relaxed);
+        max_ns.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    void AddTo(CallStats& stats) const {
+        stats.count += count.load(std::memory_order_relaxed);
+        stats.total_ns += total_ns.load(std::memory_order_relaxed);
+        stats.max_ns = std::max(stats.max_ns, max_ns.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < NumBuckets; i++) {
+            stats.histogram[i] += histogram[i].load(std::memory_order_relaxed);
+        }
+    }
+};
+
+struct HLEProfiler::CommandChunk {
+    static constexpr std::size_t Size = 64;
+    std::array<Counter, Size> counters;
+};
+
+/// Counters of one thread. Only that thread adds chunks, which other threads may then read.
+struct HLEProfiler::Shard {
+    std::array<Counter, NumSVCs> svcs;
+    std::array<std::atomic<CommandChunk*>, MaxCommands / CommandChunk::Size> command_chunks{};
+
+    ~Shard() {
+        for (auto& chunk : command_chunks) {
+            delete chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    Counter& GetCommand(u32 slot) {
+        auto& chunk = command_chunks[slot / CommandChunk::Size];
+        CommandChunk* counters = chunk.load(std::memory_order_relaxed);
+        if (!counters) {
+            counters = new CommandChunk;
+            chunk.store(counters, std::memory_order_release);
+        }
+        return counters->counters[slot % CommandChunk::Size];
+    }
+};
+
+HLEProfiler::HLEProfiler() : instance_id(next_instance_id++) {}
+
+HLEProfiler::~HLEProfiler() = default;
+
+void HLEProfiler::SetEnabled(bool enable) {
+    enabled.store(enable, std::memory_order_relaxed);
+}
+
+void HLEProfiler::Reset() {
+    std::scoped_lock lock{shards_mutex};
+    for (auto& shard : shards) {
+        for (auto& counter : shard->svcs) {
+            counter.Clear();
+        }
+        for (auto& chunk : shard->command_chunks) {
+            if (CommandChunk* counters = chunk.load(std::memory_order_acquire)) {
+                for (auto& counter : counters->counters) {
+                    counter.Clear();
+                }
+            }
+        }
+    }
+}
+
+void HLEProfiler::RecordSVC(u32 id, const char* name, Clock::duration time) {
+    if (id >= NumSVCs) {
+        return;
+    }
+    // Every caller stores the same pointer, so it does not matter who gets there first.
+    if (!svc_names[id].load(std::memory_order_relaxed)) {
+        svc_names[id].store(name, std::memory_order_relaxed);
+    }
+    Record(GetShard().svcs[id], time);
+}
+
+void HLEProfiler::RecordCommand(u32 slot, Clock::duration time) {
+    if (slot >= MaxCommands) {
+        return;
+    }
+    Record(GetShard().GetCommand(slot), time);
+}
+
+void HLEProfiler::Record(Counter& counter, Clock::duration time) {
+    const u64 ns = ToNanoseconds(time);
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+    counter.total_ns.fetch_add(ns, std::memory_order_relaxed);
+    counter.histogram[BucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+    // Only this thread raises the maximum, so no compare-exchange is needed.
+    if (ns > counter.max_ns.load(std::memory_order_relaxed)) {
+        counter.max_ns.store(ns, std::memory_order_relaxed);
+    }
+}
+
+HLEProfiler::Shard& HLEProfiler::GetShard() {
+    struct CachedShard {
+        u64 instance_id = 0;
+        Shard* shard = nullptr;
+    };
+    thread_local CachedShard cached;
+
+    if (cached.instance_id != instance_id) {
+        std::scoped_lock lock{shards_mutex};
+        shards.push_back(std::make_unique<Shard>());
+        cached = {instance_id, shards.back().get()};
+    }
+    return *cached.shard;
+}
+
+u32 HLEProfiler::RegisterCommand(std::string_view service, u32 command_id, const char* name) {
+    auto& registry = GetCommandRegistry();
+    std::scoped_lock lock{registry.mutex};
+
+    const auto it = registry.slots.find(std::make_pair(std::string{service}, command_id));
+    if (it != registry.slots.end()) {
+        return it->second;
+    }
+    if (registry.commands.size() >= MaxCommands) {
+        return InvalidSlot;
+    }
+
+    const auto slot = static_cast<u32>(registry.commands.size());
+    registry.commands.push_back({std::string{service}, command_id, name ? name : ""});
+    registry.slots.emplace(std::make_pair(std::string{service}, command_id), slot);
+    return slot;
+}
+
+std::vector<HLEProfiler::CallStats> HLEProfiler::GetStats() const {
+    std::vector<CallStats> svcs(NumSVCs);
+    std::vector<CallStats> commands;
+    {
+        auto& registry = GetCommandRegistry();
+        std::scoped_lock lock{registry.mutex};
+        commands.resize(registry.commands.size());
+        for (std::size_t slot = 0; slot < commands.size(); slot++) {
+            const auto& info = registry.commands[slot];
+            commands[slot].service = info.service;
+            commands[slot].name = info.name;
+            commands[slot].id = info.command_id;
+        }
+    }
+
+    {
+        std::scoped_lock lock{shards_mutex};
+        for (const auto& shard : shards) {
+            for (std::size_t id = 0; id < NumSVCs; id++) {
+                shard->svcs[id].AddTo(svcs[id]);
+            }
+            for (std::size_t chunk = 0; chunk < shard->command_chunks.size(); chunk++) {
+                const CommandChunk* counters =
+                    shard->command_chunks[chunk].load(std::memory_order_acquire);
+                if (!counters) {
+                    continue;
+                }
+                for (std::size_t i = 0; i < CommandChunk::Size; i++) {
+                    const std::size_t slot = chunk * CommandChunk::Size + i;
+                    if (slot < commands.size()) {
+                        counters->counters[i].AddTo(commands[slot]);
+                    }
+                }
+            }
+        }
+    }
+
+    for (std::size_t id = 0; id < NumSVCs; id++) {
+        const char* name = svc_names[id].load(std::memory_order_relaxed);
+        svcs[id].id = static_cast<u32>(id);
+        svcs[id].name = name ? name : fmt::format("0x{:02X}", id);
+    }
+
+    const auto unused = [](const CallStats& stats) { return stats.count == 0; };
+    const auto by_total = [](const CallStats& a, const CallStats& b) {
+        return a.total_ns > b.total_ns;
+    };
+    std::erase_if(svcs, unused);
+    std::erase_if(commands, unused);
+    std::stable_sort(svcs.begin(), svcs.end(), by_total);
+    std::stable_sort(commands.begin(), commands.end(), by_total);
+
+    svcs.insert(svcs.end(), std::make_move_iterator(commands.begin()),
+                std::make_move_iterator(commands.end()));
+    return svcs;
+}
+
+std::string HLEProfiler::Dump(Format format) const {
+    const auto stats = GetStats();
+
+    if (format == Format::Csv) {
+        std::string csv = "service,id,name,count,total_ns,mean_ns,max_ns,p50_ns,p90_ns,p99_ns,"
+                          "histogram\n";
+        for (const auto& entry : stats) {
+            std::string histogram;
+            for (std::size_t i = 0; i < NumBuckets; i++) {
+                if (entry.histogram[i] != 0) {
+                    histogram += fmt::format("{}{}:{}", histogram.empty() ? "" : ";",
+                                             BucketLowerBound(i), entry.histogram[i]);
+                }
+            }
+            csv += fmt::format("{},0x{:X},{},{},{},{},{},{},{},{},{}\n",
+                               entry.service.empty() ? "svc" : entry.service, entry.id,
+                               entry.name, entry.count, entry.total_ns,
+                               entry.total_ns / entry.count, entry.max_ns, entry.Percentile(0.5),
+                               entry.Percentile(0.9), entry.Percentile(0.99), histogram);
+        }
+        return csv;
+    }
+
+    nlohmann::json json = {
+        {"enabled", IsEnabled()},
+        {"svcs", nlohmann::json::array()},
+        {"commands", nlohmann::json::array()},
+    };
+    for (const auto& entry : stats) {
+        nlohmann::json histogram = nlohmann::json::array();
+        for (std::size_t i = 0; i < NumBuckets; i++) {
+            if (entry.histogram[i] != 0) {
+                histogram.push_back({BucketLowerBound(i), entry.histogram[i]});
+            }
+        }
+        nlohmann::json item = {
+            {"id", entry.id},
+            {"name", entry.name},
+            {"count", entry.count},
+            {"total_ns", entry.total_ns},
+            {"mean_ns", entry.total_ns / entry.count},
+            {"max_ns", entry.max_ns},
+            {"p50_ns", entry.Percentile(0.5)},
+            {"p90_ns", entry.Percentile(0.9)},
+            {"p99_ns", entry.Percentile(0.99)},
+            {"histogram", std::move(histogram)},
+        };
+        if (entry.service.empty()) {
+            json["svcs"].push_back(std::move(item));
+        } else {
+            item["service"] = entry.service;
+            json["commands"].push_back(std::move(item));
+        }
+    }
+    return json.dump();
+}
+
+std::size_t HLEProfiler::BucketIndex(u64 ns) {
+    constexpr u64 sub_buckets = 1 << SubBucketBits;
+    if (ns < sub_buckets) {
+        return static_cast<std::size_t>(ns);
+    }
+    const std::size_t msb = std::bit_width(ns) - 1;
+    if (msb >= MaxLatencyBits) {
+        return NumBuckets - 1;
+    }
+    const std::size_t sub_bucket = (ns >> (msb - SubBucketBits)) & (sub_buckets - 1);
+    return ((msb - SubBucketBits + 1) << SubBucketBits) + sub_bucket;
+}
+
+u64 HLEProfiler::BucketLowerBound(std::size_t index) {
+    constexpr u64 sub_buckets = 1 << SubBucketBits;
+    if (index < sub_buckets) {
+        return index;
+    }
+    const std::size_t msb = (index >> SubBucketBits) - 1 + SubBucketBits;
+    const u64 sub_bucket = index & (sub_buckets - 1);
+    return (sub_buckets + sub_bucket) << (msb - SubBucketBits);
+}
+
+u64 HLEProfiler::CallStats::Percentile(double fraction) const {
+    const auto target = static_cast<u64>(fraction * static_cast<double>(count));
+    u64 seen = 0;
+    for (std::size_t i = 0; i < NumBuckets; i++) {
+        seen += histogram[i];
+        if (seen > target) {
+            const u64 upper = i + 1 < NumBuckets ? BucketLowerBound(i + 1) - 1 : max_ns;
+            return std::min(upper, max_ns);
+        }
+    }
+    return max_ns;
+}
+
+} // namespace Kernel
@@ -0,0 +1,115 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "common/common_types.h"
+
+namespace Kernel {
+
+/**
+ * Counts the calls to SVCs and HLE service commands and keeps log-linear histograms of how long
+ * they take on the host. It is always compiled in and is toggled at runtime; while disabled, a
+ * call costs a single relaxed load. Each thread records into its own shard without taking locks,
+ * and snapshots merge the shards.
+ *
+ * The time of an SVC includes the service command it dispatches, if any.
+ */
+class HLEProfiler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Every power of two of nanoseconds is split into 2^SubBucketBits linear buckets.
+    static constexpr std::size_t SubBucketBits = 2;
+    /// Latencies of 2^MaxLatencyBits nanoseconds (about a minute) and more share the last bucket.
+    static constexpr std::size_t MaxLatencyBits = 36;
+    static constexpr std::size_t NumBuckets = (MaxLatencyBits - SubBucketBits + 1)
+                                              << SubBucketBits;
+
+    static constexpr std::size_t NumSVCs = 256;
+    /// Service commands past this many registered ones are not profiled.
+    static constexpr std::size_t MaxCommands = 4096;
+    static constexpr u32 InvalidSlot = 0xFFFFFFFF;
+
+    enum class Format {
+        Json,
+        Csv,
+    };
+
+    struct CallStats {
+        std::string service; ///< Name of the service, empty for SVCs
+        std::string name;    ///< Name of the SVC or command
+        u32 id;              ///< Number of the SVC or ID of the command
+        u64 count = 0;
+        u64 total_ns = 0;
+        u64 max_ns = 0;
+        std::array<u64, NumBuckets> histogram{};
+
+        /// Returns an upper bound of the latency of the given fraction of calls.
+        u64 Percentile(double fraction) const;
+    };
+
+    HLEProfiler();
+    ~HLEProfiler();
+
+    HLEProfiler(const HLEProfiler&) = delete;
+    HLEProfiler& operator=(const HLEProfiler&) = delete;
+
+    bool IsEnabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void SetEnabled(bool enable);
+
+    /// Clears the collected data. Calls recorded at the same time may be partially lost.
+    void Reset();
+
+    /// Records a call to an SVC.
+    void RecordSVC(u32 id, const char* name, Clock::duration time);
+
+    /// Records a call to a service command, using the slot returned by RegisterCommand.
+    void RecordCommand(u32 slot, Clock::duration time);
+
+    /**
+     * Assigns a slot to a service command. Registering the same command again returns the same
+     * slot, so that a service created again on a new session keeps its place.
+     * @returns The slot, or InvalidSlot if all slots are in use.
+     */
+    static u32 RegisterCommand(std::string_view service, u32 command_id, const char* name);
+
+    /// Returns the SVCs and then the commands that were called, each sorted by total time.
+    std::vector<CallStats> GetStats() const;
+
+    /// Formats the collected data. The JSON form has "svcs" and "commands" lists; the CSV form
+    /// has one row per call site. Histograms list [lower bound in ns, count] for used buckets.
+    std::string Dump(Format format) const;
+
+    static std::size_t BucketIndex(u64 ns);
+    static u64 BucketLowerBound(std::size_t index);
+
+private:
+    struct Counter;
+    struct CommandChunk;
+    struct Shard;
+
+    Shard& GetShard();
+    static void Record(Counter& counter, Clock::duration time);
+
+    const u64 instance_id;
+    std::atomic<bool> enabled{false};
+    std::array<std::atomic<const char*>, NumSVCs> svc_names{};
+
+    mutable std::mutex shards_mutex;
+    std::vector<std::unique_ptr<Shard>> shards;
+};
+
+} // namespace Kernel
@@ -47,9 +47,11 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
 
     const bool should_record = kernel.GetIPCRecorder().IsEnabled();
 
-    std::vector<u32> untranslated_cmdbuf;
+    // Keep the untranslated command around on the stack for the IPC debugger, which only gets
+    // heap copies when it is recording.
+    std::array<u32, IPC::COMMAND_BUFFER_LENGTH> untranslated_cmdbuf;
     if (should_record) {
-        untranslated_cmdbuf = std::vector<u32>{cmd_buf.begin(), cmd_buf.begin() + command_size};
+        std::copy_n(cmd_buf.begin(), command_size, untranslated_cmdbuf.begin());
     }
 
     std::size_t i = untranslated_size;
@@ -105,9 +107,6 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
             IPC::StaticBufferDescInfo bufferInfo{descriptor};
             VAddr static_buffer_src_address = cmd_buf[i];
 
-            std::vector<u8> data(bufferInfo.size);
-            memory.ReadBlock(*src_process, static_buffer_src_address, data.data(), data.size());
-
             // Grab the address that the target thread set up to receive the response static buffer
             // and write our data there. The static buffers area is located right after the command
             // buffer area.
@@ -127,10 +126,12 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
 
             // Note: The real kernel doesn't seem to have any error recovery mechanisms for this
             // case.
-            ASSERT_MSG(target_buffer.descriptor.size >= data.size(),
+            ASSERT_MSG(target_buffer.descriptor.size >= bufferInfo.size,
                        "Static buffer data is too big");
 
-            memory.WriteBlock(*dst_process, target_buffer.address, data.data(), data.size());
+            // Copy the data between the address spaces directly, page by page.
+            memory.CopyBlock(*dst_process, *src_process, target_buffer.address,
+                             static_buffer_src_address, bufferInfo.size);
 
             cmd_buf[i++] = target_buffer.address;
             break;
@@ -242,13 +243,15 @@ Result TranslateCommandBuffer(Kernel::KernelSystem& kernel, Memory::MemorySystem
     }
 
     if (should_record) {
-        std::vector<u32> translated_cmdbuf{cmd_buf.begin(), cmd_buf.begin() + command_size};
+        std::vector<u32> untranslated{untranslated_cmdbuf.begin(),
+                                      untranslated_cmdbuf.begin() + command_size};
+        std::vector<u32> translated{cmd_buf.begin(), cmd_buf.begin() + command_size};
         if (reply) {
-            kernel.GetIPCRecorder().SetReplyInfo(dst_thread, std::move(untranslated_cmdbuf),
-                                                 std::move(translated_cmdbuf));
+            kernel.GetIPCRecorder().SetReplyInfo(dst_thread, std::move(untranslated),
+                                                 std::move(translated));
         } else {
-            kernel.GetIPCRecorder().SetRequestInfo(src_thread, std::move(untranslated_cmdbuf),
-                                                   std::move(translated_cmdbuf), dst_thread);
+            kernel.GetIPCRecorder().SetRequestInfo(src_thread, std::move(untranslated),
+                                                   std::move(translated), dst_thread);
         }
     }
 
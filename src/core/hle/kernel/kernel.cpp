@@ -8,9 +8,11 @@
 #include <boost/serialization/vector.hpp>
 #include "common/archives.h"
 #include "common/serialization/atomic.h"
+#include "core/hle/kernel/async_executor.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/config_mem.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_profiler.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/kernel.h"
 #include "core/hle/kernel/memory.h"
@@ -42,6 +44,8 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
     }
     timer_manager = std::make_unique<TimerManager>(timing);
     ipc_recorder = std::make_unique<IPCDebugger::Recorder>();
+    async_executor = std::make_unique<AsyncExecutor>();
+    hle_profiler = std::make_unique<HLEProfiler>();
     stored_processes.assign(num_cores, nullptr);
 
     next_thread_id = 1;
@@ -49,6 +53,8 @@ KernelSystem::KernelSystem(Memory::MemorySystem& memory, Core::Timing& timing,
 
 /// Shutdown the kernel
 KernelSystem::~KernelSystem() {
+    // Async requests may still wake threads, so they have to finish first.
+    async_executor->Shutdown();
     ResetThreadIDs();
 };
 
@@ -64,7 +70,7 @@ u32 KernelSystem::GenerateObjectID() {
     return next_object_id++;
 }
 
-std::shared_ptr<Process> KernelSystem::GetCurrentProcess() const {
+const std::shared_ptr<Process>& KernelSystem::GetCurrentProcess() const {
     return current_process;
 }
 
@@ -152,6 +158,18 @@ const IPCDebugger::Recorder& KernelSystem::GetIPCRecorder() const {
     return *ipc_recorder;
 }
 
+AsyncExecutor& KernelSystem::GetAsyncExecutor() {
+    return *async_executor;
+}
+
+HLEProfiler& KernelSystem::GetHLEProfiler() {
+    return *hle_profiler;
+}
+
+const HLEProfiler& KernelSystem::GetHLEProfiler() const {
+    return *hle_profiler;
+}
+
 void KernelSystem::AddNamedPort(std::string name, std::shared_ptr<ClientPort> port) {
     named_ports.emplace(std::move(name), std::move(port));
 }
@@ -44,6 +44,8 @@ class Recorder;
 namespace Kernel {
 
 class AddressArbiter;
+class AsyncExecutor;
+class HLEProfiler;
 class Event;
 class Mutex;
 class CodeSet;
@@ -271,7 +273,7 @@ public:
         return process_list;
     }
 
-    std::shared_ptr<Process> GetCurrentProcess() const;
+    const std::shared_ptr<Process>& GetCurrentProcess() const;
     void SetCurrentProcess(std::shared_ptr<Process> process);
     void SetCurrentProcessForCPU(std::shared_ptr<Process> process, u32 core_id);
 
@@ -300,6 +302,12 @@ public:
     IPCDebugger::Recorder& GetIPCRecorder();
     const IPCDebugger::Recorder& GetIPCRecorder() const;
 
+    /// Returns the executor that runs the async sections of HLE service requests.
+    AsyncExecutor& GetAsyncExecutor();
+
+    HLEProfiler& GetHLEProfiler();
+    const HLEProfiler& GetHLEProfiler() const;
+
     std::shared_ptr<MemoryRegionInfo> GetMemoryRegion(MemoryRegion region);
 
     void HandleSpecialMapping(VMManager& address_space, const AddressMapping& mapping);
@@ -381,6 +389,10 @@ private:
 
     std::unique_ptr<IPCDebugger::Recorder> ipc_recorder;
 
+    std::unique_ptr<AsyncExecutor> async_executor;
+
+    std::unique_ptr<HLEProfiler> hle_profiler;
+
     u32 next_thread_id;
 
     MemoryMode memory_mode;
@@ -89,7 +89,20 @@ std::shared_ptr<T> SharedFrom(T* raw) {
 template <typename T>
 inline std::shared_ptr<T> DynamicObjectCast(std::shared_ptr<Object> object) {
     if (object != nullptr && object->GetHandleType() == T::HANDLE_TYPE) {
-        return std::static_pointer_cast<T>(object);
+        return std::static_pointer_cast<T>(std::move(object));
+    }
+    return nullptr;
+}
+
+/**
+ * Attempts to downcast the given Object pointer to a pointer to T, without touching reference
+ * counts.
+ * @return Derived pointer to the object, or `nullptr` if `object` isn't of type T.
+ */
+template <typename T>
+inline T* DynamicObjectCast(Object* object) {
+    if (object != nullptr && object->GetHandleType() == T::HANDLE_TYPE) {
+        return static_cast<T*>(object);
     }
     return nullptr;
 }
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <array>
 #include <chrono>
+#include <boost/container/small_vector.hpp>
 #include <fmt/format.h>
 #include "common/archives.h"
 #include "common/logging/log.h"
@@ -23,6 +24,7 @@
 #include "core/hle/kernel/errors.h"
 #include "core/hle/kernel/event.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_profiler.h"
 #include "core/hle/kernel/ipc.h"
 #include "core/hle/kernel/ipc_debugger/recorder.h"
 #include "core/hle/kernel/memory.h"
@@ -764,7 +766,7 @@ private:
 
 /// Wait for a handle to synchronize, timeout after the specified nanoseconds
 Result SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
-    auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
+    WaitObject* object = kernel.GetCurrentProcess()->handle_table.Borrow<WaitObject>(handle);
     Thread* thread = kernel.GetCurrentThreadManager().GetCurrentThread();
     R_UNLESS(object, ResultInvalidHandle);
 
@@ -774,7 +776,7 @@ Result SVC::WaitSynchronization1(Handle handle, s64 nano_seconds) {
     if (object->ShouldWait(thread)) {
         R_UNLESS(nano_seconds != 0, ResultTimeout);
 
-        thread->wait_objects = {object};
+        thread->wait_objects = {SharedFrom(object)};
         object->AddWaitingThread(SharedFrom(thread));
         thread->status = ThreadStatus::WaitSynchAny;
 
@@ -809,20 +811,30 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
     // Check if 'handle_count' is invalid
     R_UNLESS(handle_count >= 0, ResultOutOfRange);
 
-    using ObjectPtr = std::shared_ptr<WaitObject>;
-    std::vector<ObjectPtr> objects(handle_count);
+    // The objects are borrowed from the handle table, and only referenced when the thread has to
+    // wait for them.
+    boost::container::small_vector<WaitObject*, 16> objects(handle_count);
+    const HandleTable& handle_table = kernel.GetCurrentProcess()->handle_table;
 
     for (int i = 0; i < handle_count; ++i) {
         Handle handle = memory.Read32(handles_address + i * sizeof(Handle));
-        auto object = kernel.GetCurrentProcess()->handle_table.Get<WaitObject>(handle);
-        R_UNLESS(object, ResultInvalidHandle);
-        objects[i] = object;
+        objects[i] = handle_table.Borrow<WaitObject>(handle);
+        R_UNLESS(objects[i], ResultInvalidHandle);
     }
 
+    const auto shared_objects = [&objects] {
+        std::vector<std::shared_ptr<WaitObject>> result;
+        result.reserve(objects.size());
+        for (WaitObject* object : objects) {
+            result.push_back(SharedFrom(object));
+        }
+        return result;
+    };
+
     if (wait_all) {
         bool all_available =
             std::all_of(objects.begin(), objects.end(),
-                        [thread](const ObjectPtr& object) { return !object->ShouldWait(thread); });
+                        [thread](WaitObject* object) { return !object->ShouldWait(thread); });
         if (all_available) {
             // We can acquire all objects right now, do so.
             for (auto& object : objects)
@@ -842,11 +854,11 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
         thread->status = ThreadStatus::WaitSynchAll;
 
         // Add the thread to each of the objects' waiting threads.
-        for (auto& object : objects) {
+        for (WaitObject* object : objects) {
             object->AddWaitingThread(SharedFrom(thread));
         }
 
-        thread->wait_objects = std::move(objects);
+        thread->wait_objects = shared_objects();
 
         // Create an event to wake the thread up after the specified nanosecond delay has passed
         thread->WakeAfterDelay(nano_seconds);
@@ -862,13 +874,13 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
         return ResultTimeout;
     } else {
         // Find the first object that is acquirable in the provided list of objects
-        auto itr = std::find_if(objects.begin(), objects.end(), [thread](const ObjectPtr& object) {
+        auto itr = std::find_if(objects.begin(), objects.end(), [thread](WaitObject* object) {
             return !object->ShouldWait(thread);
         });
 
         if (itr != objects.end()) {
             // We found a ready object, acquire it and set the result value
-            WaitObject* object = itr->get();
+            WaitObject* object = *itr;
             object->Acquire(thread);
             *out = static_cast<s32>(std::distance(objects.begin(), itr));
             return ResultSuccess;
@@ -884,12 +896,11 @@ Result SVC::WaitSynchronizationN(s32* out, VAddr handles_address, s32 handle_cou
         thread->status = ThreadStatus::WaitSynchAny;
 
         // Add the thread to each of the objects' waiting threads.
-        for (std::size_t i = 0; i < objects.size(); ++i) {
-            WaitObject* object = objects[i].get();
+        for (WaitObject* object : objects) {
             object->AddWaitingThread(SharedFrom(thread));
         }
 
-        thread->wait_objects = std::move(objects);
+        thread->wait_objects = shared_objects();
 
         // Note: If no handles and no timeout were given, then the thread will deadlock, this is
         // consistent with hardware behavior.
@@ -1304,8 +1315,7 @@ void SVC::ExitThread() {
 
 /// Gets the priority for the specified thread
 Result SVC::GetThreadPriority(u32* priority, Handle handle) {
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     R_UNLESS(thread, ResultInvalidHandle);
 
     *priority = thread->GetPriority();
@@ -1316,7 +1326,7 @@ Result SVC::GetThreadPriority(u32* priority, Handle handle) {
 Result SVC::SetThreadPriority(Handle handle, u32 priority) {
     R_UNLESS(priority <= ThreadPrioLowest, ResultOutOfRange);
 
-    const auto thread = kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     R_UNLESS(thread, ResultInvalidHandle);
 
     // Note: The kernel uses the current process's resource limit instead of
@@ -1368,8 +1378,8 @@ Result SVC::ReleaseMutex(Handle handle) {
 Result SVC::GetProcessId(u32* process_id, Handle process_handle) {
     LOG_TRACE(Kernel_SVC, "called process=0x{:08X}", process_handle);
 
-    const std::shared_ptr<Process> process =
-        kernel.GetCurrentProcess()->handle_table.Get<Process>(process_handle);
+    const Process* process =
+        kernel.GetCurrentProcess()->handle_table.Borrow<Process>(process_handle);
     R_UNLESS(process, ResultInvalidHandle);
 
     *process_id = process->process_id;
@@ -1380,8 +1390,7 @@ Result SVC::GetProcessId(u32* process_id, Handle process_handle) {
 Result SVC::GetProcessIdOfThread(u32* process_id, Handle thread_handle) {
     LOG_TRACE(Kernel_SVC, "called thread=0x{:08X}", thread_handle);
 
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(thread_handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(thread_handle);
     R_UNLESS(thread, ResultInvalidHandle);
 
     const std::shared_ptr<Process> process = thread->owner_process.lock();
@@ -1395,8 +1404,7 @@ Result SVC::GetProcessIdOfThread(u32* process_id, Handle thread_handle) {
 Result SVC::GetThreadId(u32* thread_id, Handle handle) {
     LOG_TRACE(Kernel_SVC, "called thread=0x{:08X}", handle);
 
-    const std::shared_ptr<Thread> thread =
-        kernel.GetCurrentProcess()->handle_table.Get<Thread>(handle);
+    const Thread* thread = kernel.GetCurrentProcess()->handle_table.Borrow<Thread>(handle);
     R_UNLESS(thread, ResultInvalidHandle);
 
     *thread_id = thread->GetThreadId();
@@ -1532,7 +1540,7 @@ Result SVC::SignalEvent(Handle handle) {
 Result SVC::ClearEvent(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called event=0x{:08X}", handle);
 
-    std::shared_ptr<Event> evt = kernel.GetCurrentProcess()->handle_table.Get<Event>(handle);
+    Event* evt = kernel.GetCurrentProcess()->handle_table.Borrow<Event>(handle);
     R_UNLESS(evt, ResultInvalidHandle);
 
     evt->Clear();
@@ -1560,7 +1568,7 @@ Result SVC::CreateTimer(Handle* out_handle, u32 reset_type) {
 Result SVC::ClearTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.Borrow<Timer>(handle);
     R_UNLESS(timer, ResultInvalidHandle);
 
     timer->Clear();
@@ -1585,7 +1593,7 @@ Result SVC::SetTimer(Handle handle, s64 initial, s64 interval) {
 Result SVC::CancelTimer(Handle handle) {
     LOG_TRACE(Kernel_SVC, "called timer=0x{:08X}", handle);
 
-    std::shared_ptr<Timer> timer = kernel.GetCurrentProcess()->handle_table.Get<Timer>(handle);
+    Timer* timer = kernel.GetCurrentProcess()->handle_table.Borrow<Timer>(handle);
     R_UNLESS(timer, ResultInvalidHandle);
 
     timer->Cancel();
@@ -2105,7 +2113,7 @@ Result SVC::ControlProcess(Handle process_handle, u32 process_OP, u32 varg2, u32
         for (auto it = process->vm_manager.vma_map.cbegin();
              it != process->vm_manager.vma_map.cend(); it++) {
             if (it->second.meminfo_state != MemoryState::Free)
-                process->vm_manager.Reprotect(it, Kernel::VMAPermission::ReadWriteExecute);
+                it = process->vm_manager.Reprotect(it, Kernel::VMAPermission::ReadWriteExecute);
         }
         return ResultSuccess;
     }
@@ -2359,7 +2367,14 @@ void SVC::CallSVC(u32 immediate) {
     LOG_TRACE(Kernel_SVC, "calling {}", info->name);
     if (info) {
         if (info->func) {
-            (this->*(info->func))();
+            auto& profiler = kernel.GetHLEProfiler();
+            if (profiler.IsEnabled()) {
+                const auto start = HLEProfiler::Clock::now();
+                (this->*(info->func))();
+                profiler.RecordSVC(immediate, info->name, HLEProfiler::Clock::now() - start);
+            } else {
+                (this->*(info->func))();
+            }
         } else {
             LOG_ERROR(Kernel_SVC, "unimplemented SVC function {}(..)", info->name);
         }
@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <map>
 #include <boost/serialization/map.hpp>
 #include <boost/serialization/shared_ptr.hpp>
 #include <boost/serialization/split_member.hpp>
@@ -20,6 +21,9 @@ SERIALIZE_EXPORT_IMPL(Kernel::VirtualMemoryArea)
 
 namespace Kernel {
 
+/// Number of areas room is reserved for up front. Address spaces rarely have more.
+constexpr std::size_t ReservedVMACount = 256;
+
 static const char* GetMemoryStateName(MemoryState state) {
     static const char* names[] = {
         "Free",   "Reserved",   "IO",      "Static", "Code",      "Private",
@@ -53,6 +57,93 @@ void VirtualMemoryArea::serialize(Archive& ar, const unsigned int) {
 }
 SERIALIZE_IMPL(VirtualMemoryArea)
 
+void VMAMap::clear() {
+    // Release the backing memory held by the areas
+    std::fill(storage.begin(), storage.end(), value_type{});
+    gap_begin = 0;
+    gap_end = storage.size();
+}
+
+void VMAMap::reserve(size_type capacity) {
+    if (capacity > storage.size()) {
+        Grow(capacity);
+    }
+}
+
+VMAMap::size_type VMAMap::LowerBound(VAddr key) const {
+    const auto before = [](const value_type& value, VAddr key) { return value.first < key; };
+    // Areas after the gap are only searched when all areas before it are smaller than the key.
+    if (gap_end != storage.size() && storage[gap_end].first < key) {
+        const auto it = std::lower_bound(storage.begin() + gap_end, storage.end(), key, before);
+        return gap_begin + static_cast<size_type>(it - (storage.begin() + gap_end));
+    }
+    const auto it = std::lower_bound(storage.begin(), storage.begin() + gap_begin, key, before);
+    return static_cast<size_type>(it - storage.begin());
+}
+
+VMAMap::size_type VMAMap::UpperBound(VAddr key) const {
+    const auto after = [](VAddr key, const value_type& value) { return key < value.first; };
+    if (gap_end != storage.size() && storage[gap_end].first <= key) {
+        const auto it = std::upper_bound(storage.begin() + gap_end, storage.end(), key, after);
+        return gap_begin + static_cast<size_type>(it - (storage.begin() + gap_end));
+    }
+    const auto it = std::upper_bound(storage.begin(), storage.begin() + gap_begin, key, after);
+    return static_cast<size_type>(it - storage.begin());
+}
+
+VMAMap::iterator VMAMap::insert(const_iterator position, VirtualMemoryArea vma) {
+    const size_type index = position.index;
+    DEBUG_ASSERT(index == 0 || At(index - 1).first < vma.base);
+    DEBUG_ASSERT(index == size() || vma.base < At(index).first);
+
+    if (gap_begin == gap_end) {
+        Grow(std::max<size_type>(storage.size() * 2, ReservedVMACount));
+    }
+    MoveGap(index);
+
+    const VAddr base = vma.base;
+    storage[gap_begin] = {base, std::move(vma)};
+    ++gap_begin;
+    return {this, index};
+}
+
+VMAMap::iterator VMAMap::erase(const_iterator first, const_iterator last) {
+    const size_type index = first.index;
+    const size_type count = last.index - first.index;
+    if (count == 0) {
+        return {this, index};
+    }
+
+    MoveGap(index);
+    std::fill(storage.begin() + gap_end, storage.begin() + gap_end + count, value_type{});
+    gap_end += count;
+    return {this, index};
+}
+
+void VMAMap::MoveGap(size_type position) {
+    if (position < gap_begin) {
+        std::move_backward(storage.begin() + position, storage.begin() + gap_begin,
+                           storage.begin() + gap_end);
+        gap_end -= gap_begin - position;
+        gap_begin = position;
+    } else if (position > gap_begin) {
+        const size_type count = position - gap_begin;
+        std::move(storage.begin() + gap_end, storage.begin() + gap_end + count,
+                  storage.begin() + gap_begin);
+        gap_begin += count;
+        gap_end += count;
+    }
+}
+
+void VMAMap::Grow(size_type capacity) {
+    const size_type after_gap = storage.size() - gap_end;
+    std::vector<value_type> new_storage(capacity);
+    std::move(storage.begin(), storage.begin() + gap_begin, new_storage.begin());
+    std::move(storage.begin() + gap_end, storage.end(), new_storage.end() - after_gap);
+    storage = std::move(new_storage);
+    gap_end = capacity - after_gap;
+}
+
 VMManager::VMManager(Memory::MemorySystem& memory, Kernel::Process& proc)
     : page_table(std::make_shared<Memory::PageTable>()), memory(memory), process(proc) {
     Reset();
@@ -64,11 +155,12 @@ void VMManager::Reset() {
     ASSERT(!is_locked);
 
     vma_map.clear();
+    vma_map.reserve(ReservedVMACount);
 
     // Initialize the map with a single free region covering the entire managed space.
     VirtualMemoryArea initial_vma;
     initial_vma.size = MAX_ADDRESS;
-    vma_map.emplace(initial_vma.base, initial_vma);
+    vma_map.insert(vma_map.end(), initial_vma);
 
     page_table->Clear();
 
@@ -96,11 +188,15 @@ ResultVal<VAddr> VMManager::MapBackingMemoryToBase(VAddr base, u32 region_size,
         return vma_end > base && vma_end >= base + size;
     });
 
-    VAddr target = std::max(base, vma_handle->second.base);
-
     // Do not try to allocate the block if there are no available addresses within the desired
     // region.
-    if (vma_handle == vma_map.end() || target + size > base + region_size) {
+    if (vma_handle == vma_map.end()) {
+        return Result(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
+                      ErrorSummary::OutOfResource, ErrorLevel::Permanent);
+    }
+
+    VAddr target = std::max(base, vma_handle->second.base);
+    if (target + size > base + region_size) {
         return Result(ErrorDescription::OutOfMemory, ErrorModule::Kernel,
                       ErrorSummary::OutOfResource, ErrorLevel::Permanent);
     }
@@ -159,10 +255,9 @@ Result VMManager::ChangeMemoryState(VAddr target, u32 size, MemoryState expected
 
     CASCADE_RESULT(auto vma, CarveVMARange(target, size));
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma->second.permissions = new_perms;
         vma->second.meminfo_state = new_state;
         UpdatePageTableForVMA(vma->second);
@@ -192,10 +287,9 @@ Result VMManager::UnmapRange(VAddr target, u32 size) {
     CASCADE_RESULT(VMAIter vma, CarveVMARange(target, size));
     const VAddr target_end = target + size;
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma = std::next(Unmap(vma));
     }
 
@@ -221,10 +315,9 @@ Result VMManager::ReprotectRange(VAddr target, u32 size, VMAPermission new_perms
     CASCADE_RESULT(VMAIter vma, CarveVMARange(target, size));
     const VAddr target_end = target + size;
 
-    const VMAIter end = vma_map.end();
     // The comparison against the end of the range must be done using addresses since VMAs can be
     // merged during this process, causing invalidation of the iterators.
-    while (vma != end && vma->second.base < target_end) {
+    while (vma != vma_map.end() && vma->second.base < target_end) {
         vma = std::next(StripIterConstness(Reprotect(vma, new_perms)));
     }
 
@@ -341,7 +434,7 @@ VMManager::VMAIter VMManager::SplitVMA(VMAIter vma_handle, u32 offset_in_vma) {
 
     ASSERT(old_vma.CanBeMergedWith(new_vma));
 
-    return vma_map.emplace_hint(std::next(vma_handle), new_vma.base, new_vma);
+    return vma_map.insert(std::next(vma_handle), std::move(new_vma));
 }
 
 VMManager::VMAIter VMManager::MergeAdjacent(VMAIter iter) {
@@ -401,7 +494,19 @@ ResultVal<std::vector<std::pair<MemoryRef, u32>>> VMManager::GetBackingBlocksFor
 
 template <class Archive>
 void VMManager::serialize(Archive& ar, const unsigned int) {
-    ar & vma_map;
+    // Savestates store the areas as a std::map, which is what VMManager used to keep them in.
+    std::map<VAddr, VirtualMemoryArea> areas;
+    if (Archive::is_saving::value) {
+        areas.insert(vma_map.begin(), vma_map.end());
+    }
+    ar & areas;
+    if (Archive::is_loading::value) {
+        vma_map.clear();
+        vma_map.reserve(areas.size());
+        for (auto& [base, vma] : areas) {
+            vma_map.insert(vma_map.end(), std::move(vma));
+        }
+    }
     ar & page_table;
     if (Archive::is_loading::value) {
         is_locked = true;
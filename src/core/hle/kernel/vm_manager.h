@@ -5,8 +5,11 @@
 
 #pragma once
 
-#include <map>
+#include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <boost/serialization/export.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
@@ -81,6 +84,185 @@ private:
     void serialize(Archive& ar, const unsigned int);
 };
 
+/**
+ * Map of VMAs keyed by their base address. The areas are kept sorted in a single vector that has
+ * a gap in it: insertions and removals happen at the gap, which is first moved to the modified
+ * position, so a run of nearby modifications, like mapping or unmapping a sequence of regions,
+ * only moves a few areas each. Lookups are binary searches over contiguous memory, and since the
+ * storage never shrinks, splitting and merging areas normally does not allocate.
+ *
+ * Iterators refer to a position in the map rather than to an area. They stay valid when areas
+ * are inserted or removed after them, while iterators past the modified position then refer to
+ * other areas.
+ */
+class VMAMap {
+public:
+    using key_type = VAddr;
+    using mapped_type = VirtualMemoryArea;
+    using value_type = std::pair<VAddr, VirtualMemoryArea>;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+
+    template <bool IsConst>
+    class Iterator {
+        using Map = std::conditional_t<IsConst, const VMAMap, VMAMap>;
+
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = VMAMap::value_type;
+        using difference_type = VMAMap::difference_type;
+        using pointer = std::conditional_t<IsConst, const value_type*, value_type*>;
+        using reference = std::conditional_t<IsConst, const value_type&, value_type&>;
+
+        Iterator() = default;
+
+        template <bool OtherConst>
+            requires(IsConst && !OtherConst)
+        Iterator(const Iterator<OtherConst>& other) : map{other.map}, index{other.index} {}
+
+        reference operator*() const {
+            return map->At(index);
+        }
+
+        pointer operator->() const {
+            return &map->At(index);
+        }
+
+        Iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++index;
+            return old;
+        }
+
+        Iterator& operator--() {
+            --index;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator old = *this;
+            --index;
+            return old;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.index == b.index;
+        }
+
+    private:
+        friend class VMAMap;
+        template <bool>
+        friend class Iterator;
+
+        Iterator(Map* map_, size_type index_) : map{map_}, index{index_} {}
+
+        Map* map = nullptr;
+        size_type index = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    iterator begin() {
+        return {this, 0};
+    }
+    const_iterator begin() const {
+        return {this, 0};
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+
+    iterator end() {
+        return {this, size()};
+    }
+    const_iterator end() const {
+        return {this, size()};
+    }
+    const_iterator cend() const {
+        return end();
+    }
+
+    const_reverse_iterator crbegin() const {
+        return const_reverse_iterator{cend()};
+    }
+    const_reverse_iterator crend() const {
+        return const_reverse_iterator{cbegin()};
+    }
+
+    size_type size() const {
+        return storage.size() - (gap_end - gap_begin);
+    }
+
+    bool empty() const {
+        return size() == 0;
+    }
+
+    /// Removes all areas, keeping the storage.
+    void clear();
+
+    /// Makes room for at least `capacity` areas.
+    void reserve(size_type capacity);
+
+    /// Returns the first area whose base is not less than `key`.
+    iterator lower_bound(VAddr key) {
+        return {this, LowerBound(key)};
+    }
+    const_iterator lower_bound(VAddr key) const {
+        return {this, LowerBound(key)};
+    }
+
+    /// Returns the first area whose base is greater than `key`.
+    iterator upper_bound(VAddr key) {
+        return {this, UpperBound(key)};
+    }
+    const_iterator upper_bound(VAddr key) const {
+        return {this, UpperBound(key)};
+    }
+
+    /**
+     * Inserts an area, keyed by its base, before `position`, which must keep the map sorted.
+     * @returns The inserted area.
+     */
+    iterator insert(const_iterator position, VirtualMemoryArea vma);
+
+    /// Removes an area. @returns The area that followed it.
+    iterator erase(const_iterator position) {
+        return erase(position, std::next(position));
+    }
+
+    /// Removes a range of areas. @returns The area that followed them.
+    iterator erase(const_iterator first, const_iterator last);
+
+private:
+    value_type& At(size_type index) {
+        return storage[index < gap_begin ? index : index + (gap_end - gap_begin)];
+    }
+    const value_type& At(size_type index) const {
+        return storage[index < gap_begin ? index : index + (gap_end - gap_begin)];
+    }
+
+    size_type LowerBound(VAddr key) const;
+    size_type UpperBound(VAddr key) const;
+
+    /// Moves the gap so that it starts at the given position.
+    void MoveGap(size_type position);
+
+    /// Reallocates the storage with room for `capacity` areas.
+    void Grow(size_type capacity);
+
+    /// Areas before the gap, the gap, then areas after the gap. Slots in the gap hold empty areas.
+    std::vector<value_type> storage;
+    size_type gap_begin = 0;
+    size_type gap_end = 0;
+};
+
 /**
  * Manages a process' virtual addressing space. This class maintains a list of allocated and free
  * regions in the address space, along with their attributes, and allows kernel clients to
@@ -109,8 +291,8 @@ public:
      * merged when possible so that no two similar and adjacent regions exist that have not been
      * merged.
      */
-    std::map<VAddr, VirtualMemoryArea> vma_map;
-    using VMAHandle = decltype(vma_map)::const_iterator;
+    VMAMap vma_map;
+    using VMAHandle = VMAMap::const_iterator;
 
     explicit VMManager(Memory::MemorySystem& memory, Kernel::Process& proc);
     ~VMManager();
@@ -187,7 +369,7 @@ public:
     void Unlock();
 
 private:
-    using VMAIter = decltype(vma_map)::iterator;
+    using VMAIter = VMAMap::iterator;
 
     /// Converts a VMAHandle to a mutable VMAIter.
     VMAIter StripIterConstness(const VMAHandle& iter);
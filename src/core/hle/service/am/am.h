@@ -243,6 +243,10 @@ public:
         Interface(std::shared_ptr<Module> am, const char* name, u32 max_session);
         ~Interface();
 
+        Kernel::AsyncQueue GetAsyncQueue() const override {
+            return Kernel::AsyncQueue::Install;
+        }
+
         std::shared_ptr<Module> GetModule() const {
             return am;
         }
@@ -44,6 +44,10 @@ public:
          const FileSys::Path& path);
     ~File() = default;
 
+    Kernel::AsyncQueue GetAsyncQueue() const override {
+        return Kernel::AsyncQueue::FileSystem;
+    }
+
     std::string GetName() const {
         return "Path: " + path.DebugStr();
     }
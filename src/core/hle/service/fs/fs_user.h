@@ -51,6 +51,10 @@ class FS_USER final : public ServiceFramework<FS_USER, ClientSlot> {
 public:
     explicit FS_USER(Core::System& system);
 
+    Kernel::AsyncQueue GetAsyncQueue() const override {
+        return Kernel::AsyncQueue::FileSystem;
+    }
+
     // On real HW this is part of FSReg (FSReg:Register). But since that module is only used by
     // loader and pm, which we HLEed, we can just directly use it here
     void RegisterProgramInfo(u32 process_id, u64 program_id, const std::string& filepath);
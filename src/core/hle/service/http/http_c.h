@@ -339,6 +339,10 @@ class HTTP_C final : public ServiceFramework<HTTP_C, SessionData> {
 public:
     HTTP_C();
 
+    Kernel::AsyncQueue GetAsyncQueue() const override {
+        return Kernel::AsyncQueue::Http;
+    }
+
     const ClCertAData& GetClCertA() const {
         return ClCertA;
     }
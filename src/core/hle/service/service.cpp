@@ -11,6 +11,7 @@
 #include "core/hle/ipc.h"
 #include "core/hle/kernel/client_port.h"
 #include "core/hle/kernel/handle_table.h"
+#include "core/hle/kernel/hle_profiler.h"
 #include "core/hle/kernel/process.h"
 #include "core/hle/kernel/server_port.h"
 #include "core/hle/kernel/server_session.h"
@@ -147,7 +148,10 @@ void ServiceFrameworkBase::RegisterHandlersBase(const FunctionInfoBase* function
     handlers.reserve(handlers.size() + n);
     for (std::size_t i = 0; i < n; ++i) {
         // Usually this array is sorted by id already, so hint to insert at the end
-        handlers.emplace_hint(handlers.cend(), functions[i].command_id, functions[i]);
+        const auto it =
+            handlers.emplace_hint(handlers.cend(), functions[i].command_id, functions[i]);
+        it->second.profiler_slot = Kernel::HLEProfiler::RegisterCommand(
+            service_name, functions[i].command_id, functions[i].name);
     }
 }
 
@@ -184,7 +188,16 @@ void ServiceFrameworkBase::HandleSyncRequest(Kernel::HLERequestContext& context)
 
     LOG_TRACE(Service, "{}",
               MakeFunctionString(info->name, GetServiceName(), context.CommandBuffer()));
-    handler_invoker(this, info->handler_callback, context);
+
+    auto& profiler = context.GetKernel().GetHLEProfiler();
+    if (profiler.IsEnabled()) {
+        const auto start = Kernel::HLEProfiler::Clock::now();
+        handler_invoker(this, info->handler_callback, context);
+        profiler.RecordCommand(info->profiler_slot,
+                               Kernel::HLEProfiler::Clock::now() - start);
+    } else {
+        handler_invoker(this, info->handler_callback, context);
+    }
 }
 
 std::string ServiceFrameworkBase::GetFunctionName(IPC::Header header) const {
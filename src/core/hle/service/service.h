@@ -84,6 +84,8 @@ private:
         u32 command_id;
         HandlerFnP<ServiceFrameworkBase> handler_callback;
         const char* name;
+        /// Where the HLE profiler records calls to this function, assigned on registration.
+        u32 profiler_slot = 0;
     };
 
     using InvokerFn = void(ServiceFrameworkBase* object, HandlerFnP<ServiceFrameworkBase> member,
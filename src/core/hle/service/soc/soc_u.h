@@ -53,6 +53,10 @@ public:
     SOC_U();
     ~SOC_U();
 
+    Kernel::AsyncQueue GetAsyncQueue() const override {
+        return Kernel::AsyncQueue::Socket;
+    }
+
     struct InterfaceInfo {
         u32 address;
         u32 netmask;
@@ -554,14 +554,37 @@ ResultStatus Apploader_Artic::ReadExtdataId(u64& out_extdata_id) {
     return Loader::ResultStatus::Success;
 }
 
+void Apploader_Artic::EnableRomFSDiskCache(FileSys::ArticRomFSReader& romfs_reader) {
+    const std::size_t capacity = Settings::values.artic_disk_cache_size.GetValue() * 1_MiB;
+    u64 program_id;
+    Service::FS::FS_USER::ProductInfo product_info;
+    if (capacity == 0 || ReadProgramId(program_id) != ResultStatus::Success ||
+        LoadProductInfo(product_info) != ResultStatus::Success) {
+        return;
+    }
+    if (!romfs_reader.EnableDiskCache(program_id, product_info.remaster_version, capacity)) {
+        LOG_WARNING(Loader, "Could not enable the Artic disk cache");
+    }
+}
+
 ResultStatus Apploader_Artic::ReadRomFS(std::shared_ptr<FileSys::RomFSReader>& romfs_file) {
-    main_romfs_reader = romfs_file = std::make_shared<FileSys::ArticRomFSReader>(client, false);
-    return static_cast<FileSys::ArticRomFSReader*>(romfs_file.get())->OpenStatus();
+    auto romfs_reader = std::make_shared<FileSys::ArticRomFSReader>(client, false);
+    main_romfs_reader = romfs_file = romfs_reader;
+    const ResultStatus status = romfs_reader->OpenStatus();
+    if (status == ResultStatus::Success) {
+        EnableRomFSDiskCache(*romfs_reader);
+    }
+    return status;
 }
 
 ResultStatus Apploader_Artic::ReadUpdateRomFS(std::shared_ptr<FileSys::RomFSReader>& romfs_file) {
-    update_romfs_reader = romfs_file = std::make_shared<FileSys::ArticRomFSReader>(client, true);
-    return static_cast<FileSys::ArticRomFSReader*>(romfs_file.get())->OpenStatus();
+    auto romfs_reader = std::make_shared<FileSys::ArticRomFSReader>(client, true);
+    update_romfs_reader = romfs_file = romfs_reader;
+    const ResultStatus status = romfs_reader->OpenStatus();
+    if (status == ResultStatus::Success) {
+        EnableRomFSDiskCache(*romfs_reader);
+    }
+    return status;
 }
 
 ResultStatus Apploader_Artic::DumpRomFS(const std::string& target_path) {
@@ -115,6 +115,9 @@ private:
 
     ResultStatus LoadProductInfo(Service::FS::FS_USER::ProductInfo& out);
 
+    /// Enables the Artic disk cache for the RomFS reader if it is configured.
+    void EnableRomFSDiskCache(FileSys::ArticRomFSReader& romfs_reader);
+
     ExHeader_Header program_exheader{};
     bool program_exheader_loaded = false;
 
@@ -5,6 +5,8 @@
 
 #include <array>
 #include <cstring>
+#include <limits>
+#include <vector>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/binary_object.hpp>
 #include "audio_core/dsp_interface.h"
@@ -12,6 +14,8 @@
 #include "common/assert.h"
 #include "common/atomic_ops.h"
 #include "common/common_types.h"
+#include "common/hash.h"
+#include "common/host_memory.h"
 #include "common/logging/log.h"
 #include "common/settings.h"
 #include "common/swap.h"
@@ -31,10 +35,18 @@ SERIALIZE_EXPORT_IMPL(Memory::MemorySystem::BackingMemImpl<Memory::Region::N3DS>
 
 namespace Memory {
 
+// The whole 32-bit guest address space, plus a guard page for accesses crossing its end
+constexpr std::size_t FASTMEM_ARENA_SIZE = (std::size_t{1} << 32) + BORKED3DS_PAGE_SIZE;
+
 void PageTable::Clear() {
     pointers.raw.fill(nullptr);
     pointers.refs.fill(MemoryRef());
     attributes.fill(PageType::Unmapped);
+    if (fastmem_base && !fastmem_arena->Unmap(0, FASTMEM_ARENA_SIZE)) {
+        // Accesses the JIT makes to pages still mapped in the arena would bypass the page table
+        LOG_CRITICAL(HW_Memory, "Clearing the fastmem arena failed, disabling it");
+        fastmem_base = nullptr;
+    }
 }
 
 class RasterizerCacheMarker {
@@ -87,11 +99,18 @@ private:
 
 class MemorySystem::Impl {
 public:
-    // Visual Studio would try to allocate these on compile time
-    // if they are std::array which would exceed the memory limit.
-    std::unique_ptr<u8[]> fcram = std::make_unique<u8[]>(Memory::FCRAM_N3DS_SIZE);
-    std::unique_ptr<u8[]> vram = std::make_unique<u8[]>(Memory::VRAM_SIZE);
-    std::unique_ptr<u8[]> n3ds_extra_ram = std::make_unique<u8[]>(Memory::N3DS_EXTRA_RAM_SIZE);
+    // FCRAM, VRAM and the N3DS extra RAM, in this order, live in a single host memory object when
+    // fastmem is enabled, so views of them can be mapped into the fastmem arenas.
+    static constexpr std::size_t FASTMEM_BACKING_SIZE =
+        FCRAM_N3DS_SIZE + VRAM_SIZE + N3DS_EXTRA_RAM_SIZE;
+    std::unique_ptr<Common::HostMemory> host_memory;
+    std::unique_ptr<u8[]> heap_memory;
+    /// Set when updating a fastmem arena failed, after which no page table uses fastmem.
+    bool fastmem_failed = false;
+
+    u8* fcram;
+    u8* vram;
+    u8* n3ds_extra_ram;
 
     Core::System& system;
     std::shared_ptr<PageTable> current_page_table = nullptr;
@@ -105,18 +124,38 @@ public:
     std::shared_ptr<BackingMem> n3ds_extra_ram_mem;
     std::shared_ptr<BackingMem> dsp_mem;
 
+    /// Content hashes of the VRAM and FCRAM pages of the base of incremental savestates.
+    std::vector<u64> base_page_hashes;
+    /// Whether serialization only includes the VRAM and FCRAM pages changed since the base.
+    bool serialize_changed_pages = false;
+
     Impl(Core::System& system_);
 
+    /// Creates the fastmem arena of the page table, if fastmem is enabled.
+    void EnableFastmem(PageTable& page_table);
+
+    /// Returns the offset in the host memory object that the page should map to in the fastmem
+    /// arena, or std::nullopt if accesses to it must go through the memory callbacks.
+    std::optional<std::size_t> GetFastmemOffset(const PageTable& page_table,
+                                                std::size_t page) const;
+
+    /// Mirrors the pointers of the page range into the fastmem arena of the page table.
+    void UpdateFastmem(PageTable& page_table, std::size_t first_page, std::size_t num_pages);
+
+    /// Makes the JITs of the page table and of all registered ones use the page table instead of
+    /// the fastmem arenas, and stops creating arenas for new page tables.
+    void DisableFastmem(PageTable& failed_page_table);
+
     const u8* GetPtr(Region r) const {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -125,13 +164,13 @@ public:
     u8* GetPtr(Region r) {
         switch (r) {
         case Region::VRAM:
-            return vram.get();
+            return vram;
         case Region::DSP:
             return dsp->GetDspMemory().data();
         case Region::FCRAM:
-            return fcram.get();
+            return fcram;
         case Region::N3DS:
-            return n3ds_extra_ram.get();
+            return n3ds_extra_ram;
         default:
             UNREACHABLE();
         }
@@ -282,7 +321,11 @@ public:
                 return;
             }
 
-            auto& renderer = system.GPU().Renderer();
+            // The rasterizer may be in use by the GPU thread, let it finish first.
+            auto& gpu = system.GPU();
+            gpu.WaitIdle();
+
+            auto& renderer = gpu.Renderer();
             VAddr overlap_start = std::max(start, region_start);
             VAddr overlap_end = std::min(end, region_end);
             PAddr physical_start = paddr_region_start + (overlap_start - region_start);
@@ -311,21 +354,74 @@ public:
         }
     }
 
+    static constexpr std::size_t NUM_VRAM_PAGES = VRAM_SIZE / BORKED3DS_PAGE_SIZE;
+
+    void CaptureBasePageHashes() {
+        const std::size_t fcram_size =
+            Settings::values.is_new_3ds.GetValue() ? FCRAM_N3DS_SIZE : FCRAM_SIZE;
+        base_page_hashes.resize(NUM_VRAM_PAGES + fcram_size / BORKED3DS_PAGE_SIZE);
+        for (std::size_t page = 0; page < base_page_hashes.size(); ++page) {
+            const u8* data = page < NUM_VRAM_PAGES
+                                 ? vram + page * BORKED3DS_PAGE_SIZE
+                                 : fcram + (page - NUM_VRAM_PAGES) * BORKED3DS_PAGE_SIZE;
+            base_page_hashes[page] = Common::ComputeHash64(data, BORKED3DS_PAGE_SIZE);
+        }
+    }
+
 private:
+    /**
+     * Serializes only the pages of a memory region whose contents differ from the base. When
+     * loading, the remaining pages keep the contents of the previously loaded base state.
+     * @param first_page index of the first page of the region in base_page_hashes.
+     */
+    template <class Archive>
+    void SerializeChangedPages(Archive& ar, u8* data, std::size_t size, std::size_t first_page) {
+        const std::size_t num_pages = size / BORKED3DS_PAGE_SIZE;
+        std::vector<u32> changed_pages;
+        if (!Archive::is_loading::value) {
+            ASSERT(first_page + num_pages <= base_page_hashes.size());
+            for (std::size_t page = 0; page < num_pages; ++page) {
+                const u64 hash =
+                    Common::ComputeHash64(data + page * BORKED3DS_PAGE_SIZE, BORKED3DS_PAGE_SIZE);
+                if (hash != base_page_hashes[first_page + page]) {
+                    changed_pages.push_back(static_cast<u32>(page));
+                }
+            }
+        }
+        ar & changed_pages;
+        for (const u32 page : changed_pages) {
+            if (page >= num_pages) {
+                throw std::runtime_error("Invalid page in incremental savestate");
+            }
+            ar& boost::serialization::make_binary_object(data + page * BORKED3DS_PAGE_SIZE,
+                                                         BORKED3DS_PAGE_SIZE);
+        }
+    }
+
     friend class boost::serialization::access;
     template <class Archive>
     void serialize(Archive& ar, const unsigned int file_version) {
         bool save_n3ds_ram = Settings::values.is_new_3ds.GetValue();
         ar & save_n3ds_ram;
-        ar& boost::serialization::make_binary_object(vram.get(), Memory::VRAM_SIZE);
-        ar& boost::serialization::make_binary_object(
-            fcram.get(), save_n3ds_ram ? Memory::FCRAM_N3DS_SIZE : Memory::FCRAM_SIZE);
+        const std::size_t fcram_size = save_n3ds_ram ? FCRAM_N3DS_SIZE : FCRAM_SIZE;
+        if (serialize_changed_pages) {
+            SerializeChangedPages(ar, vram, VRAM_SIZE, 0);
+            SerializeChangedPages(ar, fcram, fcram_size, NUM_VRAM_PAGES);
+        } else {
+            ar& boost::serialization::make_binary_object(vram, VRAM_SIZE);
+            ar& boost::serialization::make_binary_object(fcram, fcram_size);
+        }
         ar& boost::serialization::make_binary_object(
-            n3ds_extra_ram.get(), save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
+            n3ds_extra_ram, save_n3ds_ram ? Memory::N3DS_EXTRA_RAM_SIZE : 0);
         ar & cache_marker;
         ar & page_table_list;
         // dsp is set from Core::System at startup
         ar & current_page_table;
+        if (Archive::is_loading::value) {
+            for (auto& page_table : page_table_list) {
+                EnableFastmem(*page_table);
+            }
+        }
         ar & fcram_mem;
         ar & vram_mem;
         ar & n3ds_extra_ram_mem;
@@ -364,7 +460,109 @@ MemorySystem::Impl::Impl(Core::System& system_)
     : system{system_}, fcram_mem(std::make_shared<BackingMemImpl<Region::FCRAM>>(*this)),
       vram_mem(std::make_shared<BackingMemImpl<Region::VRAM>>(*this)),
       n3ds_extra_ram_mem(std::make_shared<BackingMemImpl<Region::N3DS>>(*this)),
-      dsp_mem(std::make_shared<BackingMemImpl<Region::DSP>>(*this)) {}
+      dsp_mem(std::make_shared<BackingMemImpl<Region::DSP>>(*this)) {
+    u8* memory = nullptr;
+    if (Settings::values.use_fastmem && Settings::values.use_cpu_jit) {
+        host_memory = std::make_unique<Common::HostMemory>(FASTMEM_BACKING_SIZE);
+        if (host_memory->IsValid()) {
+            memory = host_memory->BackingBasePointer();
+        } else {
+            LOG_WARNING(HW_Memory, "Fastmem is not supported on this system, disabling it");
+            host_memory.reset();
+        }
+    }
+    if (!memory) {
+        // Visual Studio would try to allocate these on compile time
+        // if they are std::array which would exceed the memory limit.
+        heap_memory = std::make_unique<u8[]>(FASTMEM_BACKING_SIZE);
+        memory = heap_memory.get();
+    }
+    fcram = memory;
+    vram = fcram + FCRAM_N3DS_SIZE;
+    n3ds_extra_ram = vram + VRAM_SIZE;
+}
+
+void MemorySystem::Impl::EnableFastmem(PageTable& page_table) {
+    if (!host_memory || fastmem_failed || page_table.fastmem_arena) {
+        return;
+    }
+    auto arena = std::make_shared<Common::HostAddressSpace>(*host_memory, FASTMEM_ARENA_SIZE);
+    if (!arena->IsValid()) {
+        return;
+    }
+    page_table.fastmem_arena = std::move(arena);
+    page_table.fastmem_base = page_table.fastmem_arena->BasePointer();
+    UpdateFastmem(page_table, 0, PAGE_TABLE_NUM_ENTRIES);
+}
+
+std::optional<std::size_t> MemorySystem::Impl::GetFastmemOffset(const PageTable& page_table,
+                                                                std::size_t page) const {
+    if (const u8* pointer = page_table.GetPointerArray()[page]) {
+        // Only memory in the host memory object can be mapped, such as not the DSP memory
+        return host_memory->GetOffset(pointer);
+    }
+
+    // Custom Luma3ds mapping of FCRAM, see Read and Write
+    const VAddr vaddr = static_cast<VAddr>(page << BORKED3DS_PAGE_BITS);
+    if (vaddr & (1 << 31)) {
+        const PAddr paddr = vaddr & ~(1 << 31);
+        if ((paddr & 0xF0000000) == FCRAM_PADDR) {
+            return paddr - FCRAM_PADDR;
+        }
+    }
+    return std::nullopt;
+}
+
+void MemorySystem::Impl::UpdateFastmem(PageTable& page_table, std::size_t first_page,
+                                       std::size_t num_pages) {
+    if (!page_table.fastmem_base) {
+        return;
+    }
+
+    // Coalesce pages that are contiguous in the backing memory into single mappings
+    const std::size_t end = first_page + num_pages;
+    std::size_t page = first_page;
+    while (page < end) {
+        const auto offset = GetFastmemOffset(page_table, page);
+        std::size_t count = 1;
+        for (; page + count < end; ++count) {
+            const auto next = GetFastmemOffset(page_table, page + count);
+            if (offset ? next != *offset + count * BORKED3DS_PAGE_SIZE : next.has_value()) {
+                break;
+            }
+        }
+        const std::size_t arena_offset = page * BORKED3DS_PAGE_SIZE;
+        const std::size_t length = count * BORKED3DS_PAGE_SIZE;
+        const bool updated = offset ? page_table.fastmem_arena->Map(arena_offset, *offset, length)
+                                    : page_table.fastmem_arena->Unmap(arena_offset, length);
+        if (!updated) {
+            DisableFastmem(page_table);
+            return;
+        }
+        page += count;
+    }
+}
+
+void MemorySystem::Impl::DisableFastmem(PageTable& failed_page_table) {
+    LOG_ERROR(HW_Memory, "Updating a fastmem arena failed, falling back to the page tables");
+    fastmem_failed = true;
+
+    const auto disable = [](PageTable& page_table) {
+        if (!page_table.fastmem_base) {
+            return;
+        }
+        // JITs created for the page table keep accessing the arena, so it stays reserved. Once
+        // none of it is accessible, their accesses fault and fall back to the page table.
+        page_table.fastmem_base = nullptr;
+        if (!page_table.fastmem_arena->Unmap(0, FASTMEM_ARENA_SIZE)) {
+            LOG_CRITICAL(HW_Memory, "Unmapping the fastmem arena failed");
+        }
+    };
+    disable(failed_page_table);
+    for (auto& page_table : page_table_list) {
+        disable(*page_table);
+    }
+}
 
 MemorySystem::MemorySystem(Core::System& system) : impl(std::make_unique<Impl>(system)) {}
 MemorySystem::~MemorySystem() = default;
@@ -376,6 +574,18 @@ void MemorySystem::serialize(Archive& ar, const unsigned int file_version) {
 
 SERIALIZE_IMPL(MemorySystem)
 
+void MemorySystem::CaptureSaveStateBase() {
+    impl->CaptureBasePageHashes();
+}
+
+bool MemorySystem::HasSaveStateBase() const {
+    return !impl->base_page_hashes.empty();
+}
+
+void MemorySystem::SetIncrementalSerialization(bool incremental) {
+    impl->serialize_changed_pages = incremental;
+}
+
 void MemorySystem::SetCurrentPageTable(std::shared_ptr<PageTable> page_table) {
     impl->current_page_table = page_table;
 }
@@ -415,6 +625,8 @@ void MemorySystem::MapPages(PageTable& page_table, u32 base, u32 size, MemoryRef
         if (memory != nullptr && memory.GetSize() > BORKED3DS_PAGE_SIZE)
             memory += BORKED3DS_PAGE_SIZE;
     }
+
+    impl->UpdateFastmem(page_table, end - size, size); // base was advanced to end
 }
 
 void MemorySystem::MapMemoryRegion(PageTable& page_table, VAddr base, u32 size, MemoryRef target) {
@@ -436,6 +648,7 @@ MemoryRef MemorySystem::GetPointerForRasterizerCache(VAddr addr) const {
 }
 
 void MemorySystem::RegisterPageTable(std::shared_ptr<PageTable> page_table) {
+    impl->EnableFastmem(*page_table);
     impl->page_table_list.push_back(page_table);
 }
 
@@ -585,6 +798,27 @@ bool MemorySystem::IsValidVirtualAddress(const Kernel::Process& process, const V
     return false;
 }
 
+std::span<u8> MemorySystem::GetContiguousSpan(const Kernel::Process& process, const VAddr vaddr,
+                                              const std::size_t size) {
+    auto& page_table = *process.vm_manager.page_table;
+    // The block must end within the 32-bit address space covered by the page table
+    if (size == 0 || size - 1 > std::numeric_limits<VAddr>::max() - vaddr) {
+        return {};
+    }
+
+    const std::size_t first_page = vaddr >> BORKED3DS_PAGE_BITS;
+    const std::size_t last_page = (vaddr + size - 1) >> BORKED3DS_PAGE_BITS;
+    u8* const base = page_table.pointers[first_page];
+    for (std::size_t page = first_page; page <= last_page; page++) {
+        const u8* pointer = page_table.pointers[page];
+        if (page_table.attributes[page] != PageType::Memory ||
+            pointer != base + (page - first_page) * BORKED3DS_PAGE_SIZE) {
+            return {};
+        }
+    }
+    return {base + (vaddr & BORKED3DS_PAGE_MASK), size};
+}
+
 bool MemorySystem::IsValidPhysicalAddress(const PAddr paddr) const {
     return GetPhysicalRef(paddr);
 }
@@ -724,6 +958,28 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
         ((start + size - 1) >> BORKED3DS_PAGE_BITS) - (start >> BORKED3DS_PAGE_BITS) + 1;
     PAddr paddr = start;
 
+    // The fastmem arenas are updated once the page tables are, one call per contiguous run of
+    // changed pages, as every call is a system call per run of the backing memory
+    struct FastmemRun {
+        PageTable* page_table;
+        std::size_t first_page;
+        std::size_t num_pages;
+    };
+    std::vector<FastmemRun> fastmem_runs;
+    const auto update_fastmem = [&fastmem_runs](PageTable& page_table, VAddr vaddr) {
+        if (!page_table.fastmem_base) {
+            return;
+        }
+        const std::size_t page = vaddr >> BORKED3DS_PAGE_BITS;
+        for (auto& run : fastmem_runs) {
+            if (run.page_table == &page_table && run.first_page + run.num_pages == page) {
+                ++run.num_pages;
+                return;
+            }
+        }
+        fastmem_runs.push_back({&page_table, page, 1});
+    };
+
     for (unsigned i = 0; i < num_pages; ++i, paddr += BORKED3DS_PAGE_SIZE) {
         for (VAddr vaddr : PhysicalToVirtualAddressForRasterizer(paddr)) {
             impl->cache_marker.Mark(vaddr, cached);
@@ -740,6 +996,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                     case PageType::Memory:
                         page_type = PageType::RasterizerCachedMemory;
                         page_table->pointers[vaddr >> BORKED3DS_PAGE_BITS] = nullptr;
+                        update_fastmem(*page_table, vaddr);
                         break;
                     default:
                         UNREACHABLE();
@@ -755,6 +1012,7 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
                         page_type = PageType::Memory;
                         page_table->pointers[vaddr >> BORKED3DS_PAGE_BITS] =
                             GetPointerForRasterizerCache(vaddr & ~BORKED3DS_PAGE_MASK);
+                        update_fastmem(*page_table, vaddr);
                         break;
                     }
                     default:
@@ -764,6 +1022,10 @@ void MemorySystem::RasterizerMarkRegionCached(PAddr start, u32 size, bool cached
             }
         }
     }
+
+    for (const auto& run : fastmem_runs) {
+        impl->UpdateFastmem(*run.page_table, run.first_page, run.num_pages);
+    }
 }
 
 u8 MemorySystem::Read8(const VAddr addr) {
@@ -927,18 +1189,18 @@ void MemorySystem::CopyBlock(const Kernel::Process& dest_process,
 }
 
 u32 MemorySystem::GetFCRAMOffset(const u8* pointer) const {
-    ASSERT(pointer >= impl->fcram.get() && pointer <= impl->fcram.get() + Memory::FCRAM_N3DS_SIZE);
-    return static_cast<u32>(pointer - impl->fcram.get());
+    ASSERT(pointer >= impl->fcram && pointer <= impl->fcram + Memory::FCRAM_N3DS_SIZE);
+    return static_cast<u32>(pointer - impl->fcram);
 }
 
 u8* MemorySystem::GetFCRAMPointer(std::size_t offset) {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 const u8* MemorySystem::GetFCRAMPointer(std::size_t offset) const {
     ASSERT(offset <= Memory::FCRAM_N3DS_SIZE);
-    return impl->fcram.get() + offset;
+    return impl->fcram + offset;
 }
 
 MemoryRef MemorySystem::GetFCRAMRef(std::size_t offset) const {
@@ -6,12 +6,18 @@
 #pragma once
 #include <array>
 #include <cstddef>
+#include <memory>
+#include <span>
 #include <string>
 #include <boost/serialization/array.hpp>
 #include <boost/serialization/vector.hpp>
 #include "common/common_types.h"
 #include "common/memory_ref.h"
 
+namespace Common {
+class HostAddressSpace;
+}
+
 namespace Kernel {
 class Process;
 }
@@ -97,10 +103,23 @@ struct PageTable {
      */
     std::array<PageType, PAGE_TABLE_NUM_ENTRIES> attributes;
 
+    /**
+     * Host address space mirroring the pointers of this page table, so that guest address `x` can
+     * be accessed at `fastmem_base + x`. Pages without a pointer are inaccessible. Only set if
+     * fastmem is enabled. If updating the arena fails, fastmem_base is cleared while the arena
+     * stays reserved and inaccessible for the JITs already using it.
+     */
+    std::shared_ptr<Common::HostAddressSpace> fastmem_arena;
+    u8* fastmem_base = nullptr;
+
     std::array<u8*, PAGE_TABLE_NUM_ENTRIES>& GetPointerArray() {
         return pointers.raw;
     }
 
+    const std::array<u8*, PAGE_TABLE_NUM_ENTRIES>& GetPointerArray() const {
+        return pointers.raw;
+    }
+
     void Clear();
 
 private:
@@ -529,6 +548,16 @@ public:
     /// Determines if the given VAddr is valid for the specified process.
     bool IsValidVirtualAddress(const Kernel::Process& process, VAddr vaddr);
 
+    /**
+     * Gets a span over a block of a process' address space, so that it can be accessed in place
+     * instead of through ReadBlock/WriteBlock.
+     *
+     * @returns The span, or an empty span if the block is not entirely backed by contiguous host
+     *          memory, for example because it touches unmapped or rasterizer cached pages.
+     */
+    std::span<u8> GetContiguousSpan(const Kernel::Process& process, VAddr vaddr,
+                                    std::size_t size);
+
     /// Returns true if the address refers to a valid memory region
     bool IsValidPhysicalAddress(PAddr paddr) const;
 
@@ -554,6 +583,15 @@ public:
 
     void RasterizerFlushVirtualRegion(VAddr start, u32 size, FlushMode mode);
 
+    /// Records the contents of VRAM and FCRAM as the base of incremental savestates.
+    void CaptureSaveStateBase();
+
+    /// Returns whether a base for incremental savestates has been captured.
+    bool HasSaveStateBase() const;
+
+    /// Sets whether serialization only includes the VRAM and FCRAM pages changed since the base.
+    void SetIncrementalSerialization(bool incremental);
+
 private:
     template <typename T>
     T Read(const VAddr vaddr);
@@ -104,6 +104,8 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     last_stats.emulation_speed = system_us_per_second.count() / 1'000'000.0;
     last_stats.artic_transmitted = static_cast<double>(artic_transmitted) / interval;
     last_stats.artic_events.raw = artic_events.raw | prev_artic_event.raw;
+    last_stats.audio_underruns = audio_underruns - reset_audio_underruns;
+    last_stats.audio_overruns = audio_overruns - reset_audio_overruns;
 
     // Reset counters
     reset_point = now;
@@ -113,6 +115,8 @@ PerfStats::Results PerfStats::GetAndResetStats(microseconds current_system_time_
     game_frames = 0;
     artic_transmitted = 0;
     prev_artic_event.raw &= artic_events.raw;
+    reset_audio_underruns = audio_underruns;
+    reset_audio_overruns = audio_overruns;
 
     return last_stats;
 }
@@ -63,6 +63,10 @@ public:
         double artic_transmitted = 0;
         /// Artic base events
         PerfArticEvents artic_events{};
+        /// Audio sink callbacks that ran out of samples since the previous results
+        u64 audio_underruns = 0;
+        /// Audio frames dropped because the output queue was full since the previous results
+        u64 audio_overruns = 0;
     };
 
     void BeginSystemFrame();
@@ -94,6 +98,12 @@ public:
         artic_transmitted += bytes;
     }
 
+    /// Records the running totals of the audio output counters, see DspInterface::OutputStats.
+    void ReportAudioOutput(u64 underruns, u64 overruns) {
+        audio_underruns = underruns;
+        audio_overruns = overruns;
+    }
+
     void ReportPerfArticEvent(PerfArticEventBits event, bool set) {
         if (set) {
             artic_events.Set(event, set);
@@ -132,6 +142,12 @@ private:
 
     PerfArticEvents prev_artic_event;
 
+    /// Running totals of the audio output counters, and their values at the last reset
+    std::atomic<u64> audio_underruns = 0;
+    std::atomic<u64> audio_overruns = 0;
+    u64 reset_audio_underruns = 0;
+    u64 reset_audio_overruns = 0;
+
     /// Point when the previous system frame ended
     Clock::time_point previous_frame_end = reset_point;
     /// Point when the current system frame began
@@ -17,7 +17,19 @@ enum class PacketType : u32 {
     ReadMemory = 1,
     WriteMemory = 2,
     SendKey = 3,
-    SendSignal = 4
+    SendSignal = 4,
+    ProfilerControl = 5,
+    ProfilerRead = 6,
+};
+
+/// Actions of a ProfilerControl packet. The snapshot actions reply with the size of the snapshot,
+/// which is then read with ProfilerRead packets.
+enum class ProfilerAction : u32 {
+    Disable = 0,
+    Enable = 1,
+    Reset = 2,
+    SnapshotJson = 3,
+    SnapshotCsv = 4,
 };
 
 struct PacketHeader {
@@ -3,8 +3,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <cstring>
 #include "common/logging/log.h"
 #include "core/core.h"
+#include "core/hle/kernel/hle_profiler.h"
+#include "core/hle/kernel/kernel.h"
 #include "core/memory.h"
 #include "core/rpc/packet.h"
 #include "core/rpc/rpc_server.h"
@@ -51,6 +55,52 @@ void RPCServer::HandleWriteMemory(Packet& packet, u32 address, std::span<const u
     packet.SendReply();
 }
 
+bool RPCServer::HandleProfilerControl(Packet& packet, u32 action) {
+    if (!system.IsPoweredOn()) {
+        return false;
+    }
+
+    auto& profiler = system.Kernel().GetHLEProfiler();
+    switch (static_cast<ProfilerAction>(action)) {
+    case ProfilerAction::Disable:
+        profiler.SetEnabled(false);
+        break;
+    case ProfilerAction::Enable:
+        profiler.SetEnabled(true);
+        break;
+    case ProfilerAction::Reset:
+        profiler.Reset();
+        break;
+    case ProfilerAction::SnapshotJson:
+    case ProfilerAction::SnapshotCsv: {
+        const auto format = static_cast<ProfilerAction>(action) == ProfilerAction::SnapshotJson
+                                ? Kernel::HLEProfiler::Format::Json
+                                : Kernel::HLEProfiler::Format::Csv;
+        profiler_snapshot = profiler.Dump(format);
+        const auto size = static_cast<u32>(profiler_snapshot.size());
+        std::memcpy(packet.GetPacketData().data(), &size, sizeof(size));
+        packet.SetPacketDataSize(sizeof(size));
+        packet.SendReply();
+        return true;
+    }
+    default:
+        return false;
+    }
+
+    packet.SetPacketDataSize(0);
+    packet.SendReply();
+    return true;
+}
+
+void RPCServer::HandleProfilerRead(Packet& packet, u32 offset, u32 data_size) {
+    const std::size_t start = std::min<std::size_t>(offset, profiler_snapshot.size());
+    const std::size_t size = std::min<std::size_t>(
+        {data_size, MAX_READ_SIZE, profiler_snapshot.size() - start});
+    std::memcpy(packet.GetPacketData().data(), profiler_snapshot.data() + start, size);
+    packet.SetPacketDataSize(static_cast<u32>(size));
+    packet.SendReply();
+}
+
 #ifndef ANDROID
 void RPCServer::HandleSendKey(Packet& packet, u32 key_code, u8 state) {
     if (state == 0) {
@@ -75,10 +125,16 @@ bool RPCServer::ValidatePacket(const PacketHeader& packet_header) {
         switch (packet_header.packet_type) {
         case PacketType::ReadMemory:
         case PacketType::WriteMemory:
+        case PacketType::ProfilerRead:
             if (packet_header.packet_size >= (sizeof(u32) * 2)) {
                 return true;
             }
             break;
+        case PacketType::ProfilerControl:
+            if (packet_header.packet_size >= sizeof(u32)) {
+                return true;
+            }
+            break;
 
 #ifndef ANDROID
         case PacketType::SendKey:
@@ -107,6 +163,8 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
     if (ValidatePacket(request_packet->GetHeader())) {
         u32 address = 0;
         u32 data_size = 0;
+        u32 action = 0;
+        u32 offset = 0;
 
 #ifndef ANDROID
         u32 key_code = 0;
@@ -132,6 +190,16 @@ void RPCServer::HandleSingleRequest(std::unique_ptr<Packet> request_packet) {
                 success = true;
             }
             break;
+        case PacketType::ProfilerControl:
+            std::memcpy(&action, packet_data.data(), sizeof(action));
+            success = HandleProfilerControl(*request_packet, action);
+            break;
+        case PacketType::ProfilerRead:
+            std::memcpy(&offset, packet_data.data(), sizeof(offset));
+            std::memcpy(&data_size, packet_data.data() + sizeof(offset), sizeof(data_size));
+            HandleProfilerRead(*request_packet, offset, data_size);
+            success = true;
+            break;
 
 #ifndef ANDROID
         case PacketType::SendKey:
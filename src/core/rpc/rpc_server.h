@@ -8,6 +8,7 @@
 #include <condition_variable>
 #include <memory>
 #include <span>
+#include <string>
 #include "common/polyfill_thread.h"
 #include "common/threadsafe_queue.h"
 
@@ -30,6 +31,8 @@ public:
 private:
     void HandleReadMemory(Packet& packet, u32 address, u32 data_size);
     void HandleWriteMemory(Packet& packet, u32 address, std::span<const u8> data);
+    bool HandleProfilerControl(Packet& packet, u32 action);
+    void HandleProfilerRead(Packet& packet, u32 offset, u32 data_size);
 
 #ifndef ANDROID
     void HandleSendKey(Packet& packet, u32 key_code, u8 state);
@@ -44,6 +47,8 @@ private:
     Core::System& system;
     Common::SPSCQueue<std::unique_ptr<Packet>, true> request_queue;
     std::jthread request_handler_thread;
+    /// Last profiler snapshot taken, read in chunks by ProfilerRead packets.
+    std::string profiler_snapshot;
 };
 
 } // namespace Core::RPC
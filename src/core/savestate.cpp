@@ -4,13 +4,16 @@
 // Refer to the license.txt file included.
 
 #include <chrono>
-#include <sstream>
+#include <random>
+#include <utility>
 #include <cryptopp/hex.h>
 #include <fmt/ranges.h>
 #include "common/archives.h"
 #include "common/file_util.h"
 #include "common/logging/log.h"
 #include "common/scm_rev.h"
+#include "common/scope_exit.h"
+#include "common/settings.h"
 #include "common/swap.h"
 #include "common/zstd_compression.h"
 #include "core/core.h"
@@ -30,14 +33,31 @@ struct CSTHeader {
     u64_le time;                   /// The time when this save state was created
     std::array<u8, 20> build_name; /// The build name (Canary/Nightly) with the version number
     u32_le zero = 0;               /// Should be zero, just in case.
+    u32_le flags = 0;              /// Combination of CSTFlags
+    u32_le base_slot = 0;          /// Slot of the full savestate an incremental one is based on
+    u64_le base_nonce = 0;         /// Nonce of that full savestate
+    u32_le version = 0;            /// Version of the file format, 0 before the field existed
+    u64_le nonce = 0;              /// Random value identifying this savestate file
 
-    std::array<u8, 192> reserved{}; /// Make heading 256 bytes so it has consistent size
+    std::array<u8, 164> reserved{}; /// Make heading 256 bytes so it has consistent size
 };
 static_assert(sizeof(CSTHeader) == 256, "CSTHeader should be 256 bytes");
 #pragma pack(pop)
 
 constexpr std::array<u8, 4> header_magic_bytes{{'C', 'S', 'T', 0x1B}};
 
+/// Incremental savestates cannot be loaded on their own, so they use a different identifier that
+/// builds without support for them reject.
+constexpr std::array<u8, 4> incremental_magic_bytes{{'C', 'S', 'T', 0x1C}};
+
+/// Current version of the file format. Files of newer versions are rejected.
+constexpr u32 CST_VERSION = 1;
+
+enum CSTFlags : u32 {
+    /// Only the VRAM and FCRAM pages changed since the base savestate are stored
+    CST_FLAG_INCREMENTAL = 1 << 0,
+};
+
 static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
     if (movie_id) {
         return fmt::format("{}{:016X}.movie{:016X}.{:02d}.cst",
@@ -49,13 +69,32 @@ static std::string GetSaveStatePath(u64 program_id, u64 movie_id, u32 slot) {
     }
 }
 
+/// Returns a random non-zero value, so that a base savestate can't be mistaken for a later
+/// savestate written to the same slot.
+static u64 GenerateNonce() {
+    std::random_device device;
+    std::uniform_int_distribution<u64> distribution{1};
+    return distribution(device);
+}
+
+static bool ReadSaveStateHeader(FileUtil::IOFile& file, CSTHeader& header) {
+    return file && file.GetSize() >= sizeof(header) &&
+           file.ReadBytes(&header, sizeof(header)) == sizeof(header);
+}
+
 static bool ValidateSaveState(const CSTHeader& header, SaveStateInfo& info, u64 program_id,
                               u64 movie_id) {
     const auto path = GetSaveStatePath(program_id, movie_id, info.slot);
-    if (header.filetype != header_magic_bytes) {
+    const bool incremental = header.flags & CST_FLAG_INCREMENTAL;
+    if (header.filetype != (incremental ? incremental_magic_bytes : header_magic_bytes)) {
         LOG_WARNING(Core, "Invalid save state file {}", path);
         return false;
     }
+    if (header.version > CST_VERSION) {
+        LOG_WARNING(Core, "Save state file {} has an unsupported format version {}", path,
+                    header.version);
+        return false;
+    }
     info.time = header.time;
 
     if (header.program_id != program_id) {
@@ -123,24 +162,29 @@ std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id) {
     return result;
 }
 
-void System::SaveState(u32 slot) const {
+void System::SaveState(u32 slot) {
     if (app_loader) {
         if (!app_loader->SupportsSaveStates()) {
             throw std::runtime_error("The current app loader doesn't support save states");
         }
     }
 
-    std::ostringstream sstream{std::ios_base::binary};
-    // Serialize
-    oarchive oa{sstream};
-    oa&* this;
-
-    const std::string& str{sstream.str()};
-    const auto data = std::span<const u8>{reinterpret_cast<const u8*>(str.data()), str.size()};
-    auto buffer = Common::Compression::CompressDataZSTDDefault(data);
-
     const u64 movie_id = movie.GetCurrentMovieID();
     const auto path = GetSaveStatePath(title_id, movie_id, slot);
+
+    // Only store the changed memory pages if the base savestate is still the one in memory
+    bool incremental = false;
+    if (Settings::values.incremental_savestates && savestate_base &&
+        savestate_base->program_id == title_id && savestate_base->movie_id == movie_id &&
+        savestate_base->slot != slot && memory->HasSaveStateBase()) {
+        FileUtil::IOFile base_file(GetSaveStatePath(title_id, movie_id, savestate_base->slot),
+                                   "rb");
+        CSTHeader base_header;
+        incremental = ReadSaveStateHeader(base_file, base_header) &&
+                      base_header.filetype == header_magic_bytes &&
+                      base_header.nonce == savestate_base->nonce;
+    }
+
     if (!FileUtil::CreateFullPath(path)) {
         throw std::runtime_error("Could not create path " + path);
     }
@@ -151,7 +195,9 @@ void System::SaveState(u32 slot) const {
     }
 
     CSTHeader header{};
-    header.filetype = header_magic_bytes;
+    header.filetype = incremental ? incremental_magic_bytes : header_magic_bytes;
+    header.version = CST_VERSION;
+    header.nonce = GenerateNonce();
     header.program_id = title_id;
     std::string rev_bytes;
     CryptoPP::StringSource ss(Common::g_scm_rev, true,
@@ -164,11 +210,32 @@ void System::SaveState(u32 slot) const {
     std::memset(header.build_name.data(), 0, sizeof(header.build_name));
     std::memcpy(header.build_name.data(), build_fullname.c_str(),
                 std::min(build_fullname.length(), sizeof(header.build_name) - 1));
+    if (incremental) {
+        header.flags = CST_FLAG_INCREMENTAL;
+        header.base_slot = savestate_base->slot;
+        header.base_nonce = savestate_base->nonce;
+    }
 
-    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header) ||
-        file.WriteBytes(buffer.data(), buffer.size()) != buffer.size()) {
+    if (file.WriteBytes(&header, sizeof(header)) != sizeof(header)) {
         throw std::runtime_error("Could not write to file " + path);
     }
+
+    // Serialize straight into the compressor so the state is never held in memory as a whole
+    memory->SetIncrementalSerialization(incremental);
+    SCOPE_EXIT({ memory->SetIncrementalSerialization(false); });
+    Common::Compression::ZSTDOutputBuffer buffer{file};
+    {
+        oarchive oa{buffer};
+        oa& std::as_const(*this);
+    }
+    if (!buffer.Finish()) {
+        throw std::runtime_error("Could not write to file " + path);
+    }
+
+    if (!incremental && Settings::values.incremental_savestates) {
+        memory->CaptureSaveStateBase();
+        savestate_base = SaveStateBase{title_id, movie_id, slot, header.nonce};
+    }
 }
 
 void System::LoadState(u32 slot) {
@@ -182,40 +249,64 @@ void System::LoadState(u32 slot) {
     }
 
     const u64 movie_id = movie.GetCurrentMovieID();
-    const auto path = GetSaveStatePath(title_id, movie_id, slot);
-
-    std::vector<u8> decompressed;
-    {
-        std::vector<u8> buffer(FileUtil::GetSize(path) - sizeof(CSTHeader));
 
+    const auto load = [this, movie_id](u32 load_slot, CSTHeader& header) {
+        const auto path = GetSaveStatePath(title_id, movie_id, load_slot);
         FileUtil::IOFile file(path, "rb");
-
-        // load header
-        CSTHeader header;
-        if (file.ReadBytes(&header, sizeof(header)) != sizeof(header)) {
+        if (!ReadSaveStateHeader(file, header)) {
             throw std::runtime_error("Could not read from file at " + path);
         }
 
-        // validate header
         SaveStateInfo info;
-        info.slot = slot;
+        info.slot = load_slot;
         if (!ValidateSaveState(header, info, title_id, movie_id)) {
             throw std::runtime_error("Invalid savestate");
         }
+        return file;
+    };
 
-        if (file.ReadBytes(buffer.data(), buffer.size()) != buffer.size()) {
-            throw std::runtime_error("Could not read from file at " + path);
+    const auto deserialize = [this](FileUtil::IOFile& file, bool incremental) {
+        memory->SetIncrementalSerialization(incremental);
+        SCOPE_EXIT({ memory->SetIncrementalSerialization(false); });
+        Common::Compression::ZSTDInputBuffer buffer{file};
+        iarchive ia{buffer};
+        ia&* this;
+    };
+
+    CSTHeader header;
+    FileUtil::IOFile file = load(slot, header);
+    const bool incremental = header.flags & CST_FLAG_INCREMENTAL;
+    u32 base_slot = slot;
+    u64 base_nonce = header.nonce;
+    if (incremental) {
+        // Restore the full base savestate first, then apply the changed pages on top of it
+        CSTHeader base_header;
+        FileUtil::IOFile base_file = load(header.base_slot, base_header);
+        if (base_header.nonce != header.base_nonce ||
+            (base_header.flags & CST_FLAG_INCREMENTAL)) {
+            throw std::runtime_error("The base savestate of this incremental savestate in slot " +
+                                     std::to_string(header.base_slot) + " was overwritten");
+        }
+        deserialize(base_file, false);
+        base_slot = header.base_slot;
+        base_nonce = base_header.nonce;
+        if (Settings::values.incremental_savestates) {
+            memory->CaptureSaveStateBase();
         }
-        decompressed = Common::Compression::DecompressDataZSTD(buffer);
     }
-    std::istringstream sstream{
-        std::string{reinterpret_cast<char*>(decompressed.data()), decompressed.size()},
-        std::ios_base::binary};
-    decompressed.clear();
 
-    // Deserialize
-    iarchive ia{sstream};
-    ia&* this;
+    deserialize(file, incremental);
+
+    // Savestates from before the nonce existed can't be told apart from their successors, so
+    // they are never used as a base.
+    if (Settings::values.incremental_savestates && base_nonce != 0) {
+        if (!incremental) {
+            memory->CaptureSaveStateBase();
+        }
+        savestate_base = SaveStateBase{title_id, movie_id, base_slot, base_nonce};
+    } else {
+        savestate_base.reset();
+    }
 }
 
 } // namespace Core
@@ -21,6 +21,14 @@ struct SaveStateInfo {
     std::string build_name;
 };
 
+/// The full savestate that incremental savestates only store the changed memory pages against.
+struct SaveStateBase {
+    u64 program_id;
+    u64 movie_id;
+    u32 slot;
+    u64 nonce; ///< Random value stored in the header of the base savestate file
+};
+
 constexpr u32 SaveStateSlotCount = 11; // Maximum count of savestate slots
 
 std::vector<SaveStateInfo> ListSaveStates(u64 program_id, u64 movie_id);
@@ -0,0 +1,425 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+// Headless load generator for the room server. Spawns simulated RoomMembers on localhost, makes
+// them exchange Wi-Fi or chat traffic through a Room and reports the relay throughput, latency and
+// the CPU time used by the room server thread.
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fmt/format.h>
+
+#ifdef __linux__
+#include <filesystem>
+#include <fstream>
+#include <unistd.h>
+#endif
+
+#include "common/common_types.h"
+#include "common/logging/backend.h"
+#include "common/scm_rev.h"
+#include "network/network.h"
+#include "network/room.h"
+#include "network/room_member.h"
+
+#undef _UNICODE
+#include <getopt.h>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class Pattern {
+    Broadcast, ///< Every member broadcasts data frames to all other members.
+    Unicast,   ///< Every member sends data frames to the next member.
+    Bursty,    ///< Like Broadcast, but the frames of a round are sent in bursts.
+    Chat,      ///< Every member sends chat messages, which the room relays to all others.
+};
+
+struct Options {
+    u32 members = 8;
+    u32 rate = 60;  ///< Frames per second sent by each member
+    u32 size = 512; ///< Payload size of the data frames in bytes
+    u32 burst = 16; ///< Frames per burst for Pattern::Bursty
+    double duration = 10.0;
+    Pattern pattern = Pattern::Broadcast;
+    std::string room_address; ///< Benchmarks an external room instead of spawning one if set
+    u16 port = Network::DefaultRoomPort + 1;
+    bool unreliable_data_frames = false;
+};
+
+/// Every benchmark frame starts with its send time, used to measure the relay latency.
+constexpr std::size_t MinFrameSize = sizeof(u64);
+
+/// Counters of one simulated member. Only written by the member's network thread, and only read
+/// after the member has left the room.
+struct MemberStats {
+    u64 received = 0;
+    u64 received_bytes = 0;
+    std::vector<u64> latencies_ns;
+};
+
+u64 NowNs() {
+    return static_cast<u64>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch())
+            .count());
+}
+
+void PrintHelp(const char* argv0) {
+    std::cout << "Usage: " << argv0
+              << " [options]\n"
+                 "--members         Number of simulated members (default 8)\n"
+                 "--pattern         Traffic pattern: broadcast, unicast, bursty or chat\n"
+                 "--rate            Frames sent per second by each member (default 60)\n"
+                 "--size            Payload size of the data frames in bytes (default 512)\n"
+                 "--burst           Frames per burst for the bursty pattern (default 16)\n"
+                 "--duration        Length of the measurement in seconds (default 10)\n"
+                 "--port            The port of the room\n"
+                 "--room-address    Benchmark the room at this address instead of spawning one\n"
+                 "--unreliable-data-frames Relay UDS data frames unreliably\n"
+                 "-h, --help        Display this help and exit\n"
+                 "-v, --version     Output version information and exit\n";
+}
+
+std::optional<Pattern> ParsePattern(const std::string& name) {
+    if (name == "broadcast") {
+        return Pattern::Broadcast;
+    }
+    if (name == "unicast") {
+        return Pattern::Unicast;
+    }
+    if (name == "bursty") {
+        return Pattern::Bursty;
+    }
+    if (name == "chat") {
+        return Pattern::Chat;
+    }
+    return std::nullopt;
+}
+
+/// Returns the CPU time used by the room server thread, if the platform allows inspecting it.
+std::optional<double> RoomThreadCpuSeconds() {
+#ifdef __linux__
+    const long ticks_per_second = sysconf(_SC_CLK_TCK);
+    std::error_code error;
+    for (const auto& task : std::filesystem::directory_iterator{"/proc/self/task", error}) {
+        std::ifstream comm{task.path() / "comm"};
+        std::string name;
+        if (!std::getline(comm, name) || name != "RoomServer") {
+            continue;
+        }
+        std::ifstream stat{task.path() / "stat"};
+        std::string line;
+        std::getline(stat, line);
+        // The thread name is in parentheses and may contain spaces, so skip past it. utime and
+        // stime are the 12th and 13th fields after it.
+        std::istringstream fields{line.substr(line.rfind(')') + 2)};
+        std::string field;
+        u64 utime = 0;
+        u64 stime = 0;
+        for (int i = 0; i < 11; i++) {
+            fields >> field;
+        }
+        fields >> utime >> stime;
+        return static_cast<double>(utime + stime) / static_cast<double>(ticks_per_second);
+    }
+#endif
+    return std::nullopt;
+}
+
+/// Returns the CPU time used by the room server thread, or by the whole process if the room is
+/// external or its thread cannot be inspected.
+double CpuSeconds(bool room_thread) {
+    if (room_thread) {
+        return *RoomThreadCpuSeconds();
+    }
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+}
+
+u64 Percentile(const std::vector<u64>& sorted, double percentile) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    const auto index =
+        static_cast<std::size_t>(percentile * static_cast<double>(sorted.size() - 1));
+    return sorted[index];
+}
+
+class SimulatedMember {
+public:
+    explicit SimulatedMember(u32 index_) : index{index_} {}
+
+    ~SimulatedMember() {
+        if (member.IsConnected()) {
+            member.Leave();
+        }
+    }
+
+    bool Join(const Options& options) {
+        wifi_handle = member.BindOnWifiPacketReceived([this](const Network::WifiPacket& packet) {
+            if (packet.data.size() < MinFrameSize) {
+                return;
+            }
+            u64 send_time_ns;
+            std::memcpy(&send_time_ns, packet.data.data(), sizeof(u64));
+            Record(send_time_ns, packet.data.size());
+        });
+        chat_handle = member.BindOnChatMessageRecieved([this](const Network::ChatEntry& entry) {
+            Record(std::stoull(entry.message), entry.message.size());
+        });
+
+        const std::string address =
+            options.room_address.empty() ? "127.0.0.1" : options.room_address;
+        member.Join(fmt::format("bench{}", index), fmt::format("bench-console-{}", index),
+                    address.c_str(), options.port);
+
+        const auto deadline = Clock::now() + std::chrono::seconds{5};
+        while (member.GetState() == Network::RoomMember::State::Joining &&
+               Clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        return member.GetState() == Network::RoomMember::State::Joined;
+    }
+
+    void Leave() {
+        member.Leave();
+        member.Unbind(wifi_handle);
+        member.Unbind(chat_handle);
+    }
+
+    void SendFrame(const Options& options, const Network::MacAddress& destination) {
+        Network::WifiPacket packet{};
+        packet.type = Network::WifiPacket::PacketType::Data;
+        packet.channel = 1;
+        packet.transmitter_address = member.GetMacAddress();
+        packet.destination_address = destination;
+        packet.data.resize(std::max<std::size_t>(options.size, MinFrameSize));
+        const u64 send_time_ns = NowNs();
+        std::memcpy(packet.data.data(), &send_time_ns, sizeof(u64));
+        member.SendWifiPacket(packet);
+    }
+
+    void SendChat() {
+        member.SendChatMessage(std::to_string(NowNs()));
+    }
+
+    const Network::MacAddress& GetMacAddress() const {
+        return member.GetMacAddress();
+    }
+
+    const MemberStats& GetStats() const {
+        return stats;
+    }
+
+private:
+    void Record(u64 send_time_ns, std::size_t size) {
+        stats.received++;
+        stats.received_bytes += size;
+        stats.latencies_ns.push_back(NowNs() - send_time_ns);
+    }
+
+    u32 index;
+    Network::RoomMember member;
+    Network::RoomMember::CallbackHandle<Network::WifiPacket> wifi_handle;
+    Network::RoomMember::CallbackHandle<Network::ChatEntry> chat_handle;
+    MemberStats stats;
+};
+
+} // Anonymous namespace
+
+/// Application entry point
+int main(int argc, char** argv) {
+    Options options;
+    int option_index = 0;
+
+    static struct option long_options[] = {
+        {"members", required_argument, 0, 'n'},
+        {"pattern", required_argument, 0, 't'},
+        {"rate", required_argument, 0, 'r'},
+        {"size", required_argument, 0, 's'},
+        {"burst", required_argument, 0, 'b'},
+        {"duration", required_argument, 0, 'd'},
+        {"port", required_argument, 0, 'p'},
+        {"room-address", required_argument, 0, 'a'},
+        {"unreliable-data-frames", no_argument, 0, 'u'},
+        {"help", no_argument, 0, 'h'},
+        {"version", no_argument, 0, 'v'},
+        {0, 0, 0, 0},
+    };
+
+    while (optind < argc) {
+        int arg = getopt_long(argc, argv, "n:t:r:s:b:d:p:a:uhv", long_options, &option_index);
+        if (arg == -1) {
+            break;
+        }
+        switch (static_cast<char>(arg)) {
+        case 'n':
+            options.members = static_cast<u32>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 't': {
+            const auto pattern = ParsePattern(optarg);
+            if (!pattern) {
+                std::cout << "Unknown traffic pattern: " << optarg << "\n\n";
+                PrintHelp(argv[0]);
+                return -1;
+            }
+            options.pattern = *pattern;
+            break;
+        }
+        case 'r':
+            options.rate = static_cast<u32>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 's':
+            options.size = static_cast<u32>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 'b':
+            options.burst = static_cast<u32>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 'd':
+            options.duration = std::strtod(optarg, nullptr);
+            break;
+        case 'p':
+            options.port = static_cast<u16>(std::strtoul(optarg, nullptr, 0));
+            break;
+        case 'a':
+            options.room_address.assign(optarg);
+            break;
+        case 'u':
+            options.unreliable_data_frames = true;
+            break;
+        case 'h':
+            PrintHelp(argv[0]);
+            return 0;
+        case 'v':
+            std::cout << "Borked3DS room benchmark " << Common::g_scm_branch << " "
+                      << Common::g_scm_desc << " Libnetwork: " << Network::network_version
+                      << std::endl;
+            return 0;
+        default:
+            PrintHelp(argv[0]);
+            return -1;
+        }
+    }
+
+    if (options.members < 2 || options.rate == 0 || options.burst == 0 ||
+        options.duration <= 0.0) {
+        std::cout << "At least two members, a non-zero rate and burst and a positive duration "
+                     "are required\n\n";
+        PrintHelp(argv[0]);
+        return -1;
+    }
+
+    Common::Log::Initialize("borked3ds-room-bench.log");
+    Common::Log::Start();
+
+    if (!Network::Init()) {
+        std::cout << "Failed to initialize the network\n";
+        return -1;
+    }
+
+    const bool local_room = options.room_address.empty();
+    std::shared_ptr<Network::Room> room = Network::GetRoom().lock();
+    if (local_room) {
+        room->SetUnreliableDataFrames(options.unreliable_data_frames);
+        if (!room->Create("Benchmark", "", "", options.port, "", options.members)) {
+            std::cout << "Failed to create room on port " << options.port << "\n";
+            Network::Shutdown();
+            return -1;
+        }
+    }
+
+    std::vector<std::unique_ptr<SimulatedMember>> members;
+    for (u32 i = 0; i < options.members; i++) {
+        auto& member = members.emplace_back(std::make_unique<SimulatedMember>(i));
+        if (!member->Join(options)) {
+            std::cout << "Member " << i << " failed to join the room\n";
+            members.clear();
+            Network::Shutdown();
+            return -1;
+        }
+    }
+    std::cout << "Joined " << options.members << " members, measuring for " << options.duration
+              << " s...\n";
+
+    // All members send one round of frames per interval, in bursts for the bursty pattern.
+    const u32 frames_per_round = options.pattern == Pattern::Bursty ? options.burst : 1;
+    const auto interval = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(frames_per_round) / options.rate));
+    const auto duration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.duration));
+
+    // Only the room thread is measured if possible, as the members run in this process too.
+    const bool room_thread = local_room && RoomThreadCpuSeconds().has_value();
+    u64 sent = 0;
+    const double cpu_start = CpuSeconds(room_thread);
+    const auto start = Clock::now();
+    for (auto next_round = start; next_round - start < duration; next_round += interval) {
+        std::this_thread::sleep_until(next_round);
+        for (u32 frame = 0; frame < frames_per_round; frame++) {
+            for (u32 i = 0; i < members.size(); i++) {
+                switch (options.pattern) {
+                case Pattern::Broadcast:
+                case Pattern::Bursty:
+                    members[i]->SendFrame(options, Network::BroadcastMac);
+                    break;
+                case Pattern::Unicast:
+                    members[i]->SendFrame(options,
+                                          members[(i + 1) % members.size()]->GetMacAddress());
+                    break;
+                case Pattern::Chat:
+                    members[i]->SendChat();
+                    break;
+                }
+                sent++;
+            }
+        }
+    }
+    const double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Let the frames that are still in flight arrive before stopping the members.
+    std::this_thread::sleep_for(std::chrono::milliseconds{500});
+    const double cpu = CpuSeconds(room_thread) - cpu_start;
+
+    u64 received = 0;
+    u64 received_bytes = 0;
+    std::vector<u64> latencies;
+    for (auto& member : members) {
+        member->Leave();
+        const MemberStats& stats = member->GetStats();
+        received += stats.received;
+        received_bytes += stats.received_bytes;
+        latencies.insert(latencies.end(), stats.latencies_ns.begin(), stats.latencies_ns.end());
+    }
+    members.clear();
+    Network::Shutdown();
+    Common::Log::Stop();
+
+    std::sort(latencies.begin(), latencies.end());
+    const u64 expected = options.pattern == Pattern::Unicast ? sent : sent * (options.members - 1);
+    const u64 lost = expected > received ? expected - received : 0;
+    const auto to_ms = [](u64 ns) { return static_cast<double>(ns) / 1e6; };
+
+    fmt::print("Pattern:   {} members, {} frames/s each, {} bytes\n", options.members,
+               options.rate, options.pattern == Pattern::Chat ? 0 : options.size);
+    fmt::print("Sent:      {} frames ({:.1f}/s)\n", sent, sent / elapsed);
+    fmt::print("Received:  {} frames ({:.1f}/s, {:.2f} MiB/s)\n", received, received / elapsed,
+               received_bytes / elapsed / (1024.0 * 1024.0));
+    fmt::print("Lost:      {} ({:.2f}%)\n", lost,
+               expected == 0 ? 0.0 : 100.0 * static_cast<double>(lost) / expected);
+    fmt::print("Latency:   p50 {:.3f} ms, p99 {:.3f} ms, max {:.3f} ms\n",
+               to_ms(Percentile(latencies, 0.50)), to_ms(Percentile(latencies, 0.99)),
+               to_ms(latencies.empty() ? 0 : latencies.back()));
+    fmt::print("{}:  {:.1f}% of one core\n", room_thread ? "Room CPU" : "All CPU ",
+               100.0 * cpu / elapsed);
+    return 0;
+}
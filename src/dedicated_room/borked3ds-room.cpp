@@ -59,6 +59,7 @@ static void PrintHelp(const char* argv0) {
            "--ban-list-file     The file for storing the room ban list\n"
            "--log-file          The file for storing the room log\n"
            "--enable-borked3ds-mods Allow Borked3DS Community Moderators to moderate on your room\n"
+           "--unreliable-data-frames Relay UDS data frames unreliably, dropping lost frames\n"
            "-h, --help          Display this help and exit\n"
            "-v, --version       Output version information and exit\n";
 }
@@ -175,6 +176,7 @@ int main(int argc, char** argv) {
     u64 preferred_game_id = 0;
     u16 port = Network::DefaultRoomPort;
     u32 max_members = 16;
+    bool unreliable_data_frames = false;
 
     static struct option long_options[] = {
         {"room-name", required_argument, 0, 'n'},
@@ -190,6 +192,7 @@ int main(int argc, char** argv) {
         {"ban-list-file", required_argument, 0, 'b'},
         {"log-file", required_argument, 0, 'l'},
         {"enable-borked3ds-mods", no_argument, 0, 'e'},
+        {"unreliable-data-frames", no_argument, 0, 'r'},
         {"help", no_argument, 0, 'h'},
         {"version", no_argument, 0, 'v'},
         {0, 0, 0, 0},
@@ -235,6 +238,9 @@ int main(int argc, char** argv) {
             case 'l':
                 log_file.assign(optarg);
                 break;
+            case 'r':
+                unreliable_data_frames = true;
+                break;
             case 'h':
                 PrintHelp(argv[0]);
                 return 0;
@@ -322,6 +328,7 @@ int main(int argc, char** argv) {
 
     Network::Init();
     if (std::shared_ptr<Network::Room> room = Network::GetRoom().lock()) {
+        room->SetUnreliableDataFrames(unreliable_data_frames);
         if (!room->Create(room_name, room_description, "", port, password, max_members, username,
                           preferred_game, preferred_game_id, std::move(verify_backend), ban_list)) {
             std::cout << "Failed to create room: \n\n";
@@ -5,19 +5,42 @@
 
 #include <algorithm>
 #include <atomic>
+#include <cstring>
 #include <mutex>
 #include <random>
 #include <regex>
 #include <sstream>
 #include <thread>
+#include <unordered_map>
 #include "common/logging/log.h"
+#include "common/thread.h"
 #include "enet/enet.h"
 #include "network/packet.h"
 #include "network/room.h"
+#include "network/room_member.h"
 #include "network/verify_user.h"
 
 namespace Network {
 
+namespace {
+
+/// Offset of the WifiPacket type in a IdWifiPacket message, after the message type.
+constexpr std::size_t WifiPacketTypeOffset = sizeof(u8);
+/// Offset of the destination address, after the type, channel and transmitter address.
+constexpr std::size_t WifiPacketDestinationOffset = 3 * sizeof(u8) + sizeof(MacAddress);
+/// Size of the IdWifiPacket header that is needed to route the packet.
+constexpr std::size_t WifiPacketHeaderSize = WifiPacketDestinationOffset + sizeof(MacAddress);
+
+struct MacAddressHash {
+    std::size_t operator()(const MacAddress& address) const noexcept {
+        u64 value = 0;
+        std::memcpy(&value, address.data(), sizeof(MacAddress));
+        return std::hash<u64>{}(value);
+    }
+};
+
+} // Anonymous namespace
+
 class Room::RoomImpl {
 public:
     // This MAC address is used to generate a 'Nintendo' like Mac address.
@@ -48,6 +71,13 @@ public:
     mutable std::mutex member_mutex; ///< Mutex for locking the members list
     /// This should be a std::shared_mutex as soon as C++17 is supported
 
+    /// Peer of each member by MAC address, used to relay unicast Wi-Fi packets.
+    /// Guarded by member_mutex.
+    std::unordered_map<MacAddress, ENetPeer*, MacAddressHash> peers_by_mac;
+
+    /// Whether UDS data frames are relayed unreliable and unsequenced.
+    std::atomic<bool> unreliable_data_frames{false};
+
     UsernameBanList username_ban_list; ///< List of banned usernames
     IPBanList ip_ban_list;             ///< List of banned IP addresses
     mutable std::mutex ban_list_mutex; ///< Mutex for the ban lists
@@ -223,7 +253,8 @@ public:
     MacAddress GenerateMacAddress();
 
     /**
-     * Broadcasts this packet to all members except the sender.
+     * Relays this packet to its destination member, or to all members except the sender if it
+     * is a broadcast. The received ENet packet is forwarded as is, without copying it.
      * @param event The ENet event containing the data
      */
     void HandleWifiPacket(const ENetEvent* event);
@@ -249,9 +280,16 @@ public:
 
 // RoomImpl
 void Room::RoomImpl::ServerLoop() {
+    Common::SetCurrentThreadName("RoomServer");
     while (state != State::Closed) {
         ENetEvent event;
-        if (enet_host_service(server, &event, 16) > 0) {
+        if (enet_host_service(server, &event, 16) <= 0) {
+            continue;
+        }
+
+        // Handle every event that is already queued before flushing, so that relayed packets
+        // are sent in batches instead of with one flush each.
+        do {
             switch (event.type) {
             case ENET_EVENT_TYPE_RECEIVE:
                 switch (event.packet->data[0]) {
@@ -281,7 +319,10 @@ void Room::RoomImpl::ServerLoop() {
                     HandleModGetBanListPacket(&event);
                     break;
                 }
-                enet_packet_destroy(event.packet);
+                // Relayed packets are released by ENet once they have been sent.
+                if (event.packet->referenceCount == 0) {
+                    enet_packet_destroy(event.packet);
+                }
                 break;
             case ENET_EVENT_TYPE_DISCONNECT:
                 HandleClientDisconnection(event.peer);
@@ -290,7 +331,8 @@ void Room::RoomImpl::ServerLoop() {
             case ENET_EVENT_TYPE_CONNECT:
                 break;
             }
-        }
+        } while (enet_host_check_events(server, &event) > 0);
+        enet_host_flush(server);
     }
     // Close the connection to all members:
     SendCloseMessage();
@@ -404,6 +446,7 @@ void Room::RoomImpl::HandleJoinRequest(const ENetEvent* event) {
 
     {
         std::lock_guard lock(member_mutex);
+        peers_by_mac[member.mac_address] = member.peer;
         members.push_back(std::move(member));
     }
 
@@ -450,6 +493,7 @@ void Room::RoomImpl::HandleModKickPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        peers_by_mac.erase(target_member->mac_address);
         members.erase(target_member);
     }
 
@@ -493,6 +537,7 @@ void Room::RoomImpl::HandleModBanPacket(const ENetEvent* event) {
         ip = ip_raw;
 
         enet_peer_disconnect(target_member->peer, 0);
+        peers_by_mac.erase(target_member->mac_address);
         members.erase(target_member);
     }
 
@@ -847,51 +892,42 @@ MacAddress Room::RoomImpl::GenerateMacAddress() {
 }
 
 void Room::RoomImpl::HandleWifiPacket(const ENetEvent* event) {
-    Packet in_packet;
-    in_packet.Append(event->packet->data, event->packet->dataLength);
-    in_packet.IgnoreBytes(sizeof(u8));         // Message type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Type
-    in_packet.IgnoreBytes(sizeof(u8));         // WifiPacket Channel
-    in_packet.IgnoreBytes(sizeof(MacAddress)); // WifiPacket Transmitter Address
+    // Only the header is needed for routing, so it is read in place from the received packet.
+    ENetPacket* enet_packet = event->packet;
+    if (enet_packet->dataLength < WifiPacketHeaderSize) {
+        LOG_ERROR(Network, "Received a truncated Wi-Fi packet");
+        return;
+    }
     MacAddress destination_address;
-    in_packet >> destination_address;
+    std::memcpy(destination_address.data(), enet_packet->data + WifiPacketDestinationOffset,
+                sizeof(MacAddress));
 
-    Packet out_packet;
-    out_packet.Append(event->packet->data, event->packet->dataLength);
-    ENetPacket* enet_packet = enet_packet_create(out_packet.GetData(), out_packet.GetDataSize(),
-                                                 ENET_PACKET_FLAG_RELIABLE);
+    if (unreliable_data_frames && enet_packet->data[WifiPacketTypeOffset] ==
+                                      static_cast<u8>(WifiPacket::PacketType::Data)) {
+        enet_packet->flags = ENET_PACKET_FLAG_UNSEQUENCED;
+    }
 
+    // The received packet is shared by all recipients. If nobody takes a reference, the server
+    // loop destroys it.
+    std::lock_guard lock(member_mutex);
     if (destination_address == BroadcastMac) { // Send the data to everyone except the sender
-        std::lock_guard lock(member_mutex);
-        bool sent_packet = false;
         for (const auto& member : members) {
             if (member.peer != event->peer) {
-                sent_packet = true;
                 enet_peer_send(member.peer, 0, enet_packet);
             }
         }
-
-        if (!sent_packet) {
-            enet_packet_destroy(enet_packet);
-        }
     } else { // Send the data only to the destination client
-        std::lock_guard lock(member_mutex);
-        auto member = std::find_if(members.begin(), members.end(),
-                                   [destination_address](const Member& member) -> bool {
-                                       return member.mac_address == destination_address;
-                                   });
-        if (member != members.end()) {
-            enet_peer_send(member->peer, 0, enet_packet);
+        const auto peer = peers_by_mac.find(destination_address);
+        if (peer != peers_by_mac.end()) {
+            enet_peer_send(peer->second, 0, enet_packet);
         } else {
             LOG_ERROR(Network,
                       "Attempting to send to unknown MAC address: "
                       "{:02X}:{:02X}:{:02X}:{:02X}:{:02X}:{:02X}",
                       destination_address[0], destination_address[1], destination_address[2],
                       destination_address[3], destination_address[4], destination_address[5]);
-            enet_packet_destroy(enet_packet);
         }
     }
-    enet_host_flush(server);
 }
 
 void Room::RoomImpl::HandleChatPacket(const ENetEvent* event) {
@@ -993,6 +1029,7 @@ void Room::RoomImpl::HandleClientDisconnection(ENetPeer* client) {
             enet_address_get_host_ip(&member->peer->address, ip_raw, sizeof(ip_raw) - 1);
             ip = ip_raw;
 
+            peers_by_mac.erase(member->mac_address);
             members.erase(member);
         }
     }
@@ -1084,6 +1121,10 @@ bool Room::HasPassword() const {
     return !room_impl->password.empty();
 }
 
+void Room::SetUnreliableDataFrames(bool enable) {
+    room_impl->unreliable_data_frames = enable;
+}
+
 void Room::SetVerifyUID(const std::string& uid) {
     std::lock_guard lock(room_impl->verify_UID_mutex);
     room_impl->verify_UID = uid;
@@ -1102,6 +1143,7 @@ void Room::Destroy() {
     {
         std::lock_guard lock(room_impl->member_mutex);
         room_impl->members.clear();
+        room_impl->peers_by_mac.clear();
     }
     room_impl->room_information.member_slots = 0;
     room_impl->room_information.name.clear();
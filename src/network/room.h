@@ -155,6 +155,12 @@ public:
      */
     void SetVerifyUID(const std::string& uid);
 
+    /**
+     * Sets whether UDS data frames are relayed unreliable and unsequenced. Lost data frames are
+     * then dropped instead of stalling every packet behind them; all other packets stay reliable.
+     */
+    void SetUnreliableDataFrames(bool enable);
+
     /**
      * Gets the ban list (including banned forum usernames and IPs) of the room.
      */
@@ -0,0 +1,144 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <memory>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/generators/catch_generators.hpp>
+#include "audio_core/dsp_interface.h"
+#include "audio_core/sink_details.h"
+#include "core/core.h"
+
+using namespace AudioCore;
+
+namespace {
+
+constexpr std::size_t CALLBACK_FRAMES = 512;
+
+/// A DSP whose audio counts up, so that the sink can tell which samples it received.
+class CountingDsp final : public DspInterface {
+public:
+    explicit CountingDsp(Core::System& system) : DspInterface(system) {
+        SetSink(SinkType::Null, "");
+    }
+
+    u16 RecvData(u32) override {
+        return 0;
+    }
+    bool RecvDataIsReady(u32) const override {
+        return false;
+    }
+    void SetSemaphore(u16) override {}
+    std::vector<u8> PipeRead(DspPipe, std::size_t) override {
+        return {};
+    }
+    std::size_t GetPipeReadableSize(DspPipe) const override {
+        return 0;
+    }
+    void PipeWrite(DspPipe, std::span<const u8>) override {}
+    std::array<u8, Memory::DSP_RAM_SIZE>& GetDspMemory() override {
+        return *dsp_memory;
+    }
+    void SetInterruptHandler(
+        std::function<void(Service::DSP::InterruptType, DspPipe)>) override {}
+    void LoadComponent(std::span<const u8>) override {}
+    void UnloadComponent() override {}
+
+    void Produce(std::size_t num_audio_frames) {
+        for (std::size_t i = 0; i < num_audio_frames; ++i) {
+            StereoFrame16 frame;
+            for (auto& sample : frame) {
+                sample = {static_cast<s16>(produced & 0x7FFF), static_cast<s16>(produced >> 15)};
+                ++produced;
+            }
+            OutputFrame(frame);
+        }
+    }
+
+    /// Runs a sink callback and returns the index of every sample it received.
+    std::vector<u32> Consume(std::size_t num_frames) {
+        std::vector<s16> buffer(2 * num_frames);
+        OutputCallback(buffer.data(), num_frames);
+
+        std::vector<u32> indices(num_frames);
+        for (std::size_t i = 0; i < num_frames; ++i) {
+            indices[i] =
+                static_cast<u32>(buffer[2 * i]) | static_cast<u32>(buffer[2 * i + 1]) << 15;
+        }
+        consumed += num_frames;
+        return indices;
+    }
+
+    u32 produced = 0;
+    std::size_t consumed = 0;
+
+private:
+    std::unique_ptr<std::array<u8, Memory::DSP_RAM_SIZE>> dsp_memory =
+        std::make_unique<std::array<u8, Memory::DSP_RAM_SIZE>>();
+};
+
+} // Anonymous namespace
+
+TEST_CASE("DSP output keeps every frame of bursty audio", "[audio_core][dsp_interface]") {
+    Core::System system;
+    CountingDsp dsp{system};
+
+    // A slow host runs several emulated video frames back to back, and the DSP produces all of
+    // their audio at once, just before the sink would run dry
+    const std::size_t burst_frames = GENERATE(4, 12, 24);
+    const std::size_t callback_frames = GENERATE(CALLBACK_FRAMES, 4 * CALLBACK_FRAMES);
+
+    u32 expected = 0;
+    while (expected < 2 * native_sample_rate) {
+        while (dsp.produced < dsp.consumed + callback_frames) {
+            dsp.Produce(burst_frames);
+        }
+        for (const u32 index : dsp.Consume(callback_frames)) {
+            REQUIRE(index == expected++);
+        }
+    }
+
+    // The sink now asks for less at a time, which lowers the limit of the queue
+    for (std::size_t callback = 0; callback < 64; ++callback) {
+        dsp.Produce(burst_frames);
+        while (dsp.consumed + CALLBACK_FRAMES / 4 <= dsp.produced) {
+            for (const u32 index : dsp.Consume(CALLBACK_FRAMES / 4)) {
+                REQUIRE(index == expected++);
+            }
+        }
+    }
+
+    REQUIRE(dsp.GetOutputStats().overruns == 0);
+    REQUIRE(dsp.GetOutputStats().underruns == 0);
+}
+
+TEST_CASE("DSP output trims a lasting backlog", "[audio_core][dsp_interface]") {
+    Core::System system;
+    CountingDsp dsp{system};
+
+    // Audio queued while the sink was not running yet is only latency from then on
+    constexpr std::size_t backlog_frames = 40;
+    dsp.Produce(backlog_frames);
+
+    u32 expected = 0;
+    u32 latency = 0;
+    while (dsp.consumed < native_sample_rate) {
+        while (dsp.produced < dsp.consumed + backlog_frames * samples_per_frame) {
+            dsp.Produce(1);
+        }
+        const auto indices = dsp.Consume(CALLBACK_FRAMES);
+        // Trimming skips whole frames of the oldest audio, and keeps the rest in order
+        REQUIRE(indices.front() >= expected);
+        REQUIRE((indices.front() - expected) % samples_per_frame == 0);
+        for (std::size_t i = 1; i < indices.size(); ++i) {
+            REQUIRE(indices[i] == indices[i - 1] + 1);
+        }
+        expected = indices.back() + 1;
+        latency = dsp.produced - expected;
+    }
+
+    REQUIRE(dsp.GetOutputStats().overruns > 0);
+    REQUIRE(dsp.GetOutputStats().underruns == 0);
+    REQUIRE(latency < backlog_frames * samples_per_frame / 2);
+}
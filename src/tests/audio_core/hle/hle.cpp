@@ -3,17 +3,109 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <algorithm>
+#include <thread>
+#include <vector>
 #include <catch2/catch_test_macros.hpp>
 #include <fmt/core.h>
 
 #include "audio_core/hle/decoder.h"
 #include "audio_core/hle/hle.h"
+#include "audio_core/hle/shared_memory.h"
 #include "audio_core/lle/lle.h"
 #include "common/common_paths.h"
 #include "common/file_util.h"
+#include "common/settings.h"
 #include "core/core.h"
 #include "core/core_timing.h"
 #include "core/memory.h"
+#include "tests/audio_core/merryhime_3ds_audio/merry_audio/merry_audio.h"
+
+namespace {
+
+/// Plays every source at once, each with its own waveform, rate, interpolation and gains, and
+/// returns the final mix of the frames rendered meanwhile.
+std::vector<std::array<s16, 2>> RenderAllSources(bool parallel_audio_mixing) {
+    using Configuration = AudioCore::HLE::SourceConfiguration::Configuration;
+    constexpr std::size_t NUM_SAMPLES = 160 * 16;
+    constexpr std::size_t NUM_FRAMES = 12;
+
+    // The setting is read when the DSP is created
+    Settings::values.parallel_audio_mixing.SetValue(parallel_audio_mixing);
+    MerryAudio::MerryAudioFixture fixture;
+    fixture.InitDspCore(Settings::AudioEmulation::HLE);
+    Settings::values.parallel_audio_mixing.SetValue(
+        Settings::values.parallel_audio_mixing.GetDefault());
+
+    // HLE does not require a valid firmware
+    auto state = fixture.audioInit({0});
+    REQUIRE(state);
+
+    state->waitForSync();
+    fixture.initSharedMem(*state);
+    // Intermediate mixes 1 and 2 reach the final mix through the aux returns
+    state->write().dsp_configuration->aux_return_volume[0] = 0.5f;
+    state->write().dsp_configuration->aux_return_volume[1] = 0.25f;
+    state->write().dsp_configuration->aux_return_volume_0_dirty.Assign(true);
+    state->write().dsp_configuration->aux_return_volume_1_dirty.Assign(true);
+    state->notifyDsp();
+    state->waitForSync();
+
+    for (std::size_t i = 0; i < AudioCore::HLE::num_sources; i++) {
+        u32* buffer = static_cast<u32*>(fixture.linearAlloc(NUM_SAMPLES * sizeof(u32)));
+        for (std::size_t sample = 0; sample < NUM_SAMPLES; sample++) {
+            const u32 data = static_cast<u32>((sample % (16 + i)) * 16);
+            buffer[sample] = (data << 16) | (data & 0xFFFF);
+        }
+
+        auto& config = state->write().source_configurations->config[i];
+        config.play_position = 0;
+        config.physical_address = fixture.osConvertVirtToPhys(buffer);
+        config.length = NUM_SAMPLES;
+        config.mono_or_stereo.Assign(i % 2 ? Configuration::MonoOrStereo::Stereo
+                                           : Configuration::MonoOrStereo::Mono);
+        config.format.Assign(Configuration::Format::PCM16);
+        config.fade_in.Assign(false);
+        config.adpcm_dirty.Assign(false);
+        config.is_looping.Assign(true);
+        config.buffer_id = 1;
+        config.partial_reset_flag.Assign(true);
+        config.play_position_dirty.Assign(true);
+        config.embedded_buffer_dirty.Assign(true);
+
+        config.interpolation_mode = static_cast<Configuration::InterpolationMode>(i % 3);
+        config.interpolation_dirty.Assign(true);
+        config.rate_multiplier = 0.5f + 0.125f * static_cast<float>(i % 8);
+        config.rate_multiplier_dirty.Assign(true);
+        for (std::size_t mix = 0; mix < 3; mix++) {
+            for (std::size_t channel = 0; channel < 4; channel++) {
+                config.gain[mix][channel] =
+                    0.25f + 0.0625f * static_cast<float>((i + mix + channel) % 5);
+            }
+        }
+        config.gain_0_dirty.Assign(true);
+        config.gain_1_dirty.Assign(true);
+        config.gain_2_dirty.Assign(true);
+
+        config.enable = true;
+        config.enable_dirty.Assign(true);
+    }
+    state->notifyDsp();
+
+    std::vector<std::array<s16, 2>> output;
+    for (std::size_t frame = 0; frame < NUM_FRAMES; frame++) {
+        state->waitForSync();
+        for (const auto& sample : state->read().final_samples->pcm16) {
+            output.push_back({sample[0], sample[1]});
+        }
+        state->notifyDsp();
+    }
+
+    fixture.audioExit(*state);
+    return output;
+}
+
+} // Anonymous namespace
 
 TEST_CASE("DSP LLE vs HLE", "[audio_core][hle]") {
     Core::System system;
@@ -140,3 +232,21 @@ TEST_CASE("DSP LLE vs HLE", "[audio_core][hle]") {
         REQUIRE(hle_read_buffer == lle_read_buffer);
     }
 }
+
+TEST_CASE("DSP HLE mixes sources in parallel like it does serially", "[audio_core][hle]") {
+    // Parallel mixing only starts workers when the host has threads to spare
+    if (std::thread::hardware_concurrency() < 4) {
+        SKIP("Test requires at least 4 host threads");
+    }
+
+    const auto serial = RenderAllSources(false);
+    const auto parallel = RenderAllSources(true);
+
+    REQUIRE(std::any_of(serial.begin(), serial.end(),
+                        [](const auto& sample) { return sample[0] != 0 || sample[1] != 0; }));
+    REQUIRE(parallel.size() == serial.size());
+    for (std::size_t i = 0; i < serial.size(); i++) {
+        INFO("sample " << i);
+        REQUIRE(parallel[i] == serial[i]);
+    }
+}
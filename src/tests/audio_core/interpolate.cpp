@@ -0,0 +1,128 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "audio_core/interpolate.h"
+
+namespace AudioCore::AudioInterp {
+
+namespace {
+using Interpolator = void (*)(State&, StereoBuffer16&, float, StereoFrame16&, std::size_t&);
+
+/// Resamples the signal, which is queued in buffers of buffer_size samples like a source does.
+std::vector<StereoBuffer16::Sample> Resample(Interpolator interpolator,
+                                             const std::vector<StereoBuffer16::Sample>& signal,
+                                             float rate, std::size_t buffer_size) {
+    State state;
+    StereoBuffer16 buffer;
+    std::size_t next = 0;
+    std::vector<StereoBuffer16::Sample> out;
+
+    while (true) {
+        StereoFrame16 frame{};
+        std::size_t position = 0;
+        while (position < frame.size()) {
+            if (buffer.empty()) {
+                if (next == signal.size()) {
+                    break;
+                }
+                const std::size_t count = std::min(buffer_size, signal.size() - next);
+                const auto samples = buffer.Reset(count);
+                std::copy_n(signal.begin() + next, count, samples.begin());
+                next += count;
+            }
+            interpolator(state, buffer, rate, frame, position);
+        }
+        out.insert(out.end(), frame.begin(), frame.begin() + position);
+        if (position < frame.size()) {
+            return out;
+        }
+    }
+}
+
+std::vector<StereoBuffer16::Sample> Sine(double cycles_per_sample, std::size_t length) {
+    std::vector<StereoBuffer16::Sample> signal(length);
+    for (std::size_t i = 0; i < length; i++) {
+        const double phase = 2 * std::numbers::pi * cycles_per_sample * static_cast<double>(i);
+        const auto value = static_cast<s16>(16000 * std::sin(phase));
+        signal[i] = {value, static_cast<s16>(-value)};
+    }
+    return signal;
+}
+
+double Rms(const std::vector<StereoBuffer16::Sample>& signal, std::size_t skip) {
+    double sum = 0;
+    for (std::size_t i = skip; i < signal.size(); i++) {
+        sum += static_cast<double>(signal[i][0]) * signal[i][0];
+    }
+    return std::sqrt(sum / (signal.size() - skip));
+}
+} // Anonymous namespace
+
+TEST_CASE("AudioInterp::Linear interpolates between adjacent samples", "[audio_core]") {
+    std::vector<StereoBuffer16::Sample> signal(1000);
+    for (std::size_t i = 0; i < signal.size(); i++) {
+        signal[i] = {static_cast<s16>(i * 37 % 4000), static_cast<s16>(-(i * 11 % 3000))};
+    }
+    const float rate = 0.7f;
+    const auto out = Resample(Linear, signal, rate, 77);
+
+    // The output is independent of how the input is split, and lags by two samples
+    const u64 step = static_cast<u64>(rate * (1 << 24));
+    REQUIRE(out.size() >= 1000 / rate - 2);
+    for (std::size_t i = 0; i < out.size(); i++) {
+        const u64 position = i * step;
+        const std::size_t index = position >> 24;
+        const u64 fraction = position & 0xFFFFFF;
+        for (std::size_t channel = 0; channel < 2; channel++) {
+            const s64 x0 = index < 2 ? 0 : signal[index - 2][channel];
+            const s64 x1 = index < 1 ? 0 : signal[index - 1][channel];
+            // The division rounds towards negative infinity
+            const auto expected =
+                static_cast<s16>(x0 + ((static_cast<s64>(fraction) * (x1 - x0)) >> 24));
+            REQUIRE(out[i][channel] == expected);
+        }
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase passes DC unchanged", "[audio_core]") {
+    const std::vector<StereoBuffer16::Sample> signal(4000, {12345, -23456});
+    for (const float rate : {0.37f, 1.0f, 1.3f, 2.5f, 6.0f}) {
+        const auto out = Resample(Polyphase, signal, rate, 300);
+        REQUIRE(out.size() >= 4000 / rate - 16);
+        // Skip the predelay and filter ramp up
+        for (std::size_t i = static_cast<std::size_t>(PolyphaseTaps / rate) + 1; i < out.size();
+             i++) {
+            REQUIRE(out[i][0] == 12345);
+            REQUIRE(out[i][1] == -23456);
+        }
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase consumes input like Linear", "[audio_core]") {
+    const auto signal = Sine(0.01, 5000);
+    for (const float rate : {0.5f, 1.0f, 3.0f}) {
+        REQUIRE(Resample(Polyphase, signal, rate, 512).size() ==
+                Resample(Linear, signal, rate, 512).size());
+    }
+}
+
+TEST_CASE("AudioInterp::Polyphase keeps the passband and rejects aliases", "[audio_core]") {
+    // A low tone keeps its level
+    const auto low = Sine(0.02, 8000);
+    const auto passed = Resample(Polyphase, low, 1.0f, 1000);
+    REQUIRE(std::abs(Rms(passed, 64) / Rms(low, 64) - 1.0) < 0.02);
+
+    // A tone above the output Nyquist frequency is attenuated when decimating
+    const auto high = Sine(0.4, 8000);
+    const double polyphase_rms = Rms(Resample(Polyphase, high, 2.0f, 1000), 64);
+    const double linear_rms = Rms(Resample(Linear, high, 2.0f, 1000), 64);
+    REQUIRE(polyphase_rms < Rms(high, 64) / 30);
+    REQUIRE(polyphase_rms < linear_rms / 10);
+}
+
+} // namespace AudioCore::AudioInterp
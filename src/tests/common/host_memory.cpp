@@ -0,0 +1,126 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#ifdef __linux__
+
+#include <cerrno>
+#include <catch2/catch_test_macros.hpp>
+#include <unistd.h>
+#include "common/host_memory.h"
+
+namespace Common {
+
+namespace {
+
+constexpr std::size_t PAGE_SIZE = 0x1000;
+constexpr std::size_t BACKING_SIZE = 4 * PAGE_SIZE;
+constexpr std::size_t ARENA_SIZE = 8 * PAGE_SIZE;
+
+/// Checks whether the byte can be read without faulting, as the kernel reports EFAULT instead.
+bool IsAccessible(const u8* pointer) {
+    int fds[2];
+    REQUIRE(pipe(fds) == 0);
+    const bool accessible = write(fds[1], pointer, 1) == 1;
+    const int error = errno;
+    close(fds[0]);
+    close(fds[1]);
+    REQUIRE((accessible || error == EFAULT));
+    return accessible;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("HostAddressSpace: Views alias the backing memory", "[common][host_memory]") {
+    HostMemory memory{BACKING_SIZE};
+    REQUIRE(memory.IsValid());
+    HostAddressSpace arena{memory, ARENA_SIZE};
+    REQUIRE(arena.IsValid());
+
+    u8* const backing = memory.BackingBasePointer();
+    u8* const base = arena.BasePointer();
+    REQUIRE(arena.Map(2 * PAGE_SIZE, PAGE_SIZE, 2 * PAGE_SIZE));
+
+    // Writes through either pointer are visible through the other
+    backing[PAGE_SIZE + 5] = 0x12;
+    REQUIRE(base[2 * PAGE_SIZE + 5] == 0x12);
+    base[4 * PAGE_SIZE - 1] = 0x34;
+    REQUIRE(backing[3 * PAGE_SIZE - 1] == 0x34);
+
+    // The same backing page can be mapped more than once
+    REQUIRE(arena.Map(7 * PAGE_SIZE, PAGE_SIZE, PAGE_SIZE));
+    base[7 * PAGE_SIZE + 5] = 0x56;
+    REQUIRE(base[2 * PAGE_SIZE + 5] == 0x56);
+    REQUIRE(backing[PAGE_SIZE + 5] == 0x56);
+
+    REQUIRE(memory.GetOffset(backing + PAGE_SIZE) == PAGE_SIZE);
+    REQUIRE_FALSE(memory.GetOffset(base).has_value());
+}
+
+TEST_CASE("HostAddressSpace: Only mapped ranges are accessible", "[common][host_memory]") {
+    HostMemory memory{BACKING_SIZE};
+    REQUIRE(memory.IsValid());
+    HostAddressSpace arena{memory, ARENA_SIZE};
+    REQUIRE(arena.IsValid());
+
+    u8* const base = arena.BasePointer();
+    for (std::size_t page = 0; page < ARENA_SIZE / PAGE_SIZE; ++page) {
+        REQUIRE_FALSE(IsAccessible(base + page * PAGE_SIZE));
+    }
+
+    REQUIRE(arena.Map(PAGE_SIZE, 0, 3 * PAGE_SIZE));
+    REQUIRE_FALSE(IsAccessible(base));
+    REQUIRE(IsAccessible(base + PAGE_SIZE));
+    REQUIRE(IsAccessible(base + 4 * PAGE_SIZE - 1));
+    REQUIRE_FALSE(IsAccessible(base + 4 * PAGE_SIZE));
+
+    // Unmapping part of a view leaves the rest of it in place
+    REQUIRE(arena.Unmap(2 * PAGE_SIZE, PAGE_SIZE));
+    REQUIRE(IsAccessible(base + PAGE_SIZE));
+    REQUIRE_FALSE(IsAccessible(base + 2 * PAGE_SIZE));
+    REQUIRE(IsAccessible(base + 3 * PAGE_SIZE));
+
+    // The backing memory is not affected
+    memory.BackingBasePointer()[PAGE_SIZE] = 0x78;
+    REQUIRE(IsAccessible(memory.BackingBasePointer() + PAGE_SIZE));
+
+    REQUIRE(arena.Unmap(0, ARENA_SIZE));
+    for (std::size_t page = 0; page < ARENA_SIZE / PAGE_SIZE; ++page) {
+        REQUIRE_FALSE(IsAccessible(base + page * PAGE_SIZE));
+    }
+}
+
+TEST_CASE("HostAddressSpace: Remapping replaces the view", "[common][host_memory]") {
+    HostMemory memory{BACKING_SIZE};
+    REQUIRE(memory.IsValid());
+    HostAddressSpace arena{memory, ARENA_SIZE};
+    REQUIRE(arena.IsValid());
+
+    u8* const backing = memory.BackingBasePointer();
+    u8* const base = arena.BasePointer();
+    for (std::size_t page = 0; page < BACKING_SIZE / PAGE_SIZE; ++page) {
+        backing[page * PAGE_SIZE] = static_cast<u8>(page + 1);
+    }
+
+    REQUIRE(arena.Map(0, 0, 2 * PAGE_SIZE));
+    REQUIRE(base[0] == 1);
+    REQUIRE(base[PAGE_SIZE] == 2);
+
+    // Remapping over part of an existing view, without unmapping it first
+    REQUIRE(arena.Map(PAGE_SIZE, 3 * PAGE_SIZE, PAGE_SIZE));
+    REQUIRE(base[0] == 1);
+    REQUIRE(base[PAGE_SIZE] == 4);
+
+    base[PAGE_SIZE] = 0x9A;
+    REQUIRE(backing[3 * PAGE_SIZE] == 0x9A);
+    REQUIRE(backing[PAGE_SIZE] == 2);
+
+    // Mapping an unmapped range again
+    REQUIRE(arena.Unmap(0, PAGE_SIZE));
+    REQUIRE(arena.Map(0, 2 * PAGE_SIZE, PAGE_SIZE));
+    REQUIRE(base[0] == 3);
+}
+
+} // namespace Common
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <array>
+#include <numeric>
+#include <catch2/catch_test_macros.hpp>
+#include "common/ring_buffer.h"
+
+namespace Common {
+
+TEST_CASE("RingBuffer: Peek wraps around the end", "[common]") {
+    RingBuffer<s16, 8, 2> buffer;
+    std::array<s16, 12> input;
+    std::iota(input.begin(), input.end(), 0);
+
+    // Move the read position near the end
+    REQUIRE(buffer.Push(input.data(), 6) == 6);
+    REQUIRE(buffer.Discard(6) == 6);
+    REQUIRE(buffer.Size() == 0);
+
+    REQUIRE(buffer.Push(input.data(), 5) == 5);
+    const auto regions = buffer.Peek();
+    REQUIRE(regions[0].size() == 4);
+    REQUIRE(regions[1].size() == 6);
+    REQUIRE(regions[0][0] == 0);
+    REQUIRE(regions[0][3] == 3);
+    REQUIRE(regions[1][0] == 4);
+    REQUIRE(regions[1][5] == 9);
+
+    // Peeking does not pop
+    REQUIRE(buffer.Size() == 5);
+    REQUIRE(buffer.Peek(1)[0].size() == 2);
+    REQUIRE(buffer.Peek(1)[1].empty());
+
+    REQUIRE(buffer.Discard(3) == 3);
+    std::array<s16, 4> output{};
+    REQUIRE(buffer.Pop(output.data(), 8) == 2);
+    REQUIRE(output == std::array<s16, 4>{6, 7, 8, 9});
+    REQUIRE(buffer.Discard(1) == 0);
+}
+
+} // namespace Common
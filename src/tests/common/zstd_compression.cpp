@@ -0,0 +1,62 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+#include "common/file_util.h"
+#include "common/zstd_compression.h"
+
+TEST_CASE("ZSTD stream buffers round trip", "[common]") {
+    const std::string path =
+        (std::filesystem::temp_directory_path() / "borked3ds_zstd_stream_test.bin").string();
+
+    // Larger than the chunk size to exercise the unbuffered path
+    std::vector<u8> large(4 * 1024 * 1024 + 123);
+    for (std::size_t i = 0; i < large.size(); ++i) {
+        large[i] = static_cast<u8>((i * 7) ^ (i >> 12));
+    }
+    const std::string small = "savestate";
+    constexpr u32 header = 0xC0FFEE;
+
+    {
+        FileUtil::IOFile file(path, "wb");
+        REQUIRE(file.WriteBytes(&header, sizeof(header)) == sizeof(header));
+        Common::Compression::ZSTDOutputBuffer buffer{file};
+        std::ostream stream{&buffer};
+        for (int i = 0; i < 1000; ++i) {
+            stream.write(small.data(), small.size());
+        }
+        stream.write(reinterpret_cast<const char*>(large.data()), large.size());
+        stream.put('!');
+        REQUIRE(stream.good());
+        REQUIRE(buffer.Finish());
+    }
+
+    {
+        FileUtil::IOFile file(path, "rb");
+        u32 read_header{};
+        REQUIRE(file.ReadBytes(&read_header, sizeof(read_header)) == sizeof(read_header));
+        REQUIRE(read_header == header);
+        Common::Compression::ZSTDInputBuffer buffer{file};
+        std::istream stream{&buffer};
+        std::string read_small(small.size(), '\0');
+        for (int i = 0; i < 1000; ++i) {
+            stream.read(read_small.data(), read_small.size());
+            REQUIRE(read_small == small);
+        }
+        std::vector<u8> read_large(large.size());
+        stream.read(reinterpret_cast<char*>(read_large.data()), read_large.size());
+        REQUIRE(read_large == large);
+        REQUIRE(stream.get() == '!');
+        REQUIRE(stream.get() == std::char_traits<char>::eof());
+    }
+
+    FileUtil::Delete(path);
+}
@@ -2,6 +2,7 @@
 // Licensed under GPLv2+
 // Refer to the license.txt file included.
 
+#include <catch2/benchmark/catch_benchmark.hpp>
 #include <catch2/catch_test_macros.hpp>
 
 #include <array>
@@ -196,4 +197,78 @@ TEST_CASE("CoreTiming[ChainScheduling]", "[core]") {
     REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
 }
 
+TEST_CASE("CoreTiming[Unschedule]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+    Core::TimingEventType* cb_b = timing.RegisterEvent("callbackB", CallbackTemplate<1>);
+    Core::TimingEventType* cb_c = timing.RegisterEvent("callbackC", CallbackTemplate<2>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0);
+    timing.ScheduleEvent(200, cb_b, CB_IDS[1], 0);
+    timing.ScheduleEvent(300, cb_b, CB_IDS[3], 0);
+    timing.ScheduleEvent(400, cb_c, CB_IDS[2], 0);
+    timing.ScheduleEvent(500, cb_c, CB_IDS[4], 0);
+
+    // Cancel a single event by user data and every event of another type
+    timing.UnscheduleEvent(cb_b, CB_IDS[3]);
+    timing.RemoveEvent(cb_c);
+    REQUIRE(100 == timing.GetTimer(0)->GetDowncount());
+
+    AdvanceAndCheck(timing, 0, 100); // cb_a
+    AdvanceAndCheck(timing, 1, MAX_SLICE_LENGTH); // cb_b
+}
+
+TEST_CASE("CoreTiming[UnscheduleThreadSafe]", "[core]") {
+    Core::Timing timing(1, 100);
+
+    Core::TimingEventType* cb_a = timing.RegisterEvent("callbackA", CallbackTemplate<0>);
+
+    // Enter slice 0
+    timing.GetTimer(0)->Advance();
+    timing.GetTimer(0)->SetNextSlice();
+
+    // Events still waiting in the thread-safe queue must be cancellable as well
+    timing.ScheduleEvent(100, cb_a, CB_IDS[0], 0, true);
+    timing.UnscheduleEvent(cb_a, CB_IDS[0]);
+
+    callbacks_ran_flags = 0;
+    for (int slice = 0; slice < 4; ++slice) {
+        timing.GetTimer(0)->AddTicks(timing.GetTimer(0)->GetDowncount());
+        timing.GetTimer(0)->Advance();
+        timing.GetTimer(0)->SetNextSlice();
+        REQUIRE(MAX_SLICE_LENGTH == timing.GetTimer(0)->GetDowncount());
+    }
+    REQUIRE(callbacks_ran_flags.none());
+}
+
+TEST_CASE("CoreTiming[UnscheduleBenchmark]", "[core][.benchmark]") {
+    constexpr std::size_t NUM_EVENTS = 4096;
+
+    Core::Timing timing(1, 100);
+    std::array<Core::TimingEventType*, 16> event_types;
+    for (std::size_t i = 0; i < event_types.size(); ++i) {
+        event_types[i] =
+            timing.RegisterEvent("benchEvent" + std::to_string(i), [](std::uintptr_t, s64) {});
+    }
+
+    // Keep a large queue alive and churn schedule/unschedule pairs against it
+    for (std::size_t i = 0; i < NUM_EVENTS; ++i) {
+        timing.ScheduleEvent(static_cast<s64>(1000 + i), event_types[i % event_types.size()], i,
+                             0);
+    }
+
+    std::uintptr_t next_id = NUM_EVENTS;
+    BENCHMARK("Schedule + Unschedule") {
+        Core::TimingEventType* event_type = event_types[next_id % event_types.size()];
+        timing.ScheduleEvent(static_cast<s64>(500 + next_id % 1000), event_type, next_id, 0);
+        timing.UnscheduleEvent(event_type, next_id);
+        return ++next_id;
+    };
+}
+
 // TODO: Add tests for multiple timers
@@ -0,0 +1,150 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <filesystem>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/file_sys/artic_disk_cache.h"
+
+namespace FileSys {
+
+namespace {
+constexpr std::size_t BlockSize = ArticDiskCache::BlockSize;
+
+/// Stand-in for the FSFILE_Read endpoint of an Artic Base server, serving a file from memory.
+struct StandInArticServer {
+    explicit StandInArticServer(std::size_t size, u8 seed = 0) : data(size) {
+        for (std::size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<u8>(i * 7 + i / BlockSize + seed);
+        }
+    }
+
+    ArticDiskCache::FetchFunction Fetch() {
+        return [this](u8* buffer, std::size_t length, std::size_t offset) {
+            requests++;
+            length = std::min(length, data.size() - offset);
+            std::copy_n(data.begin() + offset, length, buffer);
+            return ResultVal<std::size_t>{length};
+        };
+    }
+
+    ArticDiskCache::Identity Identity(u16 content_version = 0) const {
+        return ArticDiskCache::Identity{
+            .title_id = 0x0004000000123400,
+            .content_version = content_version,
+            .is_update = false,
+            .data_size = data.size(),
+            .content_hash = ArticDiskCache::HashContent(data.data(), data.size()),
+        };
+    }
+
+    std::vector<u8> data;
+    u32 requests = 0;
+};
+
+std::string TempPath() {
+    const auto path = std::filesystem::temp_directory_path() / "borked3ds_artic_disk_cache.bin";
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+std::vector<u8> Read(ArticDiskCache& cache, StandInArticServer& server, std::size_t offset,
+                     std::size_t length) {
+    std::vector<u8> buffer(length);
+    auto res = cache.Read(offset, length, buffer.data(), server.Fetch());
+    REQUIRE(res.Succeeded());
+    buffer.resize(res.Unwrap());
+    return buffer;
+}
+
+bool Matches(const StandInArticServer& server, std::size_t offset, const std::vector<u8>& data) {
+    return std::equal(data.begin(), data.end(), server.data.begin() + offset);
+}
+} // Anonymous namespace
+
+TEST_CASE("ArticDiskCache[ReadThrough]", "[core][file_sys]") {
+    const std::string path = TempPath();
+    StandInArticServer server(BlockSize * 10 + 100);
+    ArticDiskCache cache(path, server.Identity(), 1024 * 1024);
+    REQUIRE(cache.IsValid());
+
+    // Missing blocks are fetched with a single request and stored
+    auto data = Read(cache, server, 100, BlockSize * 2);
+    REQUIRE(data.size() == BlockSize * 2);
+    REQUIRE(Matches(server, 100, data));
+    REQUIRE(server.requests == 1);
+    REQUIRE(cache.Contains(0, BlockSize * 3));
+
+    data = Read(cache, server, 50, BlockSize * 2 + 10);
+    REQUIRE(Matches(server, 50, data));
+    REQUIRE(server.requests == 1);
+
+    // Reads at the end are short
+    data = Read(cache, server, BlockSize * 10, BlockSize);
+    REQUIRE(data.size() == 100);
+    REQUIRE(Matches(server, BlockSize * 10, data));
+    REQUIRE(server.requests == 2);
+    REQUIRE(Read(cache, server, BlockSize * 11, 10).empty());
+
+    const auto stats = cache.GetStats();
+    REQUIRE(stats.misses == 4);
+    REQUIRE(stats.hits == 3);
+    REQUIRE(stats.blocks == 4);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("ArticDiskCache[Persistence]", "[core][file_sys]") {
+    const std::string path = TempPath();
+    StandInArticServer server(BlockSize * 8);
+    {
+        ArticDiskCache cache(path, server.Identity(), 1024 * 1024);
+        REQUIRE(Matches(server, 0, Read(cache, server, 0, BlockSize * 8)));
+        REQUIRE(server.requests == 1);
+    }
+
+    // A later session reads everything from disk
+    {
+        ArticDiskCache cache(path, server.Identity(), 1024 * 1024);
+        REQUIRE(cache.GetStats().blocks == 8);
+        REQUIRE(Matches(server, 0, Read(cache, server, 0, BlockSize * 8)));
+        REQUIRE(server.requests == 1);
+    }
+
+    // The file is discarded once the content changed on the console
+    StandInArticServer updated(BlockSize * 8, 1);
+    {
+        ArticDiskCache cache(path, updated.Identity(1), 1024 * 1024);
+        REQUIRE(cache.GetStats().blocks == 0);
+        REQUIRE(Matches(updated, 0, Read(cache, updated, 0, BlockSize * 8)));
+        REQUIRE(updated.requests == 1);
+    }
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("ArticDiskCache[Bounded]", "[core][file_sys]") {
+    const std::string path = TempPath();
+    StandInArticServer server(BlockSize * 16);
+    ArticDiskCache cache(path, server.Identity(), BlockSize * 4);
+    REQUIRE(std::filesystem::file_size(path) <= BlockSize * 6);
+
+    for (std::size_t block = 0; block < 16; ++block) {
+        REQUIRE(Matches(server, block * BlockSize, Read(cache, server, block * BlockSize, 16)));
+    }
+    const auto stats = cache.GetStats();
+    REQUIRE(stats.blocks == 4);
+    REQUIRE(stats.evictions == 12);
+
+    // The oldest blocks were replaced first
+    for (std::size_t block = 0; block < 12; ++block) {
+        REQUIRE(!cache.Contains(block * BlockSize, 1));
+    }
+    REQUIRE(cache.Contains(BlockSize * 12, BlockSize * 4));
+
+    std::filesystem::remove(path);
+}
+
+} // namespace FileSys
@@ -0,0 +1,99 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/file_sys/romfs_page_cache.h"
+
+namespace FileSys {
+
+namespace {
+constexpr std::size_t PageSize = RomFSPageCache::PageSize;
+
+std::vector<u8> MakePage(std::size_t page, std::size_t size = PageSize) {
+    std::vector<u8> data(size);
+    for (std::size_t i = 0; i < size; ++i) {
+        data[i] = static_cast<u8>(page / PageSize * 31 + i);
+    }
+    return data;
+}
+} // Anonymous namespace
+
+TEST_CASE("RomFSPageCache[HitMiss]", "[core][file_sys]") {
+    RomFSPageCache cache(1024 * 1024);
+    std::array<u8, 16> buffer{};
+
+    REQUIRE(!cache.Read(0, 0, buffer.size(), buffer.data()));
+    REQUIRE(!cache.Contains(0));
+
+    const auto page = MakePage(PageSize * 3);
+    cache.Insert(PageSize * 3, page);
+    REQUIRE(cache.Contains(PageSize * 3));
+    REQUIRE(cache.Read(PageSize * 3, 100, buffer.size(), buffer.data()) == buffer.size());
+    REQUIRE(std::equal(buffer.begin(), buffer.end(), page.begin() + 100));
+
+    // Pages at the end of the file may be short
+    const auto short_page = MakePage(PageSize * 4, 50);
+    cache.Insert(PageSize * 4, short_page);
+    REQUIRE(cache.Read(PageSize * 4, 40, buffer.size(), buffer.data()) == 10);
+    REQUIRE(std::equal(buffer.begin(), buffer.begin() + 10, short_page.begin() + 40));
+    REQUIRE(cache.Read(PageSize * 4, 60, buffer.size(), buffer.data()) == 0);
+
+    cache.Clear();
+    REQUIRE(!cache.Contains(PageSize * 3));
+}
+
+TEST_CASE("RomFSPageCache[Eviction]", "[core][file_sys]") {
+    // One page per shard
+    RomFSPageCache cache(PageSize * RomFSPageCache::NumShards);
+    REQUIRE(cache.GetCapacity() == RomFSPageCache::NumShards);
+
+    const std::size_t stride = PageSize * RomFSPageCache::NumShards;
+    cache.Insert(0, MakePage(0));
+    cache.Insert(PageSize, MakePage(PageSize));
+    cache.Insert(stride, MakePage(stride));
+    REQUIRE(!cache.Contains(0));
+    REQUIRE(cache.Contains(PageSize));
+    REQUIRE(cache.Contains(stride));
+
+    RomFSPageCache disabled(0);
+    disabled.Insert(0, MakePage(0));
+    REQUIRE(!disabled.Contains(0));
+}
+
+TEST_CASE("RomFSPageCache[Concurrent]", "[core][file_sys]") {
+    constexpr std::size_t NumPages = 256;
+    RomFSPageCache cache(PageSize * 64);
+
+    std::vector<std::thread> threads;
+    std::array<bool, 4> valid{};
+    for (std::size_t t = 0; t < valid.size(); ++t) {
+        threads.emplace_back([&cache, &valid, t] {
+            std::array<u8, 64> buffer;
+            bool ok = true;
+            for (std::size_t i = 0; i < 20000; ++i) {
+                const std::size_t page = ((i * 7 + t * 13) % NumPages) * PageSize;
+                const auto expected = MakePage(page);
+                if (const auto read = cache.Read(page, 64, buffer.size(), buffer.data())) {
+                    ok &= *read == buffer.size() &&
+                          std::equal(buffer.begin(), buffer.end(), expected.begin() + 64);
+                } else {
+                    cache.Insert(page, expected);
+                }
+            }
+            valid[t] = ok;
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (const bool ok : valid) {
+        REQUIRE(ok);
+    }
+}
+
+} // namespace FileSys
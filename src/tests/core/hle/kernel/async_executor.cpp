@@ -0,0 +1,161 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/kernel/async_executor.h"
+
+namespace Kernel {
+
+TEST_CASE("AsyncExecutor runs queued tasks", "[core][kernel]") {
+    AsyncExecutor executor;
+    std::atomic<int> count{0};
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 100; i++) {
+        futures.push_back(executor.Run(AsyncQueue::FileSystem, [&count] { ++count; }));
+    }
+    for (auto& future : futures) {
+        future.wait();
+    }
+    REQUIRE(count == 100);
+
+    const auto stats = executor.GetStats(AsyncQueue::FileSystem);
+    REQUIRE(stats.completed == 100);
+    REQUIRE(stats.cancelled == 0);
+    REQUIRE(stats.depth == 0);
+    REQUIRE(stats.workers >= 1);
+    REQUIRE(stats.workers <= 4);
+
+    // Queues are independent
+    REQUIRE(executor.GetStats(AsyncQueue::Socket).completed == 0);
+}
+
+TEST_CASE("AsyncExecutor runs blocking tasks of a queue concurrently", "[core][kernel]") {
+    AsyncExecutor executor;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> started{0};
+
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 4; i++) {
+        futures.push_back(executor.Run(AsyncQueue::Socket, [&started, released] {
+            ++started;
+            released.wait();
+        }));
+    }
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (started < 4 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+    REQUIRE(started == 4);
+
+    release.set_value();
+    for (auto& future : futures) {
+        future.wait();
+    }
+    REQUIRE(executor.GetStats(AsyncQueue::Socket).workers == 4);
+}
+
+TEST_CASE("AsyncExecutor runs tasks inline when the queue is full", "[core][kernel]") {
+    AsyncExecutor executor;
+    std::promise<void> release;
+    std::promise<void> running;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> started{0};
+    std::atomic<int> count{0};
+
+    // Occupy both install workers, then fill the install queue
+    std::vector<std::future<void>> futures;
+    for (int i = 0; i < 2; i++) {
+        futures.push_back(executor.Run(AsyncQueue::Install, [&, released] {
+            if (++started == 2) {
+                running.set_value();
+            }
+            released.wait();
+        }));
+    }
+    running.get_future().wait();
+    for (int i = 0; i < 64; i++) {
+        futures.push_back(executor.Run(AsyncQueue::Install, [&count] { ++count; }));
+    }
+    REQUIRE(executor.GetStats(AsyncQueue::Install).depth == 64);
+
+    // The next task must not wait for the blocked workers
+    std::thread::id ran_on;
+    auto overflow = executor.Run(AsyncQueue::Install, [&ran_on] {
+        ran_on = std::this_thread::get_id();
+    });
+    REQUIRE(overflow.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(ran_on == std::this_thread::get_id());
+    REQUIRE(count == 0);
+
+    auto stats = executor.GetStats(AsyncQueue::Install);
+    REQUIRE(stats.ran_inline == 1);
+    REQUIRE(stats.completed == 1);
+    REQUIRE(stats.depth == 64);
+
+    release.set_value();
+    for (auto& future : futures) {
+        future.wait();
+    }
+    REQUIRE(count == 64);
+    stats = executor.GetStats(AsyncQueue::Install);
+    REQUIRE(stats.completed == 67);
+    REQUIRE(stats.ran_inline == 1);
+}
+
+TEST_CASE("AsyncExecutor::Shutdown cancels pending tasks", "[core][kernel]") {
+    AsyncExecutor executor;
+    std::promise<void> release;
+    std::promise<void> running;
+    std::atomic<int> count{0};
+
+    // Occupy both install workers so that later tasks stay queued
+    std::vector<std::future<void>> futures;
+    std::shared_future<void> released = release.get_future().share();
+    std::atomic<int> started{0};
+    for (int i = 0; i < 2; i++) {
+        futures.push_back(executor.Run(AsyncQueue::Install, [&, released] {
+            if (++started == 2) {
+                running.set_value();
+            }
+            released.wait();
+        }));
+    }
+    running.get_future().wait();
+    for (int i = 0; i < 10; i++) {
+        futures.push_back(executor.Run(AsyncQueue::Install, [&count] { ++count; }));
+    }
+    REQUIRE(executor.GetStats(AsyncQueue::Install).depth == 10);
+
+    // Only let the running tasks finish once the queued ones have been dropped
+    std::thread shutdown{[&executor] { executor.Shutdown(); }};
+    while (executor.GetStats(AsyncQueue::Install).cancelled < 10) {
+        std::this_thread::yield();
+    }
+    release.set_value();
+    shutdown.join();
+
+    // Every future is ready, but none of the queued tasks ran
+    for (auto& future : futures) {
+        REQUIRE(future.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    }
+    REQUIRE(count == 0);
+    const auto stats = executor.GetStats(AsyncQueue::Install);
+    REQUIRE(stats.completed == 2);
+    REQUIRE(stats.cancelled == 10);
+
+    // Tasks submitted after shutdown are cancelled right away
+    auto late = executor.Run(AsyncQueue::Install, [&count] { ++count; });
+    REQUIRE(late.wait_for(std::chrono::seconds(0)) == std::future_status::ready);
+    REQUIRE(count == 0);
+    REQUIRE(executor.GetStats(AsyncQueue::Install).cancelled == 11);
+}
+
+} // namespace Kernel
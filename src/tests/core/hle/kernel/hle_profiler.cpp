@@ -0,0 +1,90 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+#include <catch2/catch_test_macros.hpp>
+#include "core/hle/kernel/hle_profiler.h"
+
+namespace Kernel {
+
+using namespace std::chrono_literals;
+
+TEST_CASE("HLEProfiler buckets are log-linear", "[core][kernel]") {
+    // Small values get a bucket each
+    for (u64 ns = 0; ns < 4; ns++) {
+        REQUIRE(HLEProfiler::BucketIndex(ns) == ns);
+    }
+
+    // Every bucket starts where the previous one ends
+    for (std::size_t i = 1; i < HLEProfiler::NumBuckets; i++) {
+        const u64 lower = HLEProfiler::BucketLowerBound(i);
+        REQUIRE(lower > HLEProfiler::BucketLowerBound(i - 1));
+        REQUIRE(HLEProfiler::BucketIndex(lower) == i);
+        REQUIRE(HLEProfiler::BucketIndex(lower - 1) == i - 1);
+    }
+
+    // Buckets are at most a quarter of their value wide
+    REQUIRE(HLEProfiler::BucketLowerBound(HLEProfiler::BucketIndex(1000)) > 750);
+    REQUIRE(HLEProfiler::BucketIndex(~u64{0}) == HLEProfiler::NumBuckets - 1);
+}
+
+TEST_CASE("HLEProfiler records SVCs and commands", "[core][kernel]") {
+    HLEProfiler profiler;
+    REQUIRE_FALSE(profiler.IsEnabled());
+
+    const u32 slot = HLEProfiler::RegisterCommand("test:PROF", 0x0001, "First");
+    REQUIRE(slot != HLEProfiler::InvalidSlot);
+    REQUIRE(HLEProfiler::RegisterCommand("test:PROF", 0x0001, "First") == slot);
+    REQUIRE(HLEProfiler::RegisterCommand("test:PROF", 0x0002, "Second") != slot);
+
+    profiler.RecordSVC(0x32, "SendSyncRequest", 1000ns);
+    profiler.RecordSVC(0x32, "SendSyncRequest", 3000ns);
+    profiler.RecordCommand(slot, 500ns);
+    // Calls from other threads are merged
+    std::thread{[&] { profiler.RecordCommand(slot, 700ns); }}.join();
+
+    const auto stats = profiler.GetStats();
+    REQUIRE(stats.size() == 2);
+
+    REQUIRE(stats[0].service.empty());
+    REQUIRE(stats[0].name == "SendSyncRequest");
+    REQUIRE(stats[0].id == 0x32);
+    REQUIRE(stats[0].count == 2);
+    REQUIRE(stats[0].total_ns == 4000);
+    REQUIRE(stats[0].max_ns == 3000);
+    REQUIRE(stats[0].Percentile(0.4) < 1250);
+    REQUIRE(stats[0].Percentile(0.99) == 3000);
+
+    REQUIRE(stats[1].service == "test:PROF");
+    REQUIRE(stats[1].name == "First");
+    REQUIRE(stats[1].id == 0x0001);
+    REQUIRE(stats[1].count == 2);
+    REQUIRE(stats[1].total_ns == 1200);
+    REQUIRE(stats[1].max_ns == 700);
+
+    profiler.Reset();
+    REQUIRE(profiler.GetStats().empty());
+}
+
+TEST_CASE("HLEProfiler dumps JSON and CSV", "[core][kernel]") {
+    HLEProfiler profiler;
+    profiler.SetEnabled(true);
+    const u32 slot = HLEProfiler::RegisterCommand("test:DUMP", 0x0803, "OpenFile");
+    profiler.RecordSVC(0x0A, "SleepThread", 100ns);
+    profiler.RecordCommand(slot, 2000ns);
+
+    const std::string json = profiler.Dump(HLEProfiler::Format::Json);
+    REQUIRE(json.find(R"("enabled":true)") != std::string::npos);
+    REQUIRE(json.find(R"("name":"SleepThread")") != std::string::npos);
+    REQUIRE(json.find(R"("service":"test:DUMP")") != std::string::npos);
+    REQUIRE(json.find(R"("histogram":[[1792,1]])") != std::string::npos);
+
+    const std::string csv = profiler.Dump(HLEProfiler::Format::Csv);
+    REQUIRE(csv.starts_with("service,id,name,count,total_ns,"));
+    REQUIRE(csv.find("\nsvc,0xA,SleepThread,1,100,100,100,") != std::string::npos);
+    REQUIRE(csv.find("\ntest:DUMP,0x803,OpenFile,1,2000,2000,2000,") != std::string::npos);
+}
+
+} // namespace Kernel
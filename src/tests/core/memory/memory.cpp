@@ -56,3 +56,56 @@ TEST_CASE("memory.IsValidVirtualAddress", "[core][memory]") {
         CHECK(memory.IsValidVirtualAddress(*process, Memory::CONFIG_MEMORY_VADDR) == false);
     }
 }
+
+TEST_CASE("memory.GetContiguousSpan", "[core][memory]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.MapSharedPages(process->vm_manager);
+
+    SECTION("a mapped block is accessed in place") {
+        const VAddr address = Memory::SHARED_PAGE_VADDR + 0x80;
+        const auto span = memory.GetContiguousSpan(*process, address, 0x120);
+        REQUIRE(span.size() == 0x120);
+
+        span[0] = 0x12;
+        span[0x11F] = 0x34;
+        u8 first = 0;
+        u8 last = 0;
+        memory.ReadBlock(*process, address, &first, 1);
+        memory.ReadBlock(*process, address + 0x11F, &last, 1);
+        CHECK(first == 0x12);
+        CHECK(last == 0x34);
+    }
+
+    SECTION("blocks touching unmapped pages have no span") {
+        CHECK(memory.GetContiguousSpan(*process, Memory::HEAP_VADDR, 4).empty());
+        const VAddr end = Memory::SHARED_PAGE_VADDR + Memory::SHARED_PAGE_SIZE;
+        CHECK(memory.GetContiguousSpan(*process, end - 4, 8).empty());
+    }
+
+    SECTION("empty blocks have no span") {
+        CHECK(memory.GetContiguousSpan(*process, Memory::SHARED_PAGE_VADDR, 0).empty());
+    }
+
+    SECTION("blocks past the end of the address space have no span") {
+        // Back the last two pages of the address space with contiguous memory
+        auto& page_table = *process->vm_manager.page_table;
+        constexpr VAddr top = 0xFFFFE000;
+        for (u32 i = 0; i < 2; i++) {
+            const std::size_t page = (top >> Memory::BORKED3DS_PAGE_BITS) + i;
+            page_table.pointers[page] = memory.GetFCRAMRef(i * Memory::BORKED3DS_PAGE_SIZE);
+            page_table.attributes[page] = Memory::PageType::Memory;
+        }
+
+        CHECK(memory.GetContiguousSpan(*process, top, 0x2000).size() == 0x2000);
+        CHECK(memory.GetContiguousSpan(*process, 0xFFFFFFFF, 1).size() == 1);
+        CHECK(memory.GetContiguousSpan(*process, top, 0x2001).empty());
+        CHECK(memory.GetContiguousSpan(*process, 0xFFFFFFFF, 2).empty());
+        CHECK(memory.GetContiguousSpan(*process, top, std::size_t{1} << 40).empty());
+    }
+}
@@ -3,6 +3,7 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <chrono>
 #include <catch2/catch_test_macros.hpp>
 #include "core/core.h"
 #include "core/core_timing.h"
@@ -153,3 +154,142 @@ TEST_CASE("Memory Basics", "[kernel][memory]") {
         REQUIRE(code == ResultSuccess);
     }
 }
+
+namespace {
+/// Checks that the areas cover the address space and that no two neighbours could be merged.
+bool IsWellFormed(const Kernel::VMManager& manager) {
+    VAddr expected_base = 0;
+    const Kernel::VirtualMemoryArea* prev = nullptr;
+    for (const auto& [base, vma] : manager.vma_map) {
+        if (base != vma.base || vma.base != expected_base || vma.size == 0) {
+            return false;
+        }
+        if (prev && prev->CanBeMergedWith(vma)) {
+            return false;
+        }
+        expected_base += vma.size;
+        prev = &vma;
+    }
+    return expected_base == Kernel::VMManager::MAX_ADDRESS;
+}
+} // Anonymous namespace
+
+TEST_CASE("VMManager splits and merges areas", "[kernel][memory]") {
+    constexpr u32 num_pages = 64;
+    auto mem = std::make_shared<BufferMem>(num_pages * Memory::BORKED3DS_PAGE_SIZE);
+    MemoryRef block{mem};
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    Kernel::Process process(kernel);
+    // Because of the PageTable, Kernel::VMManager is too big to be created on the stack.
+    auto manager = std::make_unique<Kernel::VMManager>(memory, process);
+
+    // Pages mapped in order from one block merge into a single area
+    for (u32 i = 0; i < num_pages; i++) {
+        const u32 offset = i * Memory::BORKED3DS_PAGE_SIZE;
+        auto result = manager->MapBackingMemory(Memory::HEAP_VADDR + offset, block + offset,
+                                                Memory::BORKED3DS_PAGE_SIZE,
+                                                Kernel::MemoryState::Private);
+        REQUIRE(result.Code() == ResultSuccess);
+    }
+    REQUIRE(manager->vma_map.size() == 3);
+    REQUIRE(IsWellFormed(*manager));
+
+    // Every other page gets its own area
+    for (u32 i = 0; i < num_pages; i += 2) {
+        const Result code =
+            manager->ReprotectRange(Memory::HEAP_VADDR + i * Memory::BORKED3DS_PAGE_SIZE,
+                                    Memory::BORKED3DS_PAGE_SIZE, Kernel::VMAPermission::Read);
+        REQUIRE(code == ResultSuccess);
+    }
+    REQUIRE(manager->vma_map.size() == num_pages + 2);
+    REQUIRE(IsWellFormed(*manager));
+
+    auto vma = manager->FindVMA(Memory::HEAP_VADDR + 3 * Memory::BORKED3DS_PAGE_SIZE + 5);
+    REQUIRE(vma != manager->vma_map.end());
+    CHECK(vma->second.base == Memory::HEAP_VADDR + 3 * Memory::BORKED3DS_PAGE_SIZE);
+    CHECK(vma->second.permissions == Kernel::VMAPermission::ReadWrite);
+    CHECK(vma->second.backing_memory.GetPtr() ==
+          block.GetPtr() + 3 * Memory::BORKED3DS_PAGE_SIZE);
+
+    // Restoring the permissions merges them back
+    Result code =
+        manager->ReprotectRange(Memory::HEAP_VADDR, num_pages * Memory::BORKED3DS_PAGE_SIZE,
+                                Kernel::VMAPermission::ReadWrite);
+    REQUIRE(code == ResultSuccess);
+    REQUIRE(manager->vma_map.size() == 3);
+    REQUIRE(IsWellFormed(*manager));
+
+    // Unmapping the middle of the block splits it, unmapping the rest frees the whole space
+    code = manager->UnmapRange(Memory::HEAP_VADDR + Memory::BORKED3DS_PAGE_SIZE,
+                               Memory::BORKED3DS_PAGE_SIZE);
+    REQUIRE(code == ResultSuccess);
+    REQUIRE(manager->vma_map.size() == 5);
+    REQUIRE(IsWellFormed(*manager));
+
+    code = manager->UnmapRange(Memory::HEAP_VADDR, Memory::BORKED3DS_PAGE_SIZE);
+    REQUIRE(code == ResultSuccess);
+    code = manager->UnmapRange(Memory::HEAP_VADDR + 2 * Memory::BORKED3DS_PAGE_SIZE,
+                               (num_pages - 2) * Memory::BORKED3DS_PAGE_SIZE);
+    REQUIRE(code == ResultSuccess);
+    REQUIRE(manager->vma_map.size() == 1);
+    REQUIRE(IsWellFormed(*manager));
+}
+
+TEST_CASE("VMManager performance", "[kernel][memory][.benchmark]") {
+    constexpr u32 num_regions = 4096;
+    auto mem = std::make_shared<BufferMem>(num_regions * Memory::BORKED3DS_PAGE_SIZE);
+    MemoryRef block{mem};
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    Kernel::Process process(kernel);
+    auto manager = std::make_unique<Kernel::VMManager>(memory, process);
+
+    // Maps many small regions with gaps in between, like a homebrew or plugin loader would, then
+    // looks them up, reprotects and unmaps them.
+    const auto address = [](u32 i) {
+        return Memory::HEAP_VADDR + 2 * i * Memory::BORKED3DS_PAGE_SIZE;
+    };
+    const auto start = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < num_regions; i++) {
+        auto result =
+            manager->MapBackingMemory(address(i), block + i * Memory::BORKED3DS_PAGE_SIZE,
+                                      Memory::BORKED3DS_PAGE_SIZE, Kernel::MemoryState::Private);
+        REQUIRE(result.Succeeded());
+    }
+    const auto mapped = std::chrono::steady_clock::now();
+    u32 found = 0;
+    for (u32 round = 0; round < 16; round++) {
+        for (u32 i = 0; i < num_regions; i++) {
+            found += manager->FindVMA(address(i))->second.type == Kernel::VMAType::BackingMemory;
+        }
+    }
+    const auto looked_up = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < num_regions; i++) {
+        REQUIRE(manager->ReprotectRange(address(i), Memory::BORKED3DS_PAGE_SIZE,
+                                        Kernel::VMAPermission::Read) == ResultSuccess);
+    }
+    const auto reprotected = std::chrono::steady_clock::now();
+    for (u32 i = 0; i < num_regions; i++) {
+        REQUIRE(manager->UnmapRange(address(i), Memory::BORKED3DS_PAGE_SIZE) == ResultSuccess);
+    }
+    const auto unmapped = std::chrono::steady_clock::now();
+
+    REQUIRE(found == 16 * num_regions);
+    REQUIRE(manager->vma_map.size() == 1);
+
+    const auto us = [](auto duration) {
+        return std::chrono::duration<double, std::micro>(duration).count();
+    };
+    WARN("map: " << us(mapped - start) << " us, find: " << us(looked_up - mapped)
+                 << " us, reprotect: " << us(reprotected - looked_up)
+                 << " us, unmap: " << us(unmapped - reprotected) << " us");
+}
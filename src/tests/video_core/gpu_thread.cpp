@@ -0,0 +1,49 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/gpu_thread.h"
+
+using namespace VideoCore;
+
+TEST_CASE("GPUThread runs commands in order", "[video_core][gpu_thread]") {
+    std::vector<u32> executed;
+    GPUThread thread{[&executed](const GPUCommand& command) {
+        const auto& reg_write = std::get<GPURegWrite>(command);
+        if (reg_write.index % 64 == 0) {
+            std::this_thread::sleep_for(std::chrono::microseconds{100});
+        }
+        executed.push_back(reg_write.value);
+    }};
+
+    for (u32 i = 0; i < 1024; i++) {
+        thread.Push(GPURegWrite{i, i});
+    }
+    thread.WaitIdle();
+
+    REQUIRE(thread.IsIdle());
+    REQUIRE(executed.size() == 1024);
+    for (u32 i = 0; i < executed.size(); i++) {
+        REQUIRE(executed[i] == i);
+    }
+}
+
+TEST_CASE("GPUThread fences from the GPU thread are no-ops", "[video_core][gpu_thread]") {
+    bool on_gpu_thread = false;
+    GPUThread* self = nullptr;
+    GPUThread thread{[&](const GPUCommand&) {
+        on_gpu_thread = self->IsGPUThread();
+        // Waiting on ourselves would deadlock
+        self->WaitIdle();
+    }};
+    self = &thread;
+
+    REQUIRE_FALSE(thread.IsGPUThread());
+    thread.Push(GPURegWrite{0, 0});
+    thread.WaitIdle();
+    REQUIRE(on_gpu_thread);
+}
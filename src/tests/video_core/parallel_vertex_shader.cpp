@@ -0,0 +1,172 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/inline_assembly.h>
+#include "video_core/pica/parallel_vertex_shader.h"
+#include "video_core/pica/regs_shader.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_cache.h"
+#include "video_core/shader/shader_interpreter.h"
+
+using namespace Pica;
+
+using DestRegister = nihstro::DestRegister;
+using OpCode = nihstro::OpCode;
+using SourceRegister = nihstro::SourceRegister;
+
+namespace {
+
+constexpr std::size_t NUM_WORKERS = 4;
+constexpr u32 NUM_VERTICES = 4096;
+
+std::unique_ptr<ShaderSetup> CompileShaderSetup(std::initializer_list<nihstro::InlineAsm> code) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary(code);
+
+    auto shader = std::make_unique<ShaderSetup>();
+    std::transform(shbin.program.begin(), shbin.program.end(), shader->program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    std::transform(shbin.swizzle_table.begin(), shbin.swizzle_table.end(),
+                   shader->swizzle_data.begin(), [](const auto& x) { return x.hex; });
+    return shader;
+}
+
+/// Output o0 is the sum of the inputs of every invocation so far on the unit.
+std::unique_ptr<ShaderSetup> AccumulatingShader() {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+    return CompileShaderSetup({
+        {OpCode::Id::ADD, sh_temp, sh_temp, sh_input},
+        {OpCode::Id::MOV, sh_output, sh_temp},
+        {OpCode::Id::END},
+    });
+}
+
+/// Output o0 only depends on the input of the invocation.
+std::unique_ptr<ShaderSetup> IndependentShader() {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+    return CompileShaderSetup({
+        {OpCode::Id::MOV, sh_temp, sh_input},
+        {OpCode::Id::ADD, sh_output, sh_temp, sh_temp},
+        {OpCode::Id::END},
+    });
+}
+
+ShaderRegs MakeConfig() {
+    ShaderRegs config{};
+    config.max_input_attribute_index.Assign(0);
+    config.input_attribute_to_register_map_low = 0;
+    config.input_attribute_to_register_map_high = 0;
+    config.output_mask.Assign(1);
+    return config;
+}
+
+void LoadInput(u32 vertex, AttributeBuffer& input) {
+    input[0] = Common::Vec4<f24>::AssignToAll(f24::FromFloat32(static_cast<float>(vertex % 61)));
+}
+
+/// Shades the draw on a single unit, like the serial path of PicaCore::LoadVertices.
+std::vector<float> ShadeSerial(const ShaderEngine& engine, const ShaderSetup& setup,
+                               const ShaderRegs& config, const std::vector<u32>& vertices,
+                               bool is_indexed) {
+    VertexCache cache;
+    cache.Reset();
+    ShaderUnit unit;
+    std::vector<float> results;
+    for (const u32 vertex : vertices) {
+        if (is_indexed && cache.Lookup(vertex)) {
+            results.push_back(cache.Output(VertexCache::SlotOf(vertex))[0].x.ToFloat32());
+            continue;
+        }
+        AttributeBuffer input;
+        LoadInput(vertex, input);
+        unit.LoadInput(config, input);
+        engine.Run(setup, unit);
+
+        AttributeBuffer output;
+        unit.WriteOutput(config, output);
+        if (is_indexed) {
+            cache.Output(cache.Insert(vertex)) = output;
+        }
+        results.push_back(output[0].x.ToFloat32());
+    }
+    return results;
+}
+
+std::vector<float> ShadeParallel(ParallelVertexShader& shader, const ShaderEngine& engine,
+                                 const ShaderSetup& setup, const ShaderRegs& config,
+                                 const std::vector<u32>& vertices, bool is_indexed) {
+    VertexCache cache;
+    cache.Reset();
+    shader.Shade(engine, setup, config, vertices, is_indexed ? &cache : nullptr,
+                 [](u32, u32 vertex, AttributeBuffer& input) { LoadInput(vertex, input); });
+
+    std::vector<float> results;
+    for (u32 index = 0; index < vertices.size(); ++index) {
+        results.push_back(shader.Output(index)[0].x.ToFloat32());
+    }
+    return results;
+}
+
+std::vector<u32> NonIndexedDraw() {
+    std::vector<u32> vertices(NUM_VERTICES);
+    for (u32 index = 0; index < NUM_VERTICES; ++index) {
+        vertices[index] = index + 3;
+    }
+    return vertices;
+}
+
+/// Indices with plenty of repeats, some of them evicted from the cache before they recur.
+std::vector<u32> IndexedDraw() {
+    std::mt19937 rng{0x3d5};
+    std::vector<u32> vertices(NUM_VERTICES);
+    for (u32 index = 0; index < NUM_VERTICES; ++index) {
+        vertices[index] = (index / 2 + static_cast<u32>(rng() % 8)) % 0x10000;
+    }
+    return vertices;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Parallel shading matches serial shading", "[video_core][parallel_vertex_shader]") {
+    const ShaderRegs config = MakeConfig();
+    Shader::InterpreterEngine engine;
+    ParallelVertexShader shader{NUM_WORKERS};
+
+    const auto check = [&](ShaderSetup& setup) {
+        engine.SetupBatch(setup, 0);
+        SECTION("Non-indexed") {
+            const auto vertices = NonIndexedDraw();
+            REQUIRE(ShadeParallel(shader, engine, setup, config, vertices, false) ==
+                    ShadeSerial(engine, setup, config, vertices, false));
+        }
+        SECTION("Indexed") {
+            const auto vertices = IndexedDraw();
+            REQUIRE(ShadeParallel(shader, engine, setup, config, vertices, true) ==
+                    ShadeSerial(engine, setup, config, vertices, true));
+        }
+    };
+
+    SECTION("Registers carried between invocations") {
+        const auto setup = AccumulatingShader();
+        check(*setup);
+        // The speculative runs started from the wrong temporary, so every later job is redone
+        REQUIRE(shader.NumReshaded() > 0);
+    }
+
+    SECTION("Registers overwritten by every invocation") {
+        const auto setup = IndependentShader();
+        check(*setup);
+        // Only the first invocation of every later job is checked again
+        REQUIRE(shader.NumReshaded() == NUM_WORKERS - 1);
+    }
+}
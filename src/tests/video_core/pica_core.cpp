@@ -0,0 +1,99 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <catch2/catch_test_macros.hpp>
+#include <nihstro/inline_assembly.h>
+#include "common/settings.h"
+#include "core/core.h"
+#include "core/memory.h"
+#include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica/pica_core.h"
+#include "video_core/rasterizer_interface.h"
+
+using namespace Pica;
+
+namespace {
+
+constexpr u32 NUM_VERTICES = 3 * 1024;
+constexpr PAddr COMMAND_LIST_PADDR = Memory::VRAM_PADDR;
+
+class CountingRasterizer : public VideoCore::RasterizerInterface {
+public:
+    void AddTriangle(const OutputVertex&, const OutputVertex&, const OutputVertex&) override {
+        ++num_triangles;
+    }
+    void DrawTriangles() override {}
+    void NotifyPicaRegisterChanged(u32) override {}
+    void FlushAll() override {}
+    void FlushRegion(PAddr, u32) override {}
+    void InvalidateRegion(PAddr, u32) override {}
+    void FlushAndInvalidateRegion(PAddr, u32) override {}
+    void ClearAll(bool) override {}
+
+    u32 num_triangles = 0;
+};
+
+/// Configures a non-indexed triangle list whose only input attribute is a default attribute.
+void SetupDraw(PicaCore& pica) {
+    const auto shbin = nihstro::InlineAsm::CompileToRawBinary({
+        {nihstro::OpCode::Id::END},
+    });
+    std::transform(shbin.program.begin(), shbin.program.end(), pica.vs_setup.program_code.begin(),
+                   [](const auto& x) { return x.hex; });
+    pica.vs_setup.MarkProgramCodeDirty();
+
+    auto& pipeline = pica.regs.internal.pipeline;
+    pipeline.vertex_attributes.base_address.Assign(Memory::VRAM_PADDR / 16);
+    pipeline.vertex_attributes.attribute_mask.Assign(1);
+    pipeline.vertex_attributes.max_attribute_index.Assign(0);
+    pipeline.num_vertices = NUM_VERTICES;
+    pipeline.vertex_offset = 0;
+}
+
+/// Triggers the draw through a command list, like the GSP does.
+void Draw(PicaCore& pica, Memory::MemorySystem& memory) {
+    // Command headers hold the register index and, from bit 16, the mask of bytes to write
+    constexpr u32 WRITE_ALL_BYTES = 0xF << 16;
+    const u32 header = static_cast<u32>(PICA_REG_INDEX(pipeline.trigger_draw)) | WRITE_ALL_BYTES;
+    const std::array<u32, 2> command_list{1, header};
+    std::memcpy(memory.GetPhysicalPointer(COMMAND_LIST_PADDR), command_list.data(),
+                sizeof(command_list));
+    pica.ProcessCmdList(COMMAND_LIST_PADDR, sizeof(command_list));
+}
+
+} // Anonymous namespace
+
+TEST_CASE("PicaCore shades large draws in parallel with a debugger attached",
+          "[video_core][pica_core]") {
+    Settings::values.use_parallel_vertex_shading.SetValue(true);
+    Settings::values.use_shader_jit.SetValue(false);
+    Settings::values.use_hw_shader.SetValue(false);
+
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    // Frontends always create the debug context, whether or not a debugger widget is open
+    const auto debug_context = DebugContext::Construct();
+    PicaCore pica{memory, debug_context};
+    CountingRasterizer rasterizer;
+    pica.BindRasterizer(&rasterizer);
+    SetupDraw(pica);
+
+    Draw(pica, memory);
+    REQUIRE(pica.ShadedLastDrawInParallel());
+    REQUIRE(rasterizer.num_triangles == NUM_VERTICES / 3);
+
+    // Smaller draws are not worth handing to the workers
+    pica.regs.internal.pipeline.num_vertices = 3;
+    Draw(pica, memory);
+    REQUIRE_FALSE(pica.ShadedLastDrawInParallel());
+    REQUIRE(rasterizer.num_triangles == NUM_VERTICES / 3 + 1);
+
+    Settings::values.use_parallel_vertex_shading.SetValue(
+        Settings::values.use_parallel_vertex_shading.GetDefault());
+    Settings::values.use_shader_jit.SetValue(Settings::values.use_shader_jit.GetDefault());
+    Settings::values.use_hw_shader.SetValue(Settings::values.use_hw_shader.GetDefault());
+}
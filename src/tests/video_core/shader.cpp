@@ -16,9 +16,11 @@
 #include <catch2/generators/catch_generators.hpp>
 #include <fmt/format.h>
 #include <nihstro/inline_assembly.h>
+#include "video_core/pica/regs_shader.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
 #include "video_core/shader/shader_interpreter.h"
+#include "video_core/shader/shader_jit.h"
 #if BORKED3DS_ARCH(x86_64)
 #include "video_core/shader/shader_jit_x64_compiler.h"
 #elif BORKED3DS_ARCH(arm64)
@@ -73,6 +75,16 @@ static std::unique_ptr<Pica::ShaderSetup> CompileShaderSetup(
     return shader;
 }
 
+/// Configuration mapping attribute 0 to input register 0 and writing the masked outputs.
+static Pica::ShaderRegs MakeBatchConfig(u32 output_mask) {
+    Pica::ShaderRegs config{};
+    config.max_input_attribute_index.Assign(0);
+    config.input_attribute_to_register_map_low = 0;
+    config.input_attribute_to_register_map_high = 0;
+    config.output_mask.Assign(output_mask);
+    return config;
+}
+
 class ShaderTest {
 public:
     explicit ShaderTest(std::initializer_list<nihstro::InlineAsm> code)
@@ -803,4 +815,174 @@ SHADER_TEST_CASE("Source Swizzle", "[video_core][shader]") {
             Common::Vec4f(iota_vec.y, iota_vec.y, iota_vec.y, iota_vec.y));
 }
 
+TEST_CASE("Interpreter RunBatch", "[video_core][shader]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto shader_setup = CompileShaderSetup({
+        {OpCode::Id::NOP}, // call ex2
+        {OpCode::Id::END},
+        // .proc ex2
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+    });
+
+    // The call stack is reused between the invocations of a batch
+    nihstro::Instruction CALL = {};
+    CALL.opcode = nihstro::OpCode(nihstro::OpCode::Id::CALL);
+    CALL.flow_control.dest_offset = 2;
+    CALL.flow_control.num_instructions = 1;
+    shader_setup->program_code[0] = CALL.hex;
+
+    ShaderInterpreter interpreter{};
+    interpreter.SetupBatch(*shader_setup, 0);
+
+    const Pica::ShaderRegs config = MakeBatchConfig(1);
+    std::array<Pica::AttributeBuffer, 8> inputs{};
+    std::array<Pica::AttributeBuffer, 8> outputs{};
+    std::array<Pica::AttributeBuffer*, 8> destinations;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        inputs[i][0].x = Pica::f24::FromFloat32(static_cast<float>(i) - 4.0f);
+        destinations[i] = &outputs[i];
+    }
+    Pica::ShaderUnit batch_unit{};
+    interpreter.RunBatch(*shader_setup, config, batch_unit, inputs, destinations);
+
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        Pica::ShaderUnit unit{};
+        unit.input[0] = inputs[i][0];
+        interpreter.Run(*shader_setup, unit);
+        REQUIRE(outputs[i][0].x.ToFloat32() == unit.output[0].x.ToFloat32());
+        REQUIRE(outputs[i][0].x.ToFloat32() ==
+                Catch::Approx(std::exp2(static_cast<float>(i) - 4.0f)));
+    }
+}
+
+TEST_CASE("RunBatch matches consecutive runs of a single unit", "[video_core][shader]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_temp = SourceRegister::MakeTemporary(0);
+    const auto sh_c0 = SourceRegister::MakeFloat(0);
+    const auto sh_output0 = DestRegister::MakeOutput(0);
+    const auto sh_output1 = DestRegister::MakeOutput(1);
+
+    // Every invocation reads the temporary and address registers the previous one left
+    auto shader_setup = CompileShaderSetup({
+        // mov o1, c0[a0.x]
+        {OpCode::Id::MOV, sh_output1, "xyzw", sh_c0, "xyzw", SourceRegister{}, "",
+         nihstro::InlineAsm::RelativeAddress::A1},
+        {OpCode::Id::ADD, sh_temp, sh_temp, sh_input},
+        {OpCode::Id::MOV, sh_output0, sh_temp},
+        // mova a0.x, v0.x
+        {OpCode::Id::MOVA, DestRegister{}, "x", sh_input, "x", SourceRegister{}, "",
+         nihstro::InlineAsm::RelativeAddress::A1},
+        {OpCode::Id::END},
+    });
+    for (u32 i = 0; i < 16; ++i) {
+        shader_setup->uniforms.f[i] =
+            Common::Vec4<Pica::f24>::AssignToAll(Pica::f24::FromFloat32(static_cast<float>(i)));
+    }
+
+    const auto check = [&](Pica::ShaderEngine& engine) {
+        engine.SetupBatch(*shader_setup, 0);
+
+        // Two batches on the same unit, like LoadVertices does
+        constexpr std::size_t num_vertices = 16;
+        constexpr std::size_t batch_size = 8;
+        const Pica::ShaderRegs config = MakeBatchConfig(0b11);
+        std::array<Pica::AttributeBuffer, num_vertices> inputs{};
+        std::array<Pica::AttributeBuffer, num_vertices> outputs{};
+        std::array<Pica::AttributeBuffer*, num_vertices> destinations;
+        for (std::size_t i = 0; i < num_vertices; ++i) {
+            inputs[i][0].x = Pica::f24::FromFloat32(static_cast<float>(i % 7));
+            destinations[i] = &outputs[i];
+        }
+        Pica::ShaderUnit batch_unit{};
+        for (std::size_t begin = 0; begin < num_vertices; begin += batch_size) {
+            engine.RunBatch(*shader_setup, config, batch_unit,
+                            std::span{inputs}.subspan(begin, batch_size),
+                            std::span{destinations}.subspan(begin, batch_size));
+        }
+
+        Pica::ShaderUnit unit{};
+        for (std::size_t i = 0; i < num_vertices; ++i) {
+            unit.input[0].x = inputs[i][0].x;
+            engine.Run(*shader_setup, unit);
+            REQUIRE(outputs[i][0].x.ToFloat32() == unit.output[0].x.ToFloat32());
+            REQUIRE(outputs[i][1].x.ToFloat32() == unit.output[1].x.ToFloat32());
+        }
+        REQUIRE(batch_unit.temporary[0].x.ToFloat32() == unit.temporary[0].x.ToFloat32());
+        REQUIRE(batch_unit.address_registers[0] == unit.address_registers[0]);
+        REQUIRE(unit.output[0].x.ToFloat32() == 43.0f);
+    };
+
+    SECTION("Interpreter") {
+        ShaderInterpreter interpreter{};
+        check(interpreter);
+    }
+
+    SECTION("JIT") {
+        Pica::Shader::JitEngine engine{};
+        engine.SetupBatch(*shader_setup, 0);
+        engine.WaitForCompilation();
+        check(engine);
+        REQUIRE(shader_setup->cached_shader != nullptr);
+    }
+}
+
+TEST_CASE("JitEngine falls back to the interpreter while compiling", "[video_core][shader]") {
+    const auto sh_input = SourceRegister::MakeInput(0);
+    const auto sh_output = DestRegister::MakeOutput(0);
+
+    auto ex2_setup = CompileShaderSetup({
+        {OpCode::Id::EX2, sh_output, sh_input},
+        {OpCode::Id::END},
+    });
+    auto lg2_setup = CompileShaderSetup({
+        {OpCode::Id::LG2, sh_output, sh_input},
+        {OpCode::Id::END},
+    });
+    auto rcp_setup = CompileShaderSetup({
+        {OpCode::Id::RCP, sh_output, sh_input},
+        {OpCode::Id::END},
+    });
+
+    const auto run = [](Pica::Shader::JitEngine& engine, Pica::ShaderSetup& setup) {
+        engine.SetupBatch(setup, 0);
+        Pica::ShaderUnit unit{};
+        unit.input[0].x = Pica::f24::FromFloat32(2.0f);
+        engine.Run(setup, unit);
+        return unit.output[0].x.ToFloat32();
+    };
+
+    Pica::Shader::JitEngine engine{2};
+
+    // The first batch is interpreted while the shader compiles in the background
+    REQUIRE(run(engine, *ex2_setup) == Catch::Approx(4.0f));
+    REQUIRE(ex2_setup->cached_shader == nullptr);
+    REQUIRE(engine.GetStats().interpreted_batches == 1);
+
+    engine.WaitForCompilation();
+    REQUIRE(run(engine, *ex2_setup) == Catch::Approx(4.0f));
+    REQUIRE(ex2_setup->cached_shader != nullptr);
+    REQUIRE(run(engine, *ex2_setup) == Catch::Approx(4.0f));
+
+    auto stats = engine.GetStats();
+    REQUIRE(stats.cache_misses == 1);
+    REQUIRE(stats.cache_hits == 1);
+    REQUIRE(stats.compiled_shaders == 1);
+
+    // Filling the cache past its capacity evicts the least recently used shader
+    run(engine, *lg2_setup);
+    engine.WaitForCompilation();
+    REQUIRE(run(engine, *lg2_setup) == Catch::Approx(1.0f));
+
+    run(engine, *rcp_setup);
+    engine.WaitForCompilation();
+    REQUIRE(run(engine, *rcp_setup) == Catch::Approx(0.5f));
+
+    stats = engine.GetStats();
+    REQUIRE(stats.cache_misses == 3);
+    REQUIRE(stats.evictions == 1);
+}
+
 #endif // BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
@@ -0,0 +1,201 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <filesystem>
+#include <fstream>
+#include <catch2/catch_test_macros.hpp>
+#include "common/hash.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+using Pica::Shader::JitDiskCache;
+
+namespace {
+
+constexpr std::size_t HEADER_SIZE = 24;
+
+struct Program {
+    u64 key;
+    Pica::ProgramCode program_code{};
+    Pica::SwizzleData swizzle_data{};
+};
+
+Program MakeProgram(u32 seed) {
+    Program program;
+    for (u32 i = 0; i < 16 + seed; i++) {
+        program.program_code[i] = seed * 0x1000 + i + 1;
+    }
+    program.swizzle_data[0] = seed;
+    program.swizzle_data[3] = seed + 1;
+    program.key = Common::HashCombine(
+        Common::ComputeHash64(&program.program_code, sizeof(Pica::ProgramCode)),
+        Common::ComputeHash64(&program.swizzle_data, sizeof(Pica::SwizzleData)));
+    return program;
+}
+
+std::string TempPath() {
+    const auto path = std::filesystem::temp_directory_path() / "borked3ds_shader_jit_cache.bin";
+    std::filesystem::remove(path);
+    return path.string();
+}
+
+} // Anonymous namespace
+
+TEST_CASE("JitDiskCache round trips programs", "[video_core][shader]") {
+    const std::string path = TempPath();
+    const Program first = MakeProgram(1);
+    const Program second = MakeProgram(2);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().empty());
+        cache.Append(first.key, first.program_code, first.swizzle_data);
+        cache.Append(second.key, second.program_code, second.swizzle_data);
+    }
+
+    JitDiskCache cache{path};
+    const auto entries = cache.Load();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[0].key == first.key);
+    REQUIRE(entries[0].program_code == first.program_code);
+    REQUIRE(entries[0].swizzle_data == first.swizzle_data);
+    REQUIRE(entries[1].key == second.key);
+    REQUIRE(entries[1].program_code == second.program_code);
+    REQUIRE(entries[1].swizzle_data == second.swizzle_data);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("JitDiskCache drops a partially written entry", "[video_core][shader]") {
+    const std::string path = TempPath();
+    const Program first = MakeProgram(1);
+    const Program second = MakeProgram(2);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().empty());
+        cache.Append(first.key, first.program_code, first.swizzle_data);
+        cache.Append(second.key, second.program_code, second.swizzle_data);
+    }
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 4);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().size() == 1);
+        // New entries are appended after the last valid one
+        cache.Append(second.key, second.program_code, second.swizzle_data);
+    }
+
+    JitDiskCache cache{path};
+    const auto entries = cache.Load();
+    REQUIRE(entries.size() == 2);
+    REQUIRE(entries[1].program_code == second.program_code);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("JitDiskCache discards files with an unknown header", "[video_core][shader]") {
+    const std::string path = TempPath();
+    {
+        FileUtil::IOFile file{path, "wb"};
+        const std::array<u32, 8> garbage{0xDEADBEEF, 1, 2, 3, 4, 5, 6, 7};
+        file.WriteArray(garbage.data(), garbage.size());
+    }
+
+    JitDiskCache cache{path};
+    REQUIRE(cache.Load().empty());
+    REQUIRE(std::filesystem::file_size(path) == HEADER_SIZE);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("JitDiskCache discards files written by another build", "[video_core][shader]") {
+    const std::string path = TempPath();
+    const Program first = MakeProgram(1);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().empty());
+        cache.Append(first.key, first.program_code, first.swizzle_data);
+    }
+    {
+        // The build revision follows the magic, version, host ISA and reserved words
+        std::fstream file{path, std::ios::in | std::ios::out | std::ios::binary};
+        file.seekp(16);
+        const u64 other_revision = 0x0123456789ABCDEF;
+        file.write(reinterpret_cast<const char*>(&other_revision), sizeof(other_revision));
+    }
+
+    JitDiskCache cache{path};
+    REQUIRE(cache.Load().empty());
+    REQUIRE(std::filesystem::file_size(path) == HEADER_SIZE);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("JitDiskCache stores every key once", "[video_core][shader]") {
+    const std::string path = TempPath();
+    const Program first = MakeProgram(1);
+    const Program second = MakeProgram(2);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().empty());
+        cache.Append(first.key, first.program_code, first.swizzle_data);
+        cache.Append(second.key, second.program_code, second.swizzle_data);
+        // Compiled again after being evicted from the JIT cache
+        cache.Append(first.key, first.program_code, first.swizzle_data);
+    }
+    const auto size = std::filesystem::file_size(path);
+
+    {
+        JitDiskCache cache{path};
+        REQUIRE(cache.Load().size() == 2);
+        cache.Append(second.key, second.program_code, second.swizzle_data);
+    }
+    REQUIRE(std::filesystem::file_size(path) == size);
+
+    std::filesystem::remove(path);
+}
+
+TEST_CASE("JitDiskCache keeps the newest programs within its maximum size",
+          "[video_core][shader]") {
+    const std::string path = TempPath();
+    constexpr std::size_t max_size = 4096;
+    constexpr u32 num_programs = 64;
+
+    {
+        JitDiskCache cache{path, max_size};
+        REQUIRE(cache.Load().empty());
+        for (u32 seed = 0; seed < num_programs; seed++) {
+            const Program program = MakeProgram(seed);
+            cache.Append(program.key, program.program_code, program.swizzle_data);
+        }
+    }
+    // Programs that did not fit were not recorded
+    REQUIRE(std::filesystem::file_size(path) <= max_size);
+    REQUIRE(std::filesystem::file_size(path) > max_size / 4 * 3);
+
+    JitDiskCache cache{path, max_size};
+    const auto entries = cache.Load();
+    REQUIRE(!entries.empty());
+    REQUIRE(std::filesystem::file_size(path) <= max_size / 2);
+
+    // The programs recorded last are kept, in their original order
+    u32 seed = 0;
+    while (MakeProgram(seed).key != entries.front().key) {
+        REQUIRE(++seed < num_programs);
+    }
+    for (const auto& entry : entries) {
+        const Program program = MakeProgram(seed++);
+        REQUIRE(entry.key == program.key);
+        REQUIRE(entry.program_code == program.program_code);
+    }
+
+    // Appending continues after the kept programs
+    const Program program = MakeProgram(num_programs);
+    cache.Append(program.key, program.program_code, program.swizzle_data);
+    REQUIRE(JitDiskCache{path, max_size}.Load().back().key == program.key);
+
+    std::filesystem::remove(path);
+}
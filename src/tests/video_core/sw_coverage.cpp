@@ -0,0 +1,41 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/renderer_software/sw_coverage.h"
+
+using namespace SwRenderer;
+
+TEST_CASE("Coverage matches the scalar reference", "[video_core][sw_coverage]") {
+    const CoverageFunc coverage = GetCoverageFunc();
+    std::mt19937 rng{0x3d5};
+    for (u32 n = 0; n < 100000; n++) {
+        EdgeSpan span{};
+        for (u32 edge = 0; edge < 3; edge++) {
+            // Alternate between edges crossing the span and arbitrary (wrapping) values
+            span.w[edge] = (n & 1) ? static_cast<s32>(rng() % 0x200000) - 0x100000
+                                   : static_cast<s32>(rng());
+            span.step[edge] = static_cast<s32>(rng() % 0x20000) - 0x10000;
+            span.bias[edge] = rng() & 1;
+        }
+        const u32 count = 1 + rng() % MAX_SPAN_PIXELS;
+        REQUIRE(coverage(span, count) == CoverageMaskScalar(span, count));
+    }
+}
+
+TEST_CASE("Coverage respects the top-left rule bias", "[video_core][sw_coverage]") {
+    const CoverageFunc coverage = GetCoverageFunc();
+    // Edge 0 crosses zero at pixel 4, the other edges cover the whole span
+    EdgeSpan span{
+        .w = {-4 * 0x10, 0, 0},
+        .step = {0x10, 0, 0},
+        .bias = {0, 0, 0},
+    };
+    REQUIRE(coverage(span, 8) == 0xF0);
+    span.bias[0] = 1;
+    REQUIRE(coverage(span, 8) == 0xE0);
+    REQUIRE(coverage(span, MAX_SPAN_PIXELS) == 0xFFFFFFE0);
+    REQUIRE(coverage(span, 6) == 0x20);
+}
@@ -0,0 +1,114 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <bit>
+#include <cmath>
+#include <random>
+#include <catch2/catch_test_macros.hpp>
+#include "video_core/renderer_software/sw_interpolation.h"
+
+using namespace SwRenderer;
+using Pica::f24;
+
+namespace {
+
+InterpolationSetup RandomSetup(std::mt19937& rng) {
+    std::uniform_real_distribution<float> value{-4.0f, 4.0f};
+    std::uniform_real_distribution<float> w_inverse{1.0f / 256.0f, 4.0f};
+    const auto random_f24 = [&] {
+        // Mostly ordinary values, with some of the special cases of f24
+        switch (rng() % 16) {
+        case 0:
+            return f24::Zero();
+        case 1:
+            return f24::FromFloat32(1e-20f);
+        case 2:
+            return f24::FromFloat32(1e20f);
+        default:
+            return f24::FromFloat32(value(rng));
+        }
+    };
+
+    InterpolationSetup setup{
+        .depth_scale = -value(rng),
+        .depth_offset = value(rng),
+        .w_buffer = (rng() & 1) != 0,
+        .num_attributes = (rng() & 1) ? NUM_ATTRIBUTES : NUM_UNLIT_ATTRIBUTES,
+    };
+    for (u32 vertex = 0; vertex < 3; vertex++) {
+        setup.w_inverse[vertex] = f24::FromFloat32(w_inverse(rng));
+        setup.z[vertex] = value(rng);
+        for (auto& attribute : setup.attributes) {
+            attribute[vertex] = random_f24();
+        }
+    }
+    return setup;
+}
+
+EdgeSpan RandomSpan(std::mt19937& rng) {
+    EdgeSpan span{};
+    for (u32 edge = 0; edge < 3; edge++) {
+        span.w[edge] = static_cast<s32>(rng() % 0x200000);
+        span.step[edge] = static_cast<s32>(rng() % 0x2000) - 0x1000;
+        span.bias[edge] = 0;
+    }
+    return span;
+}
+
+} // Anonymous namespace
+
+TEST_CASE("Interpolation matches the scalar reference", "[video_core][sw_interpolation]") {
+    const InterpolateFunc interpolate = GetInterpolateFunc();
+    std::mt19937 rng{0x3d5};
+    for (u32 n = 0; n < 20000; n++) {
+        const InterpolationSetup setup = RandomSetup(rng);
+        const EdgeSpan span = RandomSpan(rng);
+        const u32 coverage = static_cast<u32>(rng());
+
+        SpanValues expected{};
+        SpanValues actual{};
+        InterpolateScalar(setup, span, coverage, expected);
+        interpolate(setup, span, coverage, actual);
+
+        // Compare the bits, so that NaN and signed zeros must match too
+        for (u32 i = 0; i < MAX_SPAN_PIXELS; i++) {
+            if ((coverage & (1U << i)) == 0) {
+                continue;
+            }
+            REQUIRE(std::bit_cast<u32>(actual.depth[i]) == std::bit_cast<u32>(expected.depth[i]));
+            for (u32 attribute = 0; attribute < setup.num_attributes; attribute++) {
+                REQUIRE(std::bit_cast<u32>(actual.attributes[attribute][i]) ==
+                        std::bit_cast<u32>(expected.attributes[attribute][i]));
+            }
+        }
+    }
+}
+
+TEST_CASE("Interpolation is perspective correct", "[video_core][sw_interpolation]") {
+    const InterpolateFunc interpolate = GetInterpolateFunc();
+    // Vertex 0 has w = 1 and u = 1, the others have w = 2 and u = 0. Attributes are stored
+    // divided by w.
+    InterpolationSetup setup{
+        .w_inverse = {f24::One(), f24::FromFloat32(0.5f), f24::FromFloat32(0.5f)},
+        .z = {0.0f, 1.0f, 1.0f},
+        .depth_scale = 1.0f,
+        .depth_offset = 0.0f,
+        .w_buffer = false,
+        .num_attributes = NUM_UNLIT_ATTRIBUTES,
+    };
+    setup.attributes[static_cast<u32>(Attribute::Tc0U)] = {f24::One(), f24::Zero(), f24::Zero()};
+
+    // The first pixel is halfway between vertex 0 and the opposite edge
+    const EdgeSpan span{
+        .w = {0x100, 0x80, 0x80},
+        .step = {0, 0, 0},
+        .bias = {0, 0, 0},
+    };
+    SpanValues values{};
+    interpolate(setup, span, 1, values);
+
+    // 1/w interpolates to 0.75, u/w to 0.5, so u = 2/3 and not the linear 1/2
+    REQUIRE(values.depth[0] == 0.5f);
+    REQUIRE(std::abs(values.Get(Attribute::Tc0U, 0) - 2.0f / 3.0f) < 1e-4f);
+}
@@ -0,0 +1,124 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <cstring>
+#include <vector>
+#include <catch2/catch_test_macros.hpp>
+#include "core/core.h"
+#include "core/core_timing.h"
+#include "core/hle/kernel/process.h"
+#include "core/memory.h"
+#include "video_core/gpu_thread.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
+
+using namespace SwRenderer;
+using Pica::Texture::TextureInfo;
+
+namespace {
+
+constexpr u32 TEXTURE_SIZE = 8 * 8 * 4;
+constexpr u32 NUM_TEXTURES = 64;
+
+TextureInfo MakeTextureInfo(u32 texture) {
+    TextureInfo info{
+        .physical_address = Memory::VRAM_PADDR + texture * TEXTURE_SIZE,
+        .width = 8,
+        .height = 8,
+        .format = Pica::TexturingRegs::TextureFormat::RGBA8,
+    };
+    info.SetDefaultStride();
+    return info;
+}
+
+/// Samples like the rasterizer does, reading guest memory when the texture is not cached.
+Common::Vec4<u8> Sample(TextureCache& cache, Memory::MemorySystem& memory, u32 texture) {
+    const TextureInfo info = MakeTextureInfo(texture);
+    if (const DecodedTexture* decoded = cache.GetTexture(info)) {
+        return decoded->Texel(0, 0);
+    }
+    return Pica::Texture::LookupTexture(memory.GetPhysicalPointer(info.physical_address), 0, 0,
+                                        info);
+}
+
+/// Fills the texture with a single color through the CPU view of guest memory.
+void Upload(Memory::MemorySystem& memory, u32 texture, u8 value) {
+    const VAddr address = Memory::VRAM_VADDR + texture * TEXTURE_SIZE;
+    for (u32 offset = 0; offset < TEXTURE_SIZE; offset += 4) {
+        memory.Write32(address + offset, value * 0x01010101U);
+    }
+}
+
+Memory::PageType TexturePageType(const Kernel::Process& process, u32 texture) {
+    const VAddr address = Memory::VRAM_VADDR + texture * TEXTURE_SIZE;
+    return process.vm_manager.page_table->attributes[address >> Memory::BORKED3DS_PAGE_BITS];
+}
+
+Common::Vec4<u8> Color(u8 value) {
+    return {value, value, value, value};
+}
+
+} // Anonymous namespace
+
+TEST_CASE("TextureCache marks the pages of cached textures", "[video_core][sw_texture_cache]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    memory.SetCurrentPageTable(process->vm_manager.page_table);
+
+    TextureCache cache{memory};
+    Upload(memory, 0, 1);
+    REQUIRE(Sample(cache, memory, 0) == Color(1));
+    REQUIRE(TexturePageType(*process, 0) == Memory::PageType::RasterizerCachedMemory);
+
+    // CPU writes to the page now reach the rasterizer, which invalidates the texture
+    std::memset(memory.GetPhysicalPointer(Memory::VRAM_PADDR), 2, TEXTURE_SIZE);
+    REQUIRE(cache.InvalidateRegion(Memory::VRAM_PADDR, TEXTURE_SIZE));
+    REQUIRE(TexturePageType(*process, 0) == Memory::PageType::Memory);
+    REQUIRE(Sample(cache, memory, 0) == Color(2));
+}
+
+TEST_CASE("Textures uploaded while the GPU thread samples them", "[video_core][sw_texture_cache]") {
+    Core::Timing timing(1, 100);
+    Core::System system;
+    Memory::MemorySystem memory{system};
+    Kernel::KernelSystem kernel(
+        memory, timing, [] {}, Kernel::MemoryMode::Prod, 1,
+        Kernel::New3dsHwCapabilities{false, false, Kernel::New3dsMemoryMode::Legacy});
+    auto process = kernel.CreateProcess(kernel.CreateCodeSet("", 0));
+    kernel.HandleSpecialMapping(process->vm_manager,
+                                {Memory::VRAM_VADDR, Memory::VRAM_SIZE, false, false});
+    memory.SetCurrentPageTable(process->vm_manager.page_table);
+
+    // The cache of a rasterizer running on the GPU thread must leave the page tables alone
+    TextureCache cache{memory, false};
+    std::vector<Common::Vec4<u8>> sampled;
+    bool pages_marked = false;
+    VideoCore::GPUThread thread{[&](const VideoCore::GPUCommand& command) {
+        const u32 texture = std::get<VideoCore::GPURegWrite>(command).index;
+        sampled.push_back(Sample(cache, memory, texture));
+        pages_marked |= TexturePageType(*process, texture) != Memory::PageType::Memory;
+    }};
+
+    // Textures are uploaded while the GPU thread keeps sampling the earlier ones. Overwriting a
+    // texture that is still queued for sampling would race, so each round waits for the last.
+    for (u32 round = 0; round < 2; ++round) {
+        for (u32 texture = 0; texture < NUM_TEXTURES; ++texture) {
+            Upload(memory, texture, static_cast<u8>(round * NUM_TEXTURES + texture));
+            thread.Push(VideoCore::GPURegWrite{texture, 0});
+        }
+        thread.WaitIdle();
+    }
+
+    REQUIRE_FALSE(pages_marked);
+    REQUIRE(sampled.size() == 2 * NUM_TEXTURES);
+    for (u32 i = 0; i < sampled.size(); ++i) {
+        REQUIRE(sampled[i] == Color(static_cast<u8>(i)));
+    }
+}
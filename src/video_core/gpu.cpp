@@ -11,9 +11,11 @@
 #include "core/core_timing.h"
 #include "core/hle/service/gsp/gsp_gpu.h"
 #include "core/hle/service/plgldr/plgldr.h"
+#include "core/loader/loader.h"
 #include "video_core/debug_utils/debug_utils.h"
 #include "video_core/gpu.h"
 #include "video_core/gpu_debugger.h"
+#include "video_core/gpu_thread.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/renderer_base.h"
@@ -44,7 +46,12 @@ struct GPU::Impl {
     RasterizerInterface* rasterizer;
     std::unique_ptr<SwRenderer::SwBlitter> sw_blitter;
     Core::TimingEventType* vblank_event;
+    Core::TimingEventType* interrupt_event;
     Service::GSP::InterruptHandler signal_interrupt;
+    /// Handler used by the engines that may run on the GPU thread.
+    Service::GSP::InterruptHandler engine_interrupt;
+    /// Declared last so that it is joined before anything it uses is destroyed.
+    std::unique_ptr<GPUThread> gpu_thread;
 
     explicit Impl(Core::System& system, Frontend::EmuWindow& emu_window,
                   Frontend::EmuWindow* secondary_window)
@@ -66,9 +73,38 @@ GPU::GPU(Core::System& system, Frontend::EmuWindow& emu_window,
         "GPU::VBlankCallback",
         [this](uintptr_t user_data, s64 cycles_late) { VBlankCallback(user_data, cycles_late); });
     impl->timing.ScheduleEvent(FRAME_TICKS, impl->vblank_event);
+    impl->interrupt_event = impl->timing.RegisterEvent(
+        "GPU::InterruptCallback", [this](uintptr_t user_data, s64 cycles_late) {
+            impl->signal_interrupt(static_cast<Service::GSP::InterruptId>(user_data));
+        });
 
     // Bind the rasterizer to the PICA GPU
     impl->pica.BindRasterizer(impl->rasterizer);
+
+    // Prepare the shaders the title used in previous sessions.
+    u64 program_id{};
+    if (Settings::values.use_disk_shader_cache.GetValue() &&
+        system.GetAppLoader().ReadProgramId(program_id) == Loader::ResultStatus::Success) {
+        impl->pica.LoadShaderDiskCache(program_id);
+    }
+
+    // The hardware renderers keep their API contexts and rasterizer caches tied to the emulation
+    // thread, so only the software renderer can be moved to a thread of its own.
+    if (Settings::values.use_async_gpu.GetValue()) {
+        if (Settings::values.graphics_api.GetValue() == Settings::GraphicsAPI::Software) {
+            impl->gpu_thread = std::make_unique<GPUThread>([this](const GPUCommand& command) {
+                if (const auto* gsp_command = std::get_if<Service::GSP::Command>(&command)) {
+                    ExecuteCommand(*gsp_command);
+                } else if (const auto* reg_write = std::get_if<GPURegWrite>(&command)) {
+                    WriteGPUReg(reg_write->index, reg_write->value);
+                } else if (const auto* buffer_swap = std::get_if<GPUBufferSwap>(&command)) {
+                    UpdateFramebuffer(buffer_swap->screen_id, buffer_swap->info);
+                }
+            });
+        } else {
+            LOG_WARNING(HW_GPU, "Asynchronous GPU requires the software renderer, ignoring");
+        }
+    }
 }
 
 GPU::~GPU() = default;
@@ -100,22 +136,51 @@ PAddr GPU::VirtualToPhysicalAddress(VAddr addr) {
 
 void GPU::SetInterruptHandler(Service::GSP::InterruptHandler handler) {
     impl->signal_interrupt = handler;
-    impl->pica.SetInterruptHandler(handler);
+    if (impl->gpu_thread) {
+        // GSP interrupts touch kernel state, so defer them to the emulation thread.
+        impl->engine_interrupt = [this](Service::GSP::InterruptId id) {
+            impl->timing.ScheduleEvent(0, impl->interrupt_event, static_cast<uintptr_t>(id), 0,
+                                       true);
+        };
+    } else {
+        impl->engine_interrupt = handler;
+    }
+    impl->pica.SetInterruptHandler(impl->engine_interrupt);
 }
 
 void GPU::FlushRegion(PAddr addr, u32 size) {
+    WaitIdle();
     impl->rasterizer->FlushRegion(addr, size);
 }
 
 void GPU::InvalidateRegion(PAddr addr, u32 size) {
+    WaitIdle();
     impl->rasterizer->InvalidateRegion(addr, size);
 }
 
 void GPU::ClearAll(bool flush) {
+    WaitIdle();
     impl->rasterizer->ClearAll(flush);
 }
 
+void GPU::WaitIdle() {
+    if (impl->gpu_thread) {
+        impl->gpu_thread->WaitIdle();
+    }
+}
+
 void GPU::Execute(const Service::GSP::Command& command) {
+    // DMA copies go through the application's page table, so they stay on the emulation thread.
+    if (impl->gpu_thread && command.id != Service::GSP::CommandId::RequestDma) {
+        impl->gpu_thread->Push(command);
+        return;
+    }
+
+    WaitIdle();
+    ExecuteCommand(command);
+}
+
+void GPU::ExecuteCommand(const Service::GSP::Command& command) {
     using Service::GSP::CommandId;
     auto& regs = impl->pica.regs;
 
@@ -218,6 +283,18 @@ void GPU::Execute(const Service::GSP::Command& command) {
 }
 
 void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info) {
+    if (impl->gpu_thread) {
+        impl->gpu_thread->Push(GPUBufferSwap{screen_id, info});
+    } else {
+        UpdateFramebuffer(screen_id, info);
+    }
+
+    if (screen_id == 0) {
+        impl->system.perf_stats->EndGameFrame();
+    }
+}
+
+void GPU::UpdateFramebuffer(u32 screen_id, const Service::GSP::FrameBufferInfo& info) {
     const PAddr phys_address_left = VirtualToPhysicalAddress(info.address_left);
     const PAddr phys_address_right = VirtualToPhysicalAddress(info.address_right);
 
@@ -239,18 +316,16 @@ void GPU::SetBufferSwap(u32 screen_id, const Service::GSP::FrameBufferInfo& info
     if (impl->debug_context) {
         impl->debug_context->OnEvent(Pica::DebugContext::Event::BufferSwapped, nullptr);
     }
-
-    if (screen_id == 0) {
-        impl->system.perf_stats->EndGameFrame();
-    }
 }
 
 void GPU::SetColorFill(const Pica::ColorFill& fill) {
+    WaitIdle();
     impl->pica.regs_lcd.color_fill_top = fill;
     impl->pica.regs_lcd.color_fill_bottom = fill;
 }
 
 u32 GPU::ReadReg(VAddr addr) {
+    WaitIdle();
     switch (addr & 0xFFFFF000) {
     case VADDR_LCD: {
         const u32 offset = addr - VADDR_LCD;
@@ -279,6 +354,7 @@ void GPU::WriteReg(VAddr addr, u32 data) {
         const u32 index = offset / sizeof(u32);
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::RegsLcd::NumIds());
+        WaitIdle();
         impl->pica.regs_lcd[index] = data;
         break;
     }
@@ -289,27 +365,10 @@ void GPU::WriteReg(VAddr addr, u32 data) {
 
         ASSERT(addr % sizeof(u32) == 0);
         ASSERT(index < Pica::PicaCore::Regs::NUM_REGS);
-        impl->pica.regs.reg_array[index] = data;
-
-        // Handle registers that trigger GPU actions
-        switch (index) {
-        case GPU_REG_INDEX(memory_fill_config[0].trigger):
-            MemoryFill(0);
-            break;
-        case GPU_REG_INDEX(memory_fill_config[1].trigger):
-            MemoryFill(1);
-            break;
-        case GPU_REG_INDEX(display_transfer_config.trigger):
-            MemoryTransfer();
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
-            SubmitCmdList(0);
-            break;
-        case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
-            SubmitCmdList(1);
-            break;
-        default:
-            break;
+        if (impl->gpu_thread) {
+            impl->gpu_thread->Push(GPURegWrite{index, data});
+        } else {
+            WriteGPUReg(index, data);
         }
         break;
     }
@@ -318,7 +377,33 @@ void GPU::WriteReg(VAddr addr, u32 data) {
     }
 }
 
+void GPU::WriteGPUReg(u32 index, u32 data) {
+    impl->pica.regs.reg_array[index] = data;
+
+    // Handle registers that trigger GPU actions
+    switch (index) {
+    case GPU_REG_INDEX(memory_fill_config[0].trigger):
+        MemoryFill(0);
+        break;
+    case GPU_REG_INDEX(memory_fill_config[1].trigger):
+        MemoryFill(1);
+        break;
+    case GPU_REG_INDEX(display_transfer_config.trigger):
+        MemoryTransfer();
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[0]):
+        SubmitCmdList(0);
+        break;
+    case GPU_REG_INDEX(internal.pipeline.command_buffer.trigger[1]):
+        SubmitCmdList(1);
+        break;
+    default:
+        break;
+    }
+}
+
 void GPU::Sync() {
+    WaitIdle();
     impl->renderer->Sync();
 }
 
@@ -374,9 +459,9 @@ void GPU::MemoryFill(u32 index) {
     // TODO: hwtest this
     if (config.GetStartAddress() != 0) {
         if (!index) {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC0);
+            impl->engine_interrupt(Service::GSP::InterruptId::PSC0);
         } else {
-            impl->signal_interrupt(Service::GSP::InterruptId::PSC1);
+            impl->engine_interrupt(Service::GSP::InterruptId::PSC1);
         }
     }
 
@@ -413,10 +498,13 @@ void GPU::MemoryTransfer() {
 
     // Complete transfer.
     config.trigger.Assign(0);
-    impl->signal_interrupt(Service::GSP::InterruptId::PPF);
+    impl->engine_interrupt(Service::GSP::InterruptId::PPF);
 }
 
 void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
+    // Finish any queued rendering before the frame is presented.
+    WaitIdle();
+
     /// Frame Skip
     frame_count++;
     last_skip_frame = g_skip_frame;
@@ -446,6 +534,7 @@ void GPU::VBlankCallback(std::uintptr_t user_data, s64 cycles_late) {
 
 template <class Archive>
 void GPU::serialize(Archive& ar, const u32 file_version) {
+    WaitIdle();
     ar & impl->pica;
 }
 
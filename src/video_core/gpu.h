@@ -60,6 +60,9 @@ public:
     /// Flushes and invalidates all memory in the rasterizer cache and removes any leftover state.
     void ClearAll(bool flush);
 
+    /// Blocks until the GPU thread, when enabled, has finished all queued work.
+    void WaitIdle();
+
     /// Executes the provided GSP command.
     void Execute(const Service::GSP::Command& command);
 
@@ -94,6 +97,12 @@ public:
     [[nodiscard]] GraphicsDebugger& Debugger();
 
 private:
+    void ExecuteCommand(const Service::GSP::Command& command);
+
+    void UpdateFramebuffer(u32 screen_id, const Service::GSP::FrameBufferInfo& info);
+
+    void WriteGPUReg(u32 index, u32 data);
+
     void SubmitCmdList(u32 index);
 
     void MemoryFill(u32 index);
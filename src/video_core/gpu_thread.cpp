@@ -0,0 +1,62 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/profiling.h"
+#include "common/thread.h"
+#include "video_core/gpu_thread.h"
+
+namespace VideoCore {
+
+GPUThread::GPUThread(Executor executor_)
+    : executor{std::move(executor_)}, thread{[this](std::stop_token token) { ThreadLoop(token); }} {
+}
+
+GPUThread::~GPUThread() {
+    thread.request_stop();
+    thread.join();
+}
+
+void GPUThread::Push(GPUCommand&& command) {
+    ++submitted;
+    queue.Push(std::move(command));
+}
+
+void GPUThread::WaitIdle() {
+    if (IsGPUThread() || IsIdle()) {
+        return;
+    }
+
+    BORKED3DS_PROFILE("GPU", "Wait for GPU thread");
+    std::unique_lock lock{idle_mutex};
+    idle_cv.wait(lock, [this] { return IsIdle(); });
+}
+
+bool GPUThread::IsIdle() const {
+    return completed.load(std::memory_order_acquire) == submitted;
+}
+
+bool GPUThread::IsGPUThread() const {
+    return std::this_thread::get_id() == thread.get_id();
+}
+
+void GPUThread::ThreadLoop(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("GPUThread");
+
+    while (!stop_token.stop_requested()) {
+        GPUCommand command = queue.PopWait(stop_token);
+        if (stop_token.stop_requested()) {
+            break;
+        }
+
+        executor(command);
+
+        {
+            std::scoped_lock lock{idle_mutex};
+            completed.fetch_add(1, std::memory_order_release);
+        }
+        idle_cv.notify_all();
+    }
+}
+
+} // namespace VideoCore
@@ -0,0 +1,75 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <variant>
+
+#include "common/common_types.h"
+#include "common/polyfill_thread.h"
+#include "common/threadsafe_queue.h"
+#include "core/hle/service/gsp/gsp_command.h"
+#include "core/hle/service/gsp/gsp_gpu.h"
+
+namespace VideoCore {
+
+/// A GPU register write, forwarded so that it is ordered with the commands before it.
+struct GPURegWrite {
+    u32 index;
+    u32 value;
+};
+
+/// A framebuffer configuration update requested through GSP::SetBufferSwap.
+struct GPUBufferSwap {
+    u32 screen_id;
+    Service::GSP::FrameBufferInfo info;
+};
+
+using GPUCommand = std::variant<Service::GSP::Command, GPURegWrite, GPUBufferSwap>;
+
+/**
+ * Executes GPU work on a dedicated host thread. Commands are handed over through a lock-free
+ * single producer, single consumer queue and run in submission order. The producer must call
+ * WaitIdle before it touches any state owned by the GPU thread.
+ */
+class GPUThread {
+public:
+    using Executor = std::function<void(const GPUCommand&)>;
+
+    explicit GPUThread(Executor executor);
+    ~GPUThread();
+
+    GPUThread(const GPUThread&) = delete;
+    GPUThread& operator=(const GPUThread&) = delete;
+
+    /// Queues a command for execution on the GPU thread.
+    void Push(GPUCommand&& command);
+
+    /// Blocks until all queued commands have finished executing. No-op on the GPU thread.
+    void WaitIdle();
+
+    /// Returns true if there are no queued or executing commands.
+    [[nodiscard]] bool IsIdle() const;
+
+    /// Returns true if the caller is running on the GPU thread.
+    [[nodiscard]] bool IsGPUThread() const;
+
+private:
+    void ThreadLoop(std::stop_token stop_token);
+
+private:
+    Executor executor;
+    Common::SPSCQueue<GPUCommand, true> queue;
+    u64 submitted{};
+    std::atomic<u64> completed{};
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    std::jthread thread;
+};
+
+} // namespace VideoCore
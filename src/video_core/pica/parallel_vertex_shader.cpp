@@ -0,0 +1,146 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "common/logging/log.h"
+#include "video_core/pica/parallel_vertex_shader.h"
+#include "video_core/pica/shader_setup.h"
+#include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_cache.h"
+#include "video_core/shader/shader.h"
+
+namespace Pica {
+
+namespace {
+
+/// Number of invocations gathered into a single ShaderEngine::RunBatch call.
+constexpr std::size_t BATCH_SIZE = 8;
+
+/// Registers of two units compare equal, so their next invocations give the same results.
+bool SameCarriedState(const ShaderUnit& a, const ShaderUnit& b) {
+    // Compare the bits, NaN results must match as well. Inputs are compared too, as input
+    // registers without an attribute mapped keep their value.
+    return std::memcmp(a.address_registers, b.address_registers, sizeof(a.address_registers)) ==
+               0 &&
+           std::memcmp(a.conditional_code, b.conditional_code, sizeof(a.conditional_code)) == 0 &&
+           std::memcmp(a.input.data(), b.input.data(), sizeof(a.input)) == 0 &&
+           std::memcmp(a.temporary.data(), b.temporary.data(), sizeof(a.temporary)) == 0 &&
+           std::memcmp(a.output.data(), b.output.data(), sizeof(a.output)) == 0;
+}
+
+/// Result of a job shading a contiguous range of invocations from a fresh unit.
+struct Job {
+    u32 begin;
+    u32 end;
+    ShaderUnit first; ///< Registers after the first invocation
+    ShaderUnit last;  ///< Registers after the last invocation
+};
+
+} // Anonymous namespace
+
+ParallelVertexShader::ParallelVertexShader(std::size_t num_workers)
+    : workers{num_workers, "VertexShading"} {}
+
+ParallelVertexShader::~ParallelVertexShader() = default;
+
+void ParallelVertexShader::Shade(const ShaderEngine& engine, const ShaderSetup& setup,
+                                 const ShaderRegs& config, std::span<const u32> vertices,
+                                 VertexCache* cache, const LoadInputFunc& load_input) {
+    const u32 num_vertices = static_cast<u32>(vertices.size());
+
+    // Decide which vertices are shaded. With a cache, this follows the lookups of serial shading
+    // exactly, so that the same vertices are shaded in the same order.
+    sources.resize(num_vertices);
+    invocations.clear();
+    if (cache) {
+        std::array<u32, VertexCache::NUM_SLOTS> slot_invocations;
+        for (u32 index = 0; index < num_vertices; ++index) {
+            const u32 vertex = vertices[index];
+            if (cache->Lookup(vertex)) {
+                sources[index] = slot_invocations[VertexCache::SlotOf(vertex)];
+                continue;
+            }
+            const u32 invocation = static_cast<u32>(invocations.size());
+            slot_invocations[cache->Insert(vertex)] = invocation;
+            invocations.push_back(index);
+            sources[index] = invocation;
+        }
+    } else {
+        for (u32 index = 0; index < num_vertices; ++index) {
+            sources[index] = index;
+            invocations.push_back(index);
+        }
+    }
+
+    const u32 num_invocations = static_cast<u32>(invocations.size());
+    outputs.resize(num_invocations);
+    num_reshaded = 0;
+    if (num_invocations == 0) {
+        return;
+    }
+
+    const auto load_invocation = [&](u32 invocation, AttributeBuffer& input) {
+        const u32 index = invocations[invocation];
+        load_input(index, vertices[index], input);
+    };
+
+    // Shades the invocations in batches on the unit, which keeps its registers between them.
+    const auto shade = [&](ShaderUnit& unit, u32 begin, u32 end) {
+        std::array<AttributeBuffer, BATCH_SIZE> inputs;
+        std::array<AttributeBuffer*, BATCH_SIZE> destinations;
+        for (; begin < end; begin += BATCH_SIZE) {
+            const u32 count = std::min<u32>(BATCH_SIZE, end - begin);
+            for (u32 i = 0; i < count; ++i) {
+                load_invocation(begin + i, inputs[i]);
+                destinations[i] = &outputs[begin + i];
+            }
+            engine.RunBatch(setup, config, unit, std::span{inputs.data(), count},
+                            std::span{destinations.data(), count});
+        }
+    };
+
+    const u32 num_workers = static_cast<u32>(workers.NumWorkers());
+    const u32 job_size = (num_invocations + num_workers - 1) / num_workers;
+    const u32 num_jobs = (num_invocations + job_size - 1) / job_size;
+    std::vector<Job> jobs(num_jobs);
+
+    for (u32 i = 0; i < num_jobs; ++i) {
+        jobs[i].begin = i * job_size;
+        jobs[i].end = std::min(jobs[i].begin + job_size, num_invocations);
+
+        workers.QueueWork([&, i] {
+            Job& job = jobs[i];
+            ShaderUnit unit;
+            shade(unit, job.begin, job.begin + 1);
+            job.first = unit;
+            shade(unit, job.begin + 1, job.end);
+            job.last = unit;
+        });
+    }
+    workers.WaitForRequests();
+
+    // The first job started from the same fresh unit as serial shading. Every other job is
+    // validated against the registers the previous one left.
+    ShaderUnit unit = jobs[0].last;
+    for (u32 i = 1; i < num_jobs; ++i) {
+        const Job& job = jobs[i];
+        shade(unit, job.begin, job.begin + 1);
+        ++num_reshaded;
+
+        // Identical registers give identical results for the remaining invocations.
+        if (SameCarriedState(unit, job.first)) {
+            unit = job.last;
+            continue;
+        }
+        shade(unit, job.begin + 1, job.end);
+        num_reshaded += job.end - job.begin - 1;
+    }
+
+    LOG_TRACE(HW_GPU, "Parallel vertex shading: {} invocations in {} jobs, {} shaded again",
+              num_invocations, num_jobs, num_reshaded);
+}
+
+} // namespace Pica
@@ -0,0 +1,68 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <functional>
+#include <span>
+#include <vector>
+#include "common/thread_worker.h"
+#include "video_core/pica/output_vertex.h"
+
+namespace Pica {
+
+class ShaderEngine;
+class VertexCache;
+struct ShaderRegs;
+struct ShaderSetup;
+
+/**
+ * Shades the vertices of large draws on worker threads, with outputs identical to running every
+ * invocation in order on a single shader unit.
+ *
+ * Shader units keep their temporary, output, address and condition registers between
+ * invocations, so an invocation may observe what the previous one left. Each job therefore starts
+ * speculatively from a fresh unit. The jobs are then checked in order: the first invocation of a
+ * job is run again from the registers the previous job really left, and if the registers it
+ * leaves match the speculative run, the rest of the job is known to be correct. Otherwise the
+ * job is shaded again on the calling thread.
+ */
+class ParallelVertexShader {
+public:
+    /// Loads the shader input of the vertex at position index of the draw.
+    using LoadInputFunc = std::function<void(u32 index, u32 vertex, AttributeBuffer& input)>;
+
+    explicit ParallelVertexShader(std::size_t num_workers);
+    ~ParallelVertexShader();
+
+    /**
+     * Shades the vertices of a draw.
+     *
+     * @param vertices Vertex index of every vertex of the draw.
+     * @param cache When not null, vertices held by the cache reuse its output instead of being
+     *              shaded again, like serial indexed draws do. The cache must have been reset.
+     */
+    void Shade(const ShaderEngine& engine, const ShaderSetup& setup, const ShaderRegs& config,
+               std::span<const u32> vertices, VertexCache* cache,
+               const LoadInputFunc& load_input);
+
+    /// Returns the output of the vertex at position index of the last shaded draw.
+    [[nodiscard]] const AttributeBuffer& Output(u32 index) const {
+        return outputs[sources[index]];
+    }
+
+    /// Returns the number of invocations of the last draw that were shaded again serially.
+    [[nodiscard]] u32 NumReshaded() const {
+        return num_reshaded;
+    }
+
+private:
+    Common::ThreadWorker workers;
+    std::vector<u32> sources;     ///< Invocation producing the output of each vertex of the draw
+    std::vector<u32> invocations; ///< Position in the draw of each invocation
+    std::vector<AttributeBuffer> outputs;
+    u32 num_reshaded{};
+};
+
+} // namespace Pica
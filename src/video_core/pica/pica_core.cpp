@@ -3,6 +3,8 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bitset>
+#include <thread>
 #include "common/arch.h"
 #include "common/archives.h"
 #include "common/profiling.h"
@@ -11,6 +13,7 @@
 #include "core/core.h"
 #include "core/memory.h"
 #include "video_core/debug_utils/debug_utils.h"
+#include "video_core/pica/parallel_vertex_shader.h"
 #include "video_core/pica/pica_core.h"
 #include "video_core/pica/vertex_loader.h"
 #include "video_core/rasterizer_interface.h"
@@ -20,6 +23,16 @@ namespace Pica {
 
 using namespace DebugUtils;
 
+namespace {
+
+/// Number of vertex shader invocations gathered into a single ShaderEngine::RunBatch call.
+constexpr std::size_t VERTEX_BATCH_SIZE = 8;
+
+/// Draws with fewer vertices are always shaded on the emulation thread.
+constexpr u32 PARALLEL_SHADING_THRESHOLD = 1024;
+
+} // Anonymous namespace
+
 union CommandHeader {
     u32 hex;
     BitField<0, 16, u32> cmd_id;
@@ -35,6 +48,11 @@ PicaCore::PicaCore(Memory::MemorySystem& memory_, std::shared_ptr<DebugContext>
       shader_engine{CreateEngine(Settings::values.use_shader_jit.GetValue())} {
     InitializeRegs();
 
+    if (Settings::values.use_parallel_vertex_shading) {
+        const std::size_t num_workers = std::max(std::thread::hardware_concurrency(), 2U);
+        parallel_shader = std::make_unique<ParallelVertexShader>(num_workers);
+    }
+
     const auto submit_vertex = [this](const AttributeBuffer& buffer) {
         const auto add_triangle = [this](const OutputVertex& v0, const OutputVertex& v1,
                                          const OutputVertex& v2) {
@@ -117,6 +135,10 @@ void PicaCore::ProcessCmdList(PAddr list, u32 size) {
     }
 }
 
+void PicaCore::LoadShaderDiskCache(u64 title_id) {
+    shader_engine->LoadDiskCache(title_id);
+}
+
 void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
     if (id >= RegsInternal::NUM_REGS) {
         LOG_ERROR(
@@ -136,7 +158,11 @@ void PicaCore::WriteInternalReg(u32 id, u32 value, u32 mask) {
     // TODO: Figure out how register masking acts on e.g. vs.uniform_setup.set_value
     const u32 old_value = regs.internal.reg_array[id];
     const u32 write_mask = ExpandBitsToBytes[mask];
-    regs.internal.reg_array[id] = (old_value & ~write_mask) | (value & write_mask);
+    const u32 new_value = (old_value & ~write_mask) | (value & write_mask);
+
+    // Let the rasterizer retire any deferred work that depends on the previous state.
+    rasterizer->NotifyPicaRegisterChanging(id, new_value);
+    regs.internal.reg_array[id] = new_value;
 
     // Track register write.
     DebugUtils::OnPicaRegWrite(id, mask, regs.internal.reg_array[id]);
@@ -544,16 +570,23 @@ void PicaCore::LoadVertices(bool is_indexed) {
     const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
     const bool index_u16 = index_info.format != 0;
 
-    // Simple circular-replacement vertex cache
-    const std::size_t VERTEX_CACHE_SIZE = 64;
-    std::array<bool, VERTEX_CACHE_SIZE> vertex_cache_valid{};
-    std::array<u16, VERTEX_CACHE_SIZE> vertex_cache_ids;
-    std::array<AttributeBuffer, VERTEX_CACHE_SIZE> vertex_cache;
-    u32 vertex_cache_pos = 0;
+    // Vertex shader outputs of indexed draws are kept in the vertex cache arena.
+    vertex_cache.Reset();
 
-    // Compile the vertex shader for this batch.
+    // Vertices are gathered into batches which are shaded with a single engine call, then
+    // submitted in their original order. Queued vertices of indexed draws reference their vertex
+    // cache slot, other queued vertices reference their position in the batch.
+    constexpr std::size_t VERTEX_QUEUE_SIZE = 32;
     ShaderUnit shader_unit;
-    AttributeBuffer vs_output;
+    std::array<AttributeBuffer, VERTEX_BATCH_SIZE> batch_inputs;
+    std::array<AttributeBuffer, VERTEX_BATCH_SIZE> batch_outputs;
+    std::array<AttributeBuffer*, VERTEX_BATCH_SIZE> batch_destinations;
+    std::array<u32, VERTEX_QUEUE_SIZE> queued;
+    std::bitset<VertexCache::NUM_SLOTS> queued_slots;
+    u32 num_batched = 0;
+    u32 num_queued = 0;
+
+    // Compile the vertex shader for this batch.
     shader_engine->SetupBatch(vs_setup, regs.internal.vs.main_offset);
 
     // Setup geometry pipeline in case we are using a geometry shader.
@@ -561,55 +594,131 @@ void PicaCore::LoadVertices(bool is_indexed) {
     geometry_pipeline.Setup(shader_engine.get());
     ASSERT(!geometry_pipeline.NeedIndexInput() || is_indexed);
 
+    // Large draws can be shaded on the vertex workers. Draws stay serial when the debugger breaks
+    // on every invocation, or when the geometry shader reads the indices instead of vertices.
+    const bool break_on_invocations =
+        debug_context &&
+        debug_context->breakpoints[static_cast<int>(DebugContext::Event::VertexShaderInvocation)]
+            .enabled;
+    shaded_last_draw_in_parallel = parallel_shader && !break_on_invocations &&
+                                   pipeline.num_vertices >= PARALLEL_SHADING_THRESHOLD &&
+                                   !geometry_pipeline.NeedIndexInput();
+    if (shaded_last_draw_in_parallel) {
+        ShadeVerticesParallel(loader, is_indexed, index_address_8, index_u16);
+        return;
+    }
+
+    const auto execute_batch = [&] {
+        shader_engine->RunBatch(vs_setup, regs.internal.vs, shader_unit,
+                                std::span{batch_inputs.data(), num_batched},
+                                std::span{batch_destinations.data(), num_batched});
+
+        // Send to geometry pipeline
+        for (u32 i = 0; i < num_queued; ++i) {
+            geometry_pipeline.SubmitVertex(is_indexed ? vertex_cache.Output(queued[i])
+                                                      : batch_outputs[queued[i]]);
+        }
+        num_batched = 0;
+        num_queued = 0;
+        queued_slots.reset();
+    };
+
     for (u32 index = 0; index < pipeline.num_vertices; ++index) {
         // Indexed rendering doesn't use the start offset
         const u32 vertex = is_indexed
                                ? (index_u16 ? index_address_16[index] : index_address_8[index])
                                : (index + pipeline.vertex_offset);
 
-        bool vertex_cache_hit = false;
         if (is_indexed) {
             if (geometry_pipeline.NeedIndexInput()) {
                 geometry_pipeline.SubmitIndex(vertex);
                 continue;
             }
 
-            for (u32 i = 0; i < VERTEX_CACHE_SIZE; ++i) {
-                if (vertex_cache_valid[i] && vertex == vertex_cache_ids[i]) {
-                    vs_output = vertex_cache[i];
-                    vertex_cache_hit = true;
-                    break;
+            // Hits on vertices still waiting in the batch are fine, their slot is written before
+            // anything is submitted.
+            const u32 slot = VertexCache::SlotOf(vertex);
+            if (vertex_cache.Lookup(vertex)) {
+                queued[num_queued++] = slot;
+                queued_slots.set(slot);
+                if (num_queued == VERTEX_QUEUE_SIZE) {
+                    execute_batch();
                 }
+                continue;
+            }
+
+            // Evicting a slot the queue still references would change its output.
+            if (queued_slots.test(slot)) {
+                execute_batch();
             }
         }
 
-        if (!vertex_cache_hit) {
-            // Initialize data for the current vertex
-            AttributeBuffer input;
-            loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
+        // Initialize data for the current vertex, queueing its vertex shader invocation.
+        const u32 batch_index = num_batched++;
+        AttributeBuffer& input = batch_inputs[batch_index];
+        loader.LoadVertex(base_address, index, vertex, input, input_default_attributes);
 
-            // Record vertex processing to the debugger.
-            if (debug_context) {
-                debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
-                                       std::addressof(input));
-            }
+        // Record vertex processing to the debugger.
+        if (debug_context) {
+            debug_context->OnEvent(DebugContext::Event::VertexShaderInvocation,
+                                   std::addressof(input));
+        }
 
-            // Invoke the vertex shader for this vertex.
-            shader_unit.LoadInput(regs.internal.vs, input);
-            shader_engine->Run(vs_setup, shader_unit);
-            shader_unit.WriteOutput(regs.internal.vs, vs_output);
-
-            // Cache the vertex when doing indexed rendering.
-            if (is_indexed) {
-                vertex_cache[vertex_cache_pos] = vs_output;
-                vertex_cache_valid[vertex_cache_pos] = true;
-                vertex_cache_ids[vertex_cache_pos] = vertex;
-                vertex_cache_pos = (vertex_cache_pos + 1) % VERTEX_CACHE_SIZE;
-            }
+        // Cache the vertex when doing indexed rendering, the output is written to its slot.
+        if (is_indexed) {
+            const u32 slot = vertex_cache.Insert(vertex);
+            batch_destinations[batch_index] = &vertex_cache.Output(slot);
+            queued[num_queued++] = slot;
+            queued_slots.set(slot);
+        } else {
+            batch_destinations[batch_index] = &batch_outputs[batch_index];
+            queued[num_queued++] = batch_index;
         }
 
-        // Send to geometry pipeline
-        geometry_pipeline.SubmitVertex(vs_output);
+        if (num_batched == VERTEX_BATCH_SIZE || num_queued == VERTEX_QUEUE_SIZE) {
+            execute_batch();
+        }
+    }
+
+    if (num_queued != 0) {
+        execute_batch();
+    }
+
+    if (is_indexed) {
+        [[maybe_unused]] const auto& stats = vertex_cache.Stats();
+        LOG_TRACE(HW_GPU, "Vertex cache: {} hits, {} misses ({:.1f}% hit rate)", stats.hits,
+                  stats.misses, stats.HitRate() * 100.0);
+    }
+}
+
+void PicaCore::ShadeVerticesParallel(const VertexLoader& loader, bool is_indexed,
+                                     const u8* index_address_8, bool index_u16) {
+    const auto& pipeline = regs.internal.pipeline;
+    const PAddr base_address = pipeline.vertex_attributes.GetPhysicalBaseAddress();
+    const u16* index_address_16 = reinterpret_cast<const u16*>(index_address_8);
+    const u32 num_vertices = pipeline.num_vertices;
+
+    parallel_vertices.resize(num_vertices);
+    for (u32 index = 0; index < num_vertices; ++index) {
+        // Indexed rendering doesn't use the start offset
+        parallel_vertices[index] = is_indexed
+                                       ? (index_u16 ? index_address_16[index]
+                                                    : index_address_8[index])
+                                       : (index + pipeline.vertex_offset);
+    }
+
+    // Indexed draws follow the lookups of the vertex cache, so the same vertices are shaded
+    // as on the serial path.
+    parallel_shader->Shade(*shader_engine, vs_setup, regs.internal.vs, parallel_vertices,
+                           is_indexed ? &vertex_cache : nullptr,
+                           [&](u32 index, u32 vertex, AttributeBuffer& input) {
+                               loader.LoadVertex(base_address, index, vertex, input,
+                                                 input_default_attributes);
+                           });
+
+    // Send to geometry pipeline
+    for (u32 index = 0; index < num_vertices; ++index) {
+        geometry_pipeline.SubmitVertex(parallel_shader->Output(index));
     }
 }
 
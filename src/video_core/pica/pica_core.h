@@ -14,6 +14,7 @@
 #include "video_core/pica/regs_lcd.h"
 #include "video_core/pica/shader_setup.h"
 #include "video_core/pica/shader_unit.h"
+#include "video_core/pica/vertex_cache.h"
 
 namespace Memory {
 class MemorySystem;
@@ -26,7 +27,9 @@ class RasterizerInterface;
 namespace Pica {
 
 class DebugContext;
+class ParallelVertexShader;
 class ShaderEngine;
+class VertexLoader;
 
 class PicaCore {
 public:
@@ -39,6 +42,19 @@ public:
 
     void ProcessCmdList(PAddr list, u32 size);
 
+    /// Prepares the shaders that the title used in previous sessions.
+    void LoadShaderDiskCache(u64 title_id);
+
+    /// Returns the vertex cache statistics of the last draw.
+    const VertexCacheStats& GetVertexCacheStats() const {
+        return vertex_cache.Stats();
+    }
+
+    /// Returns whether the vertices of the last draw were shaded on the vertex workers.
+    bool ShadedLastDrawInParallel() const {
+        return shaded_last_draw_in_parallel;
+    }
+
 private:
     void InitializeRegs();
 
@@ -52,6 +68,10 @@ private:
 
     void LoadVertices(bool is_indexed);
 
+    /// Shades all vertices of the current draw on the vertex workers, then submits them in order.
+    void ShadeVerticesParallel(const VertexLoader& loader, bool is_indexed,
+                               const u8* index_address_8, bool index_u16);
+
 public:
     union Regs {
         static constexpr std::size_t NUM_REGS = 0x732;
@@ -281,6 +301,10 @@ private:
     PrimitiveAssembler primitive_assembler;
     CommandList cmd_list;
     std::unique_ptr<ShaderEngine> shader_engine;
+    VertexCache vertex_cache;
+    std::unique_ptr<ParallelVertexShader> parallel_shader;
+    std::vector<u32> parallel_vertices;
+    bool shaded_last_draw_in_parallel = false;
 };
 
 #define GPU_REG_INDEX(field_name) (offsetof(Pica::PicaCore::Regs, field_name) / sizeof(u32))
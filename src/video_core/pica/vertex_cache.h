@@ -0,0 +1,80 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <vector>
+#include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
+
+namespace Pica {
+
+/// Vertex cache statistics of a single draw.
+struct VertexCacheStats {
+    u32 hits{};
+    u32 misses{};
+
+    [[nodiscard]] double HitRate() const {
+        const u32 lookups = hits + misses;
+        return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+    }
+};
+
+/**
+ * Direct-mapped cache of vertex shader outputs used during indexed draws. Each vertex index maps
+ * to exactly one slot, and outputs are kept in an arena indexed by slot so that hits can be
+ * referenced instead of copied.
+ */
+class VertexCache {
+public:
+    static constexpr u32 NUM_SLOTS = 256;
+
+    VertexCache() : outputs(NUM_SLOTS) {}
+
+    /// Invalidates all slots and clears the statistics. Call this before every draw.
+    void Reset() {
+        tags.fill(INVALID_TAG);
+        stats = {};
+    }
+
+    /// Returns the slot the vertex maps to.
+    [[nodiscard]] static constexpr u32 SlotOf(u32 vertex) {
+        return vertex % NUM_SLOTS;
+    }
+
+    /// Returns true and updates the statistics if the output of the vertex is cached.
+    bool Lookup(u32 vertex) {
+        if (tags[SlotOf(vertex)] == vertex) {
+            ++stats.hits;
+            return true;
+        }
+        ++stats.misses;
+        return false;
+    }
+
+    /// Assigns the slot of the vertex to it, evicting the previous occupant.
+    u32 Insert(u32 vertex) {
+        const u32 slot = SlotOf(vertex);
+        tags[slot] = vertex;
+        return slot;
+    }
+
+    [[nodiscard]] AttributeBuffer& Output(u32 slot) {
+        return outputs[slot];
+    }
+
+    [[nodiscard]] const VertexCacheStats& Stats() const {
+        return stats;
+    }
+
+private:
+    static constexpr u32 INVALID_TAG = 0xFFFFFFFF;
+
+    std::array<u32, NUM_SLOTS> tags;
+    std::vector<AttributeBuffer> outputs;
+    VertexCacheStats stats;
+};
+
+} // namespace Pica
@@ -19,6 +19,7 @@ RendererSoftware::RendererSoftware(Core::System& system, Pica::PicaCore& pica_,
 RendererSoftware::~RendererSoftware() = default;
 
 void RendererSoftware::SwapBuffers() {
+    rasterizer.FlushAll();
     PrepareRenderTarget();
     EndFrame();
 }
@@ -0,0 +1,139 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/arch.h"
+#include "video_core/renderer_software/sw_coverage.h"
+
+#if BORKED3DS_ARCH(x86_64)
+#include <immintrin.h>
+#include "common/x64/cpu_detect.h"
+#elif BORKED3DS_ARCH(arm64)
+#include <arm_neon.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define TARGET_AVX2
+#endif
+
+namespace SwRenderer {
+
+namespace {
+
+constexpr u32 SpanMask(u32 count) {
+    return count >= MAX_SPAN_PIXELS ? ~0U : (1U << count) - 1;
+}
+
+#if BORKED3DS_ARCH(x86_64)
+
+u32 CoverageMaskSSE2(const EdgeSpan& span, u32 count) {
+    __m128i w[3];
+    __m128i step[3];
+    __m128i bias[3];
+    for (u32 edge = 0; edge < 3; edge++) {
+        w[edge] = _mm_setr_epi32(span.At(edge, 0), span.At(edge, 1), span.At(edge, 2),
+                                 span.At(edge, 3));
+        step[edge] = _mm_set1_epi32(static_cast<s32>(static_cast<u32>(span.step[edge]) * 4));
+        bias[edge] = _mm_set1_epi32(span.bias[edge]);
+    }
+
+    u32 mask = 0;
+    for (u32 i = 0; i < count; i += 4) {
+        const __m128i outside = _mm_or_si128(_mm_or_si128(_mm_cmplt_epi32(w[0], bias[0]),
+                                                          _mm_cmplt_epi32(w[1], bias[1])),
+                                             _mm_cmplt_epi32(w[2], bias[2]));
+        mask |= static_cast<u32>(~_mm_movemask_ps(_mm_castsi128_ps(outside)) & 0xF) << i;
+        for (u32 edge = 0; edge < 3; edge++) {
+            w[edge] = _mm_add_epi32(w[edge], step[edge]);
+        }
+    }
+    return mask & SpanMask(count);
+}
+
+TARGET_AVX2 u32 CoverageMaskAVX2(const EdgeSpan& span, u32 count) {
+    __m256i w[3];
+    __m256i step[3];
+    __m256i bias[3];
+    for (u32 edge = 0; edge < 3; edge++) {
+        w[edge] = _mm256_setr_epi32(span.At(edge, 0), span.At(edge, 1), span.At(edge, 2),
+                                    span.At(edge, 3), span.At(edge, 4), span.At(edge, 5),
+                                    span.At(edge, 6), span.At(edge, 7));
+        step[edge] = _mm256_set1_epi32(static_cast<s32>(static_cast<u32>(span.step[edge]) * 8));
+        bias[edge] = _mm256_set1_epi32(span.bias[edge]);
+    }
+
+    u32 mask = 0;
+    for (u32 i = 0; i < count; i += 8) {
+        const __m256i outside =
+            _mm256_or_si256(_mm256_or_si256(_mm256_cmpgt_epi32(bias[0], w[0]),
+                                            _mm256_cmpgt_epi32(bias[1], w[1])),
+                            _mm256_cmpgt_epi32(bias[2], w[2]));
+        mask |= static_cast<u32>(~_mm256_movemask_ps(_mm256_castsi256_ps(outside)) & 0xFF) << i;
+        for (u32 edge = 0; edge < 3; edge++) {
+            w[edge] = _mm256_add_epi32(w[edge], step[edge]);
+        }
+    }
+    return mask & SpanMask(count);
+}
+
+#elif BORKED3DS_ARCH(arm64)
+
+u32 CoverageMaskNEON(const EdgeSpan& span, u32 count) {
+    int32x4_t w[3];
+    int32x4_t step[3];
+    int32x4_t bias[3];
+    for (u32 edge = 0; edge < 3; edge++) {
+        const std::array<s32, 4> lanes = {span.At(edge, 0), span.At(edge, 1), span.At(edge, 2),
+                                          span.At(edge, 3)};
+        w[edge] = vld1q_s32(lanes.data());
+        step[edge] = vdupq_n_s32(static_cast<s32>(static_cast<u32>(span.step[edge]) * 4));
+        bias[edge] = vdupq_n_s32(span.bias[edge]);
+    }
+
+    static constexpr std::array<u32, 4> lane_bits = {1, 2, 4, 8};
+    const uint32x4_t bits = vld1q_u32(lane_bits.data());
+
+    u32 mask = 0;
+    for (u32 i = 0; i < count; i += 4) {
+        const uint32x4_t inside = vandq_u32(vandq_u32(vcgeq_s32(w[0], bias[0]),
+                                                      vcgeq_s32(w[1], bias[1])),
+                                            vcgeq_s32(w[2], bias[2]));
+        mask |= vaddvq_u32(vandq_u32(inside, bits)) << i;
+        for (u32 edge = 0; edge < 3; edge++) {
+            w[edge] = vaddq_s32(w[edge], step[edge]);
+        }
+    }
+    return mask & SpanMask(count);
+}
+
+#endif
+
+} // Anonymous namespace
+
+u32 CoverageMaskScalar(const EdgeSpan& span, u32 count) {
+    u32 mask = 0;
+    for (u32 i = 0; i < count; i++) {
+        if (span.At(0, i) >= span.bias[0] && span.At(1, i) >= span.bias[1] &&
+            span.At(2, i) >= span.bias[2]) {
+            mask |= 1U << i;
+        }
+    }
+    return mask;
+}
+
+CoverageFunc GetCoverageFunc() {
+#if BORKED3DS_ARCH(x86_64)
+    if (Common::GetCPUCaps().avx2) {
+        return CoverageMaskAVX2;
+    }
+    return CoverageMaskSSE2;
+#elif BORKED3DS_ARCH(arm64)
+    return CoverageMaskNEON;
+#else
+    return CoverageMaskScalar;
+#endif
+}
+
+} // namespace SwRenderer
@@ -0,0 +1,43 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+
+namespace SwRenderer {
+
+/// Maximum number of pixels a single coverage query can test.
+constexpr u32 MAX_SPAN_PIXELS = 32;
+
+/**
+ * Edge function values of the three triangle edges at the first pixel of a horizontal span,
+ * along with their increments when stepping one pixel to the right. Edge values are evaluated
+ * with wrapping 32-bit arithmetic, which matches evaluating SignedArea at every pixel.
+ **/
+struct EdgeSpan {
+    std::array<s32, 3> w;
+    std::array<s32, 3> step;
+    std::array<s32, 3> bias;
+
+    /// Returns the value of the specified edge function at pixel i of the span.
+    s32 At(u32 edge, u32 i) const {
+        return static_cast<s32>(static_cast<u32>(w[edge]) + static_cast<u32>(step[edge]) * i);
+    }
+};
+
+/**
+ * Returns a mask with bit i set when pixel i of the span is covered by the triangle, i.e. all
+ * edge values are greater than or equal to their bias. Only the first count pixels are tested.
+ **/
+using CoverageFunc = u32 (*)(const EdgeSpan& span, u32 count);
+
+/// Portable implementation used as a reference and as a fallback.
+u32 CoverageMaskScalar(const EdgeSpan& span, u32 count);
+
+/// Returns the fastest coverage implementation supported by the host CPU.
+CoverageFunc GetCoverageFunc();
+
+} // namespace SwRenderer
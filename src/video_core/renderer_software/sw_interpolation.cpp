@@ -0,0 +1,187 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include "common/arch.h"
+#include "common/vector_math.h"
+#include "video_core/renderer_software/sw_interpolation.h"
+
+#if BORKED3DS_ARCH(x86_64)
+#include <emmintrin.h>
+#endif
+
+namespace SwRenderer {
+
+using Pica::f24;
+
+namespace {
+
+#if BORKED3DS_ARCH(x86_64)
+
+/**
+ * Four lanes of f24 arithmetic. Each operation is performed in single precision and then
+ * truncated like f24 does, so that results are bit-identical to the scalar f24 operators.
+ **/
+class F24x4 {
+public:
+    static __m128 Select(__m128 mask, __m128 a, __m128 b) {
+        return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+    }
+
+    /// Equivalent of f24::FromFloat32.
+    static __m128 Trunc(__m128 v) {
+        const __m128 abs = _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF)));
+        const __m128 sign = _mm_and_ps(v, _mm_castsi128_ps(_mm_set1_epi32(0x80000000)));
+        const __m128 tiny = _mm_cmplt_ps(abs, _mm_set1_ps(f24::MinNormal().ToFloat32()));
+        const __m128 huge = _mm_cmpgt_ps(abs, _mm_set1_ps(f24::Max().ToFloat32()));
+        const __m128 nan = _mm_cmpunord_ps(v, v);
+        const __m128 inf = _mm_or_ps(sign, _mm_set1_ps(std::numeric_limits<float>::infinity()));
+
+        // Flush values below the normal range and saturate values above it to infinity
+        __m128 result = Select(huge, inf, _mm_andnot_ps(tiny, v));
+        // Drop the mantissa bits f24 does not have. Zero and infinity are unaffected.
+        const __m128 truncated = _mm_and_ps(result, _mm_castsi128_ps(_mm_set1_epi32(MANTISSA)));
+        return Select(nan, result, truncated);
+    }
+
+    static __m128 Mul(__m128 a, __m128 b) {
+        const __m128 result = _mm_mul_ps(a, b);
+        // PICA gives 0 instead of NaN when multiplying by inf
+        const __m128 nan_inputs = _mm_or_ps(_mm_cmpunord_ps(a, a), _mm_cmpunord_ps(b, b));
+        const __m128 zero = _mm_andnot_ps(nan_inputs, _mm_cmpunord_ps(result, result));
+        return Trunc(_mm_andnot_ps(zero, result));
+    }
+
+    static __m128 Add(__m128 a, __m128 b) {
+        return Trunc(_mm_add_ps(a, b));
+    }
+
+    static __m128 Div(__m128 a, __m128 b) {
+        return Trunc(_mm_div_ps(a, b));
+    }
+
+    /// Equivalent of Common::Dot on Vec3<f24>.
+    static __m128 Dot(const std::array<f24, 3>& a, __m128 b0, __m128 b1, __m128 b2) {
+        return Add(Add(Mul(_mm_set1_ps(a[0].ToFloat32()), b0),
+                       Mul(_mm_set1_ps(a[1].ToFloat32()), b1)),
+                   Mul(_mm_set1_ps(a[2].ToFloat32()), b2));
+    }
+
+private:
+    /// Keeps the 16 mantissa bits of f24
+    static constexpr s32 MANTISSA = static_cast<s32>(0xFFFFFFFFU << (23 - 16));
+};
+
+void InterpolateSSE2(const InterpolationSetup& setup, const EdgeSpan& span, u32 coverage,
+                     SpanValues& values) {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 one = _mm_set1_ps(1.0f);
+
+    for (u32 i = 0; i < MAX_SPAN_PIXELS; i += 4) {
+        if (((coverage >> i) & 0xF) == 0) {
+            continue;
+        }
+
+        const auto load_edge = [&](u32 edge) {
+            return _mm_setr_epi32(span.At(edge, i), span.At(edge, i + 1), span.At(edge, i + 2),
+                                  span.At(edge, i + 3));
+        };
+        const __m128i w0 = load_edge(0);
+        const __m128i w1 = load_edge(1);
+        const __m128i w2 = load_edge(2);
+        const __m128 w0f = _mm_cvtepi32_ps(w0);
+        const __m128 w1f = _mm_cvtepi32_ps(w1);
+        const __m128 w2f = _mm_cvtepi32_ps(w2);
+        const __m128 bary0 = F24x4::Trunc(w0f);
+        const __m128 bary1 = F24x4::Trunc(w1f);
+        const __m128 bary2 = F24x4::Trunc(w2f);
+        const __m128 wsum = _mm_cvtepi32_ps(_mm_add_epi32(_mm_add_epi32(w0, w1), w2));
+        const __m128 w_inverse = F24x4::Div(one, F24x4::Dot(setup.w_inverse, bary0, bary1, bary2));
+
+        // The depth is interpolated in single precision rather than f24
+        const __m128 z_over_w = _mm_div_ps(
+            _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(_mm_set1_ps(setup.z[0]), w0f),
+                           _mm_mul_ps(_mm_set1_ps(setup.z[1]), w1f)),
+                _mm_mul_ps(_mm_set1_ps(setup.z[2]), w2f)),
+            wsum);
+        __m128 depth = _mm_add_ps(_mm_mul_ps(z_over_w, _mm_set1_ps(setup.depth_scale)),
+                                  _mm_set1_ps(setup.depth_offset));
+        if (setup.w_buffer) {
+            depth = _mm_mul_ps(depth, _mm_mul_ps(w_inverse, wsum));
+        }
+        // Same as std::clamp, which keeps NaN
+        depth = F24x4::Select(_mm_cmplt_ps(depth, zero), zero, depth);
+        depth = F24x4::Select(_mm_cmplt_ps(one, depth), one, depth);
+        _mm_storeu_ps(values.depth.data() + i, depth);
+
+        for (u32 attribute = 0; attribute < setup.num_attributes; attribute++) {
+            const __m128 over_w = F24x4::Dot(setup.attributes[attribute], bary0, bary1, bary2);
+            _mm_storeu_ps(values.attributes[attribute].data() + i, F24x4::Mul(over_w, w_inverse));
+        }
+    }
+}
+
+#endif
+
+} // Anonymous namespace
+
+void InterpolateScalar(const InterpolationSetup& setup, const EdgeSpan& span, u32 coverage,
+                       SpanValues& values) {
+    const auto w_inverse = Common::MakeVec(setup.w_inverse[0], setup.w_inverse[1],
+                                           setup.w_inverse[2]);
+    while (coverage != 0) {
+        const u32 i = std::countr_zero(coverage);
+        coverage &= coverage - 1;
+
+        // Barycentric coordinates w0, w1 and w2 of the current pixel
+        const s32 w0 = span.At(0, i);
+        const s32 w1 = span.At(1, i);
+        const s32 w2 = span.At(2, i);
+        const s32 wsum =
+            static_cast<s32>(static_cast<u32>(w0) + static_cast<u32>(w1) + static_cast<u32>(w2));
+
+        const auto barycentric = Common::MakeVec(f24::FromFloat32(static_cast<f32>(w0)),
+                                                 f24::FromFloat32(static_cast<f32>(w1)),
+                                                 f24::FromFloat32(static_cast<f32>(w2)));
+        const f24 interpolated_w_inverse = f24::One() / Common::Dot(w_inverse, barycentric);
+
+        // interpolated_z = z / w
+        const float interpolated_z_over_w = (setup.z[0] * static_cast<f32>(w0) +
+                                             setup.z[1] * static_cast<f32>(w1) +
+                                             setup.z[2] * static_cast<f32>(w2)) /
+                                            static_cast<f32>(wsum);
+
+        // Not fully accurate. About 3 bits in precision are missing.
+        // Z-Buffer (z / w * scale + offset)
+        float depth = interpolated_z_over_w * setup.depth_scale + setup.depth_offset;
+
+        // Potentially switch to W-Buffer
+        if (setup.w_buffer) {
+            // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
+            depth *= interpolated_w_inverse.ToFloat32() * static_cast<f32>(wsum);
+        }
+        values.depth[i] = std::clamp(depth, 0.0f, 1.0f);
+
+        // Attributes divided by w are linear in screen space, see RasterizeTriangle.
+        for (u32 attribute = 0; attribute < setup.num_attributes; attribute++) {
+            const auto& attr = setup.attributes[attribute];
+            const f24 attr_over_w =
+                Common::Dot(Common::MakeVec(attr[0], attr[1], attr[2]), barycentric);
+            values.attributes[attribute][i] = (attr_over_w * interpolated_w_inverse).ToFloat32();
+        }
+    }
+}
+
+InterpolateFunc GetInterpolateFunc() {
+#if BORKED3DS_ARCH(x86_64)
+    return InterpolateSSE2;
+#else
+    return InterpolateScalar;
+#endif
+}
+
+} // namespace SwRenderer
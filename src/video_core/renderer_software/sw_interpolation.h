@@ -0,0 +1,81 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include "common/common_types.h"
+#include "video_core/pica_types.h"
+#include "video_core/renderer_software/sw_coverage.h"
+
+namespace SwRenderer {
+
+/// Vertex attributes interpolated across a span, in the order they are stored in SpanValues.
+enum class Attribute : u32 {
+    ColorR,
+    ColorG,
+    ColorB,
+    ColorA,
+    Tc0U,
+    Tc0V,
+    Tc1U,
+    Tc1V,
+    Tc2U,
+    Tc2V,
+    Tc0W,
+    // Only needed by fragment lighting
+    QuatX,
+    QuatY,
+    QuatZ,
+    QuatW,
+    ViewX,
+    ViewY,
+    ViewZ,
+    Count,
+};
+
+constexpr u32 NUM_UNLIT_ATTRIBUTES = static_cast<u32>(Attribute::QuatX);
+constexpr u32 NUM_ATTRIBUTES = static_cast<u32>(Attribute::Count);
+
+/// Per triangle inputs of the span interpolation.
+struct InterpolationSetup {
+    /// 1/w of each vertex.
+    std::array<Pica::f24, 3> w_inverse;
+    /// Screen space z/w of each vertex.
+    std::array<float, 3> z;
+    /// Value of each attribute divided by w, for each vertex.
+    std::array<std::array<Pica::f24, 3>, NUM_ATTRIBUTES> attributes;
+    float depth_scale;
+    float depth_offset;
+    bool w_buffer;
+    /// Either NUM_UNLIT_ATTRIBUTES or NUM_ATTRIBUTES.
+    u32 num_attributes;
+};
+
+/// Depth and perspective correct attributes of the pixels of a span.
+struct SpanValues {
+    std::array<float, MAX_SPAN_PIXELS> depth;
+    /// Values are exact f24 values, stored as floats.
+    std::array<std::array<float, MAX_SPAN_PIXELS>, NUM_ATTRIBUTES> attributes;
+
+    float Get(Attribute attribute, u32 i) const {
+        return attributes[static_cast<u32>(attribute)][i];
+    }
+};
+
+/**
+ * Computes the depth and the attributes of the pixels of the span whose bit is set in coverage,
+ * using the edge values of the span as barycentric coordinates. Other pixels are left undefined.
+ **/
+using InterpolateFunc = void (*)(const InterpolationSetup& setup, const EdgeSpan& span,
+                                 u32 coverage, SpanValues& values);
+
+/// Portable implementation, one pixel at a time with f24 arithmetic. Used as the reference.
+void InterpolateScalar(const InterpolationSetup& setup, const EdgeSpan& span, u32 coverage,
+                       SpanValues& values);
+
+/// Returns the fastest interpolation implementation supported by the host CPU.
+InterpolateFunc GetInterpolateFunc();
+
+} // namespace SwRenderer
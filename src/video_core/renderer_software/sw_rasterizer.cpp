@@ -3,10 +3,12 @@
 // Licensed under GPLv2 or any later version
 // Refer to the license.txt file included.
 
+#include <bit>
 #include <boost/container/static_vector.hpp>
 #include "common/logging/log.h"
 #include "common/profiling.h"
 #include "common/quaternion.h"
+#include "common/settings.h"
 #include "common/vector_math.h"
 #include "core/memory.h"
 #include "video_core/pica/output_vertex.h"
@@ -33,39 +35,20 @@ using Pica::Texture::TextureInfo;
 // we can use a very small epsilon value for clip plane comparison.
 constexpr f32 EPSILON_Z = 0.f;
 
-struct Vertex : Pica::OutputVertex {
-    Vertex(const OutputVertex& v) : OutputVertex(v) {}
+// Screen tiles used by the binned rasterizer are 32x32 pixels. The grid covers the entire
+// 12.4 fixed point coordinate range so no triangle ever needs to be clamped into it.
+constexpr u32 TILE_SHIFT = 5 + 4;
+constexpr u32 TILE_SIZE = 1U << TILE_SHIFT;
+constexpr u32 NUM_TILES_X = 0x10000 >> TILE_SHIFT;
+constexpr u32 NUM_TILES_Y = 0x10000 >> TILE_SHIFT;
 
-    /// Attributes used to store intermediate results position after perspective divide.
-    Common::Vec3<f24> screenpos;
+// Upper bound of triangles kept in the bins before the next draw forces a flush.
+constexpr std::size_t MAX_BINNED_TRIANGLES = 0x10000;
 
-    /**
-     * Linear interpolation
-     * factor: 0=this, 1=vtx
-     * Note: This function cannot be called after perspective divide.
-     **/
-    void Lerp(f24 factor, const Vertex& vtx) {
-        pos = pos * factor + vtx.pos * (f24::One() - factor);
-        quat = quat * factor + vtx.quat * (f24::One() - factor);
-        color = color * factor + vtx.color * (f24::One() - factor);
-        tc0 = tc0 * factor + vtx.tc0 * (f24::One() - factor);
-        tc1 = tc1 * factor + vtx.tc1 * (f24::One() - factor);
-        tc0_w = tc0_w * factor + vtx.tc0_w * (f24::One() - factor);
-        view = view * factor + vtx.view * (f24::One() - factor);
-        tc2 = tc2 * factor + vtx.tc2 * (f24::One() - factor);
-    }
-
-    /**
-     * Linear interpolation
-     * factor: 0=v0, 1=v1
-     * Note: This function cannot be called after perspective divide.
-     **/
-    static Vertex Lerp(f24 factor, const Vertex& v0, const Vertex& v1) {
-        Vertex ret = v0;
-        ret.Lerp(factor, v1);
-        return ret;
-    }
-};
+// Register range holding the state consumed by rasterization (rasterizer, texturing,
+// framebuffer and lighting). Changing any of it requires retiring the binned triangles first.
+constexpr u32 BINNED_STATE_BEGIN = PICA_REG_INDEX(rasterizer);
+constexpr u32 BINNED_STATE_END = PICA_REG_INDEX(pipeline);
 
 namespace {
 
@@ -102,7 +85,16 @@ private:
 RasterizerSoftware::RasterizerSoftware(Memory::MemorySystem& memory_, Pica::PicaCore& pica_)
     : memory{memory_}, pica{pica_}, regs{pica.regs.internal},
       num_sw_threads{std::max(std::thread::hardware_concurrency(), 2U)},
-      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer} {}
+      sw_workers{num_sw_threads, "SwRenderer workers"}, fb{memory, regs.framebuffer},
+      texture_cache{memory, !Settings::values.use_async_gpu.GetValue()},
+      coverage_mask{GetCoverageFunc()}, interpolate{GetInterpolateFunc()},
+      use_tile_binning{Settings::values.use_sw_tile_binning.GetValue()} {
+    if (use_tile_binning) {
+        bins.resize(NUM_TILES_X * NUM_TILES_Y);
+    }
+}
+
+RasterizerSoftware::~RasterizerSoftware() = default;
 
 void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                                      const Pica::OutputVertex& v2) {
@@ -203,6 +195,93 @@ void RasterizerSoftware::AddTriangle(const Pica::OutputVertex& v0, const Pica::O
     }
 }
 
+void RasterizerSoftware::DrawTriangles() {
+    // Binned triangles survive across draws until a state change retires them. Keep the memory
+    // used by the bins bounded for games that rarely touch the rasterization state.
+    if (binned_triangles.size() >= MAX_BINNED_TRIANGLES) {
+        FlushBins();
+    }
+    InvalidateRenderTargets();
+}
+
+void RasterizerSoftware::NotifyPicaRegisterChanged(u32 id) {
+    // The P3D interrupt tells the guest the command list has completed, so everything it
+    // rendered must be visible in memory.
+    if (id == PICA_REG_INDEX(trigger_irq)) {
+        FlushBins();
+    } else if (id >= PICA_REG_INDEX(texturing) && id < PICA_REG_INDEX(framebuffer)) {
+        textures_dirty = true;
+        tev_dirty = true;
+    }
+}
+
+void RasterizerSoftware::NotifyPicaRegisterChanging(u32 id, u32 value) {
+    if (binned_triangles.empty() || id < BINNED_STATE_BEGIN || id >= BINNED_STATE_END) {
+        return;
+    }
+
+    switch (id) {
+    // Look-up table uploads modify state outside the register file, retire unconditionally.
+    case PICA_REG_INDEX(lighting.lut_data[0]):
+    case PICA_REG_INDEX(lighting.lut_data[1]):
+    case PICA_REG_INDEX(lighting.lut_data[2]):
+    case PICA_REG_INDEX(lighting.lut_data[3]):
+    case PICA_REG_INDEX(lighting.lut_data[4]):
+    case PICA_REG_INDEX(lighting.lut_data[5]):
+    case PICA_REG_INDEX(lighting.lut_data[6]):
+    case PICA_REG_INDEX(lighting.lut_data[7]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[0]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[1]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[2]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[3]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[4]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[5]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[6]):
+    case PICA_REG_INDEX(texturing.fog_lut_data[7]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[0]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[1]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[2]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[3]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[4]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[5]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[6]):
+    case PICA_REG_INDEX(texturing.proctex_lut_data[7]):
+        FlushBins();
+        break;
+    default:
+        // Games rewrite most of their state every draw, only retire when a value changes.
+        if (regs.reg_array[id] != value) {
+            FlushBins();
+        }
+        break;
+    }
+}
+
+void RasterizerSoftware::FlushAll() {
+    FlushBins();
+}
+
+void RasterizerSoftware::FlushRegion(PAddr addr, u32 size) {
+    FlushBins();
+}
+
+void RasterizerSoftware::InvalidateRegion(PAddr addr, u32 size) {
+    FlushBins();
+    if (texture_cache.InvalidateRegion(addr, size)) {
+        textures_dirty = true;
+    }
+}
+
+void RasterizerSoftware::FlushAndInvalidateRegion(PAddr addr, u32 size) {
+    InvalidateRegion(addr, size);
+}
+
+void RasterizerSoftware::ClearAll(bool flush) {
+    FlushBins();
+    texture_cache.InvalidateAll();
+    textures_dirty = true;
+}
+
 void RasterizerSoftware::MakeScreenCoords(Vertex& vtx) {
     Viewport viewport{};
     viewport.halfsize_x = f24::FromRaw(regs.rasterizer.viewport_size_x);
@@ -291,18 +370,194 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
     const int bias2 =
         IsRightSideOrFlatBottomEdge(vtxpos[2].xy(), vtxpos[0].xy(), vtxpos[1].xy()) ? 1 : 0;
 
-    const auto w_inverse = Common::MakeVec(v0.pos.w, v1.pos.w, v2.pos.w);
+    const TriangleSetup triangle{
+        .vertices = {v0, v1, v2},
+        .vtxpos = vtxpos,
+        .bias = {bias0, bias1, bias2},
+        .min_x = min_x,
+        .min_y = min_y,
+        .max_x = max_x,
+        .max_y = max_y,
+    };
 
-    const auto textures = regs.texturing.GetTextures();
-    const auto tev_stages = regs.texturing.GetTevStages();
+    if (use_tile_binning) {
+        BinTriangle(triangle);
+        return;
+    }
 
     fb.Bind();
+    BindTextures();
+    BindTevProgram();
 
     // Enter rasterization loop, starting at the center of the topleft bounding box corner.
     // TODO: Not sure if looping through x first might be faster
+    for (u16 y = min_y; y < max_y; y += 0x10) {
+        sw_workers.QueueWork([this, &triangle, y] {
+            RasterizeTriangle(triangle, triangle.min_x, y, triangle.max_x,
+                              static_cast<u16>(y + 0x10));
+        });
+    }
+    sw_workers.WaitForRequests();
+    render_targets_written = true;
+}
+
+void RasterizerSoftware::BinTriangle(const TriangleSetup& triangle) {
+    if (triangle.min_x >= triangle.max_x || triangle.min_y >= triangle.max_y) {
+        return;
+    }
+
+    const u32 index = static_cast<u32>(binned_triangles.size());
+    binned_triangles.push_back(triangle);
+
+    const u32 tile_x_end = ((triangle.max_x - 1) >> TILE_SHIFT) + 1;
+    const u32 tile_y_end = ((triangle.max_y - 1) >> TILE_SHIFT) + 1;
+    for (u32 tile_y = triangle.min_y >> TILE_SHIFT; tile_y < tile_y_end; tile_y++) {
+        for (u32 tile_x = triangle.min_x >> TILE_SHIFT; tile_x < tile_x_end; tile_x++) {
+            const u32 bin_index = tile_y * NUM_TILES_X + tile_x;
+            auto& bin = bins[bin_index];
+            if (bin.empty()) {
+                active_bins.push_back(bin_index);
+            }
+            bin.push_back(index);
+        }
+    }
+}
+
+void RasterizerSoftware::FlushBins() {
+    if (binned_triangles.empty()) {
+        return;
+    }
+
+    BORKED3DS_PROFILE("Software", "Binned Rasterization");
+
+    fb.Bind();
+    BindTextures();
+    BindTevProgram();
+
+    // Each tile owns a disjoint set of pixels, so tiles can be processed concurrently while
+    // triangles inside a tile are still rasterized in submission order.
+    for (const u32 bin_index : active_bins) {
+        sw_workers.QueueWork([this, bin_index] {
+            const u32 tile_min_x = (bin_index % NUM_TILES_X) << TILE_SHIFT;
+            const u32 tile_min_y = (bin_index / NUM_TILES_X) << TILE_SHIFT;
+            const u32 tile_max_x = tile_min_x + TILE_SIZE;
+            const u32 tile_max_y = tile_min_y + TILE_SIZE;
+            for (const u32 index : bins[bin_index]) {
+                const TriangleSetup& triangle = binned_triangles[index];
+                RasterizeTriangle(
+                    triangle, static_cast<u16>(std::max<u32>(triangle.min_x, tile_min_x)),
+                    static_cast<u16>(std::max<u32>(triangle.min_y, tile_min_y)),
+                    static_cast<u16>(std::min<u32>(triangle.max_x, tile_max_x)),
+                    static_cast<u16>(std::min<u32>(triangle.max_y, tile_max_y)));
+            }
+        });
+    }
+    sw_workers.WaitForRequests();
+    render_targets_written = true;
+    InvalidateRenderTargets();
+
+    for (const u32 bin_index : active_bins) {
+        bins[bin_index].clear();
+    }
+    active_bins.clear();
+    binned_triangles.clear();
+}
+
+void RasterizerSoftware::RasterizeTriangle(const TriangleSetup& triangle, u16 min_x, u16 min_y,
+                                           u16 max_x, u16 max_y) {
+    const auto& [v0, v1, v2] = triangle.vertices;
+    const auto& vtxpos = triangle.vtxpos;
+    const auto [bias0, bias1, bias2] = triangle.bias;
+
+    // Convert the scissor box coordinates to 12.4 fixed point
+    const u16 scissor_x1 = static_cast<u16>(regs.rasterizer.scissor_test.x1 << 4);
+    const u16 scissor_y1 = static_cast<u16>(regs.rasterizer.scissor_test.y1 << 4);
+    // x2,y2 have +1 added to cover the entire sub-pixel area
+    const u16 scissor_x2 = static_cast<u16>((regs.rasterizer.scissor_test.x2 + 1) << 4);
+    const u16 scissor_y2 = static_cast<u16>((regs.rasterizer.scissor_test.y2 + 1) << 4);
+
+    const auto textures = regs.texturing.GetTextures();
+
+    /**
+     * Perspective correct attribute interpolation:
+     * Attribute values cannot be calculated by simple linear interpolation since
+     * they are not linear in screen space. For example, when interpolating a
+     * texture coordinate across two vertices, something simple like
+     *     u = (u0*w0 + u1*w1)/(w0+w1)
+     * will not work. However, the attribute value divided by the
+     * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
+     * in screenspace. Hence, we can linearly interpolate these two independently and
+     * calculate the interpolated attribute by dividing the results.
+     * I.e.
+     *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
+     *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
+     *     u = u_over_w / one_over_w
+     *
+     * The generalization to three vertices is straightforward in baricentric
+     * coordinates. MakeScreenCoords already divided the vertex attributes by w.
+     **/
+    InterpolationSetup interpolation{
+        .w_inverse = {v0.pos.w, v1.pos.w, v2.pos.w},
+        .z = {v0.screenpos[2].ToFloat32(), v1.screenpos[2].ToFloat32(),
+              v2.screenpos[2].ToFloat32()},
+        .depth_scale = f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32(),
+        .depth_offset = f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32(),
+        .w_buffer =
+            regs.rasterizer.depthmap_enable == Pica::RasterizerRegs::DepthBuffering::WBuffering,
+        .num_attributes = regs.lighting.disable ? NUM_UNLIT_ATTRIBUTES : NUM_ATTRIBUTES,
+    };
+    const auto set_attribute = [&](Attribute attribute, auto get) {
+        interpolation.attributes[static_cast<u32>(attribute)] = {get(v0), get(v1), get(v2)};
+    };
+    set_attribute(Attribute::ColorR, [](const Vertex& v) { return v.color.r(); });
+    set_attribute(Attribute::ColorG, [](const Vertex& v) { return v.color.g(); });
+    set_attribute(Attribute::ColorB, [](const Vertex& v) { return v.color.b(); });
+    set_attribute(Attribute::ColorA, [](const Vertex& v) { return v.color.a(); });
+    set_attribute(Attribute::Tc0U, [](const Vertex& v) { return v.tc0.u(); });
+    set_attribute(Attribute::Tc0V, [](const Vertex& v) { return v.tc0.v(); });
+    set_attribute(Attribute::Tc1U, [](const Vertex& v) { return v.tc1.u(); });
+    set_attribute(Attribute::Tc1V, [](const Vertex& v) { return v.tc1.v(); });
+    set_attribute(Attribute::Tc2U, [](const Vertex& v) { return v.tc2.u(); });
+    set_attribute(Attribute::Tc2V, [](const Vertex& v) { return v.tc2.v(); });
+    set_attribute(Attribute::Tc0W, [](const Vertex& v) { return v.tc0_w; });
+    set_attribute(Attribute::QuatX, [](const Vertex& v) { return v.quat.x; });
+    set_attribute(Attribute::QuatY, [](const Vertex& v) { return v.quat.y; });
+    set_attribute(Attribute::QuatZ, [](const Vertex& v) { return v.quat.z; });
+    set_attribute(Attribute::QuatW, [](const Vertex& v) { return v.quat.w; });
+    set_attribute(Attribute::ViewX, [](const Vertex& v) { return v.view.x; });
+    set_attribute(Attribute::ViewY, [](const Vertex& v) { return v.view.y; });
+    set_attribute(Attribute::ViewZ, [](const Vertex& v) { return v.view.z; });
+    SpanValues values;
+
+    // Edge function increments when stepping one pixel to the right
+    EdgeSpan span{
+        .step = {(vtxpos[1].y - vtxpos[2].y) * 0x10, (vtxpos[2].y - vtxpos[0].y) * 0x10,
+                 (vtxpos[0].y - vtxpos[1].y) * 0x10},
+        .bias = {bias0, bias1, bias2},
+    };
+
     for (u16 y = min_y + 8; y < max_y; y += 0x10) {
-        const auto process_scanline = [&, y] {
-            for (u16 x = min_x + 8; x < max_x; x += 0x10) {
+        // Test coverage for up to MAX_SPAN_PIXELS pixels at a time and shade the covered pixels
+        // from left to right, which keeps the fragment order identical to per-pixel testing.
+        for (u32 span_x = min_x + 8; span_x < max_x; span_x += MAX_SPAN_PIXELS * 0x10) {
+            const u32 count = std::min<u32>(MAX_SPAN_PIXELS, (max_x - span_x + 0xF) >> 4);
+            const Common::Vec2<Fix12P4> span_pos{static_cast<u16>(span_x), y};
+            span.w = {SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), span_pos),
+                      SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), span_pos),
+                      SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), span_pos)};
+
+            u32 coverage = coverage_mask(span, count);
+            if (coverage == 0) {
+                continue;
+            }
+            // Interpolate the depth and attributes of all covered pixels at once
+            interpolate(interpolation, span, coverage, values);
+
+            while (coverage != 0) {
+                const u32 i = std::countr_zero(coverage);
+                coverage &= coverage - 1;
+                const u16 x = static_cast<u16>(span_x + (i << 4));
+
                 // Do not process the pixel if it's inside the scissor box and the scissor mode is
                 // set to Exclude.
                 if (regs.rasterizer.scissor_test.mode == RasterizerRegs::ScissorMode::Exclude) {
@@ -311,101 +566,31 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                     }
                 }
 
-                // Calculate the barycentric coordinates w0, w1 and w2
-                const s32 w0 = SignedArea(vtxpos[1].xy(), vtxpos[2].xy(), {x, y});
-                const s32 w1 = SignedArea(vtxpos[2].xy(), vtxpos[0].xy(), {x, y});
-                const s32 w2 = SignedArea(vtxpos[0].xy(), vtxpos[1].xy(), {x, y});
-                const s32 wsum = w0 + w1 + w2;
-
-                // If current pixel is not covered by the current primitive
-                if (w0 < bias0 || w1 < bias1 || w2 < bias2) {
-                    continue;
-                }
-
-                const auto baricentric_coordinates = Common::MakeVec(
-                    f24::FromFloat32(static_cast<f32>(w0)), f24::FromFloat32(static_cast<f32>(w1)),
-                    f24::FromFloat32(static_cast<f32>(w2)));
-                const f24 interpolated_w_inverse =
-                    f24::One() / Common::Dot(w_inverse, baricentric_coordinates);
-
-                // interpolated_z = z / w
-                const float interpolated_z_over_w =
-                    (v0.screenpos[2].ToFloat32() * w0 + v1.screenpos[2].ToFloat32() * w1 +
-                     v2.screenpos[2].ToFloat32() * w2) /
-                    wsum;
-
-                // Not fully accurate. About 3 bits in precision are missing.
-                // Z-Buffer (z / w * scale + offset)
-                const float depth_scale =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_range).ToFloat32();
-                const float depth_offset =
-                    f24::FromRaw(regs.rasterizer.viewport_depth_near_plane).ToFloat32();
-                float depth = interpolated_z_over_w * depth_scale + depth_offset;
-
-                // Potentially switch to W-Buffer
-                if (regs.rasterizer.depthmap_enable ==
-                    Pica::RasterizerRegs::DepthBuffering::WBuffering) {
-                    // W-Buffer (z * scale + w * offset = (z / w * scale + offset) * w)
-                    depth *= interpolated_w_inverse.ToFloat32() * wsum;
-                }
-
-                // Clamp the result
-                depth = std::clamp(depth, 0.0f, 1.0f);
-
-                /**
-                 * Perspective correct attribute interpolation:
-                 * Attribute values cannot be calculated by simple linear interpolation since
-                 * they are not linear in screen space. For example, when interpolating a
-                 * texture coordinate across two vertices, something simple like
-                 *     u = (u0*w0 + u1*w1)/(w0+w1)
-                 * will not work. However, the attribute value divided by the
-                 * clipspace w-coordinate (u/w) and and the inverse w-coordinate (1/w) are linear
-                 * in screenspace. Hence, we can linearly interpolate these two independently and
-                 * calculate the interpolated attribute by dividing the results.
-                 * I.e.
-                 *     u_over_w   = ((u0/v0.pos.w)*w0 + (u1/v1.pos.w)*w1)/(w0+w1)
-                 *     one_over_w = (( 1/v0.pos.w)*w0 + ( 1/v1.pos.w)*w1)/(w0+w1)
-                 *     u = u_over_w / one_over_w
-                 *
-                 * The generalization to three vertices is straightforward in baricentric
-                 *coordinates.
-                 **/
-                const auto get_interpolated_attribute = [&](f24 attr0, f24 attr1, f24 attr2) {
-                    auto attr_over_w = Common::MakeVec(attr0, attr1, attr2);
-                    f24 interpolated_attr_over_w =
-                        Common::Dot(attr_over_w, baricentric_coordinates);
-                    return interpolated_attr_over_w * interpolated_w_inverse;
+                const float depth = values.depth[i];
+                const auto get_color = [&](Attribute attribute) {
+                    return static_cast<u8>(round(values.Get(attribute, i) * 255));
                 };
-
                 const Common::Vec4<u8> primary_color{
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.r(), v1.color.r(), v2.color.r())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.g(), v1.color.g(), v2.color.g())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.b(), v1.color.b(), v2.color.b())
-                                  .ToFloat32() *
-                              255)),
-                    static_cast<u8>(
-                        round(get_interpolated_attribute(v0.color.a(), v1.color.a(), v2.color.a())
-                                  .ToFloat32() *
-                              255)),
+                    get_color(Attribute::ColorR),
+                    get_color(Attribute::ColorG),
+                    get_color(Attribute::ColorB),
+                    get_color(Attribute::ColorA),
                 };
 
+                // Interpolated attributes are f24 values, so converting them back is exact.
+                const auto get_f24 = [&](Attribute attribute) {
+                    return f24::FromFloat32(values.Get(attribute, i));
+                };
                 std::array<Common::Vec2<f24>, 3> uv;
-                uv[0].u() = get_interpolated_attribute(v0.tc0.u(), v1.tc0.u(), v2.tc0.u());
-                uv[0].v() = get_interpolated_attribute(v0.tc0.v(), v1.tc0.v(), v2.tc0.v());
-                uv[1].u() = get_interpolated_attribute(v0.tc1.u(), v1.tc1.u(), v2.tc1.u());
-                uv[1].v() = get_interpolated_attribute(v0.tc1.v(), v1.tc1.v(), v2.tc1.v());
-                uv[2].u() = get_interpolated_attribute(v0.tc2.u(), v1.tc2.u(), v2.tc2.u());
-                uv[2].v() = get_interpolated_attribute(v0.tc2.v(), v1.tc2.v(), v2.tc2.v());
+                uv[0].u() = get_f24(Attribute::Tc0U);
+                uv[0].v() = get_f24(Attribute::Tc0V);
+                uv[1].u() = get_f24(Attribute::Tc1U);
+                uv[1].v() = get_f24(Attribute::Tc1V);
+                uv[2].u() = get_f24(Attribute::Tc2U);
+                uv[2].v() = get_f24(Attribute::Tc2V);
 
                 // Sample bound texture units.
-                const f24 tc0_w = get_interpolated_attribute(v0.tc0_w, v1.tc0_w, v2.tc0_w);
+                const f24 tc0_w = get_f24(Attribute::Tc0W);
                 const auto texture_color = TextureColor(uv, textures, tc0_w);
 
                 Common::Vec4<u8> primary_fragment_color = {0, 0, 0, 0};
@@ -414,20 +599,16 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                 if (!regs.lighting.disable) {
                     const auto normquat =
                         Common::Quaternion<f32>{
-                            {get_interpolated_attribute(v0.quat.x, v1.quat.x, v2.quat.x)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.y, v1.quat.y, v2.quat.y)
-                                 .ToFloat32(),
-                             get_interpolated_attribute(v0.quat.z, v1.quat.z, v2.quat.z)
-                                 .ToFloat32()},
-                            get_interpolated_attribute(v0.quat.w, v1.quat.w, v2.quat.w).ToFloat32(),
+                            {values.Get(Attribute::QuatX, i), values.Get(Attribute::QuatY, i),
+                             values.Get(Attribute::QuatZ, i)},
+                            values.Get(Attribute::QuatW, i),
                         }
                             .Normalized();
 
                     const Common::Vec3f view{
-                        get_interpolated_attribute(v0.view.x, v1.view.x, v2.view.x).ToFloat32(),
-                        get_interpolated_attribute(v0.view.y, v1.view.y, v2.view.y).ToFloat32(),
-                        get_interpolated_attribute(v0.view.z, v1.view.z, v2.view.z).ToFloat32(),
+                        values.Get(Attribute::ViewX, i),
+                        values.Get(Attribute::ViewY, i),
+                        values.Get(Attribute::ViewZ, i),
                     };
                     std::tie(primary_fragment_color, secondary_fragment_color) =
                         ComputeFragmentsColors(regs.lighting, pica.lighting, normquat, view,
@@ -435,9 +616,9 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                 }
 
                 // Write the TEV stages.
-                auto combiner_output =
-                    WriteTevConfig(texture_color, tev_stages, primary_color, primary_fragment_color,
-                                   secondary_fragment_color);
+                auto combiner_output = tev_program->Run(texture_color, primary_color,
+                                                        primary_fragment_color,
+                                                        secondary_fragment_color);
 
                 const auto& output_merger = regs.framebuffer.output_merger;
                 if (output_merger.fragment_operation_mode ==
@@ -463,10 +644,72 @@ void RasterizerSoftware::ProcessTriangle(const Vertex& v0, const Vertex& v1, con
                     fb.DrawPixel(x >> 4, y >> 4, result);
                 }
             }
-        };
-        sw_workers.QueueWork(std::move(process_scanline));
+        }
+    }
+}
+
+void RasterizerSoftware::BindTextures() {
+    if (!textures_dirty) [[likely]] {
+        return;
+    }
+    textures_dirty = false;
+
+    // Decoding for this draw may exceed the budget, but never evict textures that are bound.
+    texture_cache.EnforceBudget();
+
+    const auto textures = regs.texturing.GetTextures();
+    for (u32 i = 0; i < 3; ++i) {
+        const auto& texture = textures[i];
+        auto& bound = bound_textures[i];
+        bound.fill(nullptr);
+        if (!texture.enabled || texture.config.address == 0) {
+            continue;
+        }
+
+        auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+        const auto type = texture.config.type.Value();
+        const bool is_cube = i == 0 && (type == TexturingRegs::TextureConfig::TextureCube ||
+                                        type == TexturingRegs::TextureConfig::ShadowCube);
+        if (!is_cube) {
+            bound[0] = texture_cache.GetTexture(info);
+            continue;
+        }
+        for (u32 face = 0; face < bound.size(); ++face) {
+            info.physical_address = regs.texturing.GetCubePhysicalAddress(
+                static_cast<TexturingRegs::CubeFace>(face));
+            bound[face] = texture_cache.GetTexture(info);
+        }
+    }
+}
+
+void RasterizerSoftware::BindTevProgram() {
+    if (!tev_dirty) [[likely]] {
+        return;
+    }
+    tev_dirty = false;
+    tev_program = tev_cache.Get(regs.texturing);
+}
+
+void RasterizerSoftware::InvalidateRenderTargets() {
+    if (!render_targets_written) {
+        return;
+    }
+    render_targets_written = false;
+
+    const auto& framebuffer = regs.framebuffer.framebuffer;
+    const u32 num_pixels = framebuffer.GetWidth() * framebuffer.GetHeight();
+    const u32 color_size =
+        num_pixels * Pica::BytesPerPixel(Pica::PixelFormat(framebuffer.color_format.Value()));
+    const u32 depth_size =
+        num_pixels * FramebufferRegs::BytesPerDepthPixel(framebuffer.depth_format);
+
+    bool invalidated =
+        texture_cache.InvalidateRegion(framebuffer.GetColorBufferPhysicalAddress(), color_size);
+    invalidated |=
+        texture_cache.InvalidateRegion(framebuffer.GetDepthBufferPhysicalAddress(), depth_size);
+    if (invalidated) {
+        textures_dirty = true;
     }
-    sw_workers.WaitForRequests();
 }
 
 std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
@@ -555,11 +798,18 @@ std::array<Common::Vec4<u8>, 4> RasterizerSoftware::TextureColor(
             t = texture.config.height - 1 -
                 GetWrappedTexCoord(texture.config.wrap_t, t, texture.config.height);
 
-            const u8* texture_data = memory.GetPhysicalPointer(texture_address);
-            const auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
-
             // TODO: Apply the min and mag filters to the texture
-            texture_color[i] = LookupTexture(texture_data, s, t, info);
+            const auto& bound = bound_textures[i];
+            const auto it = std::find_if(bound.begin(), bound.end(), [&](const auto* decoded) {
+                return decoded && decoded->address == texture_address;
+            });
+            if (it != bound.end()) [[likely]] {
+                texture_color[i] = (*it)->Texel(s, t);
+            } else {
+                const u8* texture_data = memory.GetPhysicalPointer(texture_address);
+                const auto info = TextureInfo::FromPicaRegister(texture.config, texture.format);
+                texture_color[i] = LookupTexture(texture_data, s, t, info);
+            }
         }
 
         if (i == 0 && (texture.config.type == TexturingRegs::TextureConfig::Shadow2D ||
@@ -680,120 +930,6 @@ Common::Vec4<u8> RasterizerSoftware::PixelColor(u16 x, u16 y,
     return result;
 }
 
-Common::Vec4<u8> RasterizerSoftware::WriteTevConfig(
-    std::span<const Common::Vec4<u8>, 4> texture_color,
-    std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-    Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-    Common::Vec4<u8> secondary_fragment_color) {
-    /**
-     * Texture environment - consists of 6 stages of color and alpha combining.
-     * Color combiners take three input color values from some source (e.g. interpolated
-     * vertex color, texture color, previous stage, etc), perform some very simple
-     * operations on each of them (e.g. inversion) and then calculate the output color
-     * with some basic arithmetic. Alpha combiners can be configured separately but work
-     * analogously.
-     **/
-    Common::Vec4<u8> combiner_output = {0, 0, 0, 0};
-    Common::Vec4<u8> combiner_buffer = {0, 0, 0, 0};
-    Common::Vec4<u8> next_combiner_buffer =
-        Common::MakeVec(regs.texturing.tev_combiner_buffer_color.r.Value(),
-                        regs.texturing.tev_combiner_buffer_color.g.Value(),
-                        regs.texturing.tev_combiner_buffer_color.b.Value(),
-                        regs.texturing.tev_combiner_buffer_color.a.Value())
-            .Cast<u8>();
-
-    for (u32 tev_stage_index = 0; tev_stage_index < tev_stages.size(); ++tev_stage_index) {
-        const auto& tev_stage = tev_stages[tev_stage_index];
-        using Source = TexturingRegs::TevStageConfig::Source;
-
-        auto get_source = [&](Source source) -> Common::Vec4<u8> {
-            switch (source) {
-            case Source::PrimaryColor:
-                return primary_color;
-            case Source::PrimaryFragmentColor:
-                return primary_fragment_color;
-            case Source::SecondaryFragmentColor:
-                return secondary_fragment_color;
-            case Source::Texture0:
-                return texture_color[0];
-            case Source::Texture1:
-                return texture_color[1];
-            case Source::Texture2:
-                return texture_color[2];
-            case Source::Texture3:
-                return texture_color[3];
-            case Source::PreviousBuffer:
-                return combiner_buffer;
-            case Source::Constant:
-                return Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
-                                       tev_stage.const_b.Value(), tev_stage.const_a.Value())
-                    .Cast<u8>();
-            case Source::Previous:
-                return combiner_output;
-            default:
-                LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
-                UNIMPLEMENTED();
-                return {0, 0, 0, 0};
-            }
-        };
-
-        /**
-         * Color combiner
-         * NOTE: Not sure if the alpha combiner might use the color output of the previous
-         *       stage as input. Hence, we currently don't directly write the result to
-         *       combiner_output.rgb(), but instead store it in a temporary variable until
-         *       alpha combining has been done.
-         **/
-        const auto source1 = tev_stage_index == 0 && tev_stage.color_source1 == Source::Previous
-                                 ? tev_stage.color_source3.Value()
-                                 : tev_stage.color_source1.Value();
-        const auto source2 = tev_stage_index == 0 && tev_stage.color_source2 == Source::Previous
-                                 ? tev_stage.color_source3.Value()
-                                 : tev_stage.color_source2.Value();
-        const std::array<Common::Vec3<u8>, 3> color_result = {
-            GetColorModifier(tev_stage.color_modifier1, get_source(source1)),
-            GetColorModifier(tev_stage.color_modifier2, get_source(source2)),
-            GetColorModifier(tev_stage.color_modifier3, get_source(tev_stage.color_source3)),
-        };
-        const Common::Vec3<u8> color_output = ColorCombine(tev_stage.color_op, color_result);
-
-        u8 alpha_output;
-        if (tev_stage.color_op == TexturingRegs::TevStageConfig::Operation::Dot3_RGBA) {
-            // result of Dot3_RGBA operation is also placed to the alpha component
-            alpha_output = color_output.x;
-        } else {
-            // alpha combiner
-            const std::array<u8, 3> alpha_result = {{
-                GetAlphaModifier(tev_stage.alpha_modifier1, get_source(tev_stage.alpha_source1)),
-                GetAlphaModifier(tev_stage.alpha_modifier2, get_source(tev_stage.alpha_source2)),
-                GetAlphaModifier(tev_stage.alpha_modifier3, get_source(tev_stage.alpha_source3)),
-            }};
-            alpha_output = AlphaCombine(tev_stage.alpha_op, alpha_result);
-        }
-
-        combiner_output[0] = std::min(255U, color_output.r() * tev_stage.GetColorMultiplier());
-        combiner_output[1] = std::min(255U, color_output.g() * tev_stage.GetColorMultiplier());
-        combiner_output[2] = std::min(255U, color_output.b() * tev_stage.GetColorMultiplier());
-        combiner_output[3] = std::min(255U, alpha_output * tev_stage.GetAlphaMultiplier());
-
-        combiner_buffer = next_combiner_buffer;
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferColor(
-                tev_stage_index)) {
-            next_combiner_buffer.r() = combiner_output.r();
-            next_combiner_buffer.g() = combiner_output.g();
-            next_combiner_buffer.b() = combiner_output.b();
-        }
-
-        if (regs.texturing.tev_combiner_buffer_input.TevStageUpdatesCombinerBufferAlpha(
-                tev_stage_index)) {
-            next_combiner_buffer.a() = combiner_output.a();
-        }
-    }
-
-    return combiner_output;
-}
-
 void RasterizerSoftware::WriteFog(float depth, Common::Vec4<u8>& combiner_output) const {
     /**
      * Apply fog combiner. Not fully accurate. We'd have to know what data type is used to
@@ -6,11 +6,17 @@
 #pragma once
 
 #include <span>
+#include <vector>
 #include "common/thread_worker.h"
+#include "video_core/pica/output_vertex.h"
 #include "video_core/pica/regs_texturing.h"
 #include "video_core/rasterizer_interface.h"
 #include "video_core/renderer_software/sw_clipper.h"
+#include "video_core/renderer_software/sw_coverage.h"
 #include "video_core/renderer_software/sw_framebuffer.h"
+#include "video_core/renderer_software/sw_interpolation.h"
+#include "video_core/renderer_software/sw_tev.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
 
 namespace Pica {
 struct RegsInternal;
@@ -19,21 +25,67 @@ class PicaCore;
 
 namespace SwRenderer {
 
-struct Vertex;
+struct Vertex : Pica::OutputVertex {
+    Vertex(const OutputVertex& v) : OutputVertex(v) {}
+
+    /// Attributes used to store intermediate results position after perspective divide.
+    Common::Vec3<f24> screenpos;
+
+    /**
+     * Linear interpolation
+     * factor: 0=this, 1=vtx
+     * Note: This function cannot be called after perspective divide.
+     **/
+    void Lerp(f24 factor, const Vertex& vtx) {
+        pos = pos * factor + vtx.pos * (f24::One() - factor);
+        quat = quat * factor + vtx.quat * (f24::One() - factor);
+        color = color * factor + vtx.color * (f24::One() - factor);
+        tc0 = tc0 * factor + vtx.tc0 * (f24::One() - factor);
+        tc1 = tc1 * factor + vtx.tc1 * (f24::One() - factor);
+        tc0_w = tc0_w * factor + vtx.tc0_w * (f24::One() - factor);
+        view = view * factor + vtx.view * (f24::One() - factor);
+        tc2 = tc2 * factor + vtx.tc2 * (f24::One() - factor);
+    }
+
+    /**
+     * Linear interpolation
+     * factor: 0=v0, 1=v1
+     * Note: This function cannot be called after perspective divide.
+     **/
+    static Vertex Lerp(f24 factor, const Vertex& v0, const Vertex& v1) {
+        Vertex ret = v0;
+        ret.Lerp(factor, v1);
+        return ret;
+    }
+};
+
+/// A counter-clockwise triangle that has passed culling and is ready to be rasterized.
+struct TriangleSetup {
+    std::array<Vertex, 3> vertices;
+    std::array<Common::Vec3<Fix12P4>, 3> vtxpos;
+    std::array<s32, 3> bias;
+    /// Bounding box in 12.4 fixed point, aligned to pixel boundaries. The maximum is exclusive.
+    u16 min_x;
+    u16 min_y;
+    u16 max_x;
+    u16 max_y;
+};
 
 class RasterizerSoftware : public VideoCore::RasterizerInterface {
 public:
     explicit RasterizerSoftware(Memory::MemorySystem& memory, Pica::PicaCore& pica);
+    ~RasterizerSoftware() override;
 
     void AddTriangle(const Pica::OutputVertex& v0, const Pica::OutputVertex& v1,
                      const Pica::OutputVertex& v2) override;
-    void DrawTriangles() override {}
-    void NotifyPicaRegisterChanged(u32 id) override {}
-    void FlushAll() override {}
-    void FlushRegion(PAddr addr, u32 size) override {}
-    void InvalidateRegion(PAddr addr, u32 size) override {}
-    void FlushAndInvalidateRegion(PAddr addr, u32 size) override {}
-    void ClearAll(bool flush) override {}
+    void DrawTriangles() override;
+    void NotifyPicaRegisterChanged(u32 id) override;
+    void NotifyPicaRegisterChanging(u32 id, u32 value) override;
+    void FlushAll() override;
+    void FlushRegion(PAddr addr, u32 size) override;
+    void InvalidateRegion(PAddr addr, u32 size) override;
+    void FlushAndInvalidateRegion(PAddr addr, u32 size) override;
+    void ClearAll(bool flush) override;
 
 private:
     /// Computes the screen coordinates of the provided vertex.
@@ -43,6 +95,26 @@ private:
     void ProcessTriangle(const Vertex& v0, const Vertex& v1, const Vertex& v2,
                          bool reversed = false);
 
+    /// Adds the triangle to every screen tile its bounding box overlaps.
+    void BinTriangle(const TriangleSetup& triangle);
+
+    /// Rasterizes all binned triangles, one worker per tile.
+    void FlushBins();
+
+    /// Rasterizes the part of the triangle that lies inside the provided 12.4 rectangle.
+    void RasterizeTriangle(const TriangleSetup& triangle, u16 min_x, u16 min_y, u16 max_x,
+                           u16 max_y);
+
+    /// Looks up the decoded textures of the enabled texture units if the bindings are stale.
+    void BindTextures();
+
+    /// Looks up the TEV program for the current combiner state if the binding is stale.
+    void BindTevProgram();
+
+    /// Drops decoded textures overlapping the current color and depth buffers, if anything was
+    /// rasterized since the last call. Called once per draw rather than per triangle.
+    void InvalidateRenderTargets();
+
     /// Returns the texture color of the currently processed pixel.
     std::array<Common::Vec4<u8>, 4> TextureColor(
         std::span<const Common::Vec2<f24>, 3> uv,
@@ -51,13 +123,6 @@ private:
     /// Returns the final pixel color with blending or logic ops applied.
     Common::Vec4<u8> PixelColor(u16 x, u16 y, Common::Vec4<u8> combiner_output) const;
 
-    /// Emulates the TEV configuration and returns the combiner output.
-    Common::Vec4<u8> WriteTevConfig(
-        std::span<const Common::Vec4<u8>, 4> texture_color,
-        std::span<const Pica::TexturingRegs::TevStageConfig, 6> tev_stages,
-        Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
-        Common::Vec4<u8> secondary_fragment_color);
-
     /// Blends fog to the combiner output if enabled.
     void WriteFog(float depth, Common::Vec4<u8>& combiner_output) const;
 
@@ -74,6 +139,19 @@ private:
     std::size_t num_sw_threads;
     Common::ThreadWorker sw_workers;
     Framebuffer fb;
+    TextureCache texture_cache;
+    std::array<std::array<const DecodedTexture*, 6>, 3> bound_textures{};
+    bool textures_dirty{true};
+    TevProgramCache tev_cache;
+    const TevProgram* tev_program{};
+    bool tev_dirty{true};
+    bool render_targets_written{false};
+    CoverageFunc coverage_mask;
+    InterpolateFunc interpolate;
+    bool use_tile_binning;
+    std::vector<TriangleSetup> binned_triangles;
+    std::vector<std::vector<u32>> bins;
+    std::vector<u32> active_bins;
 };
 
 } // namespace SwRenderer
@@ -0,0 +1,315 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <utility>
+#include "common/common_funcs.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "video_core/renderer_software/sw_tev.h"
+
+namespace SwRenderer {
+
+namespace {
+
+using TevStageConfig = Pica::TexturingRegs::TevStageConfig;
+using Operation = TevStageConfig::Operation;
+using Source = TevStageConfig::Source;
+
+/// Slots of the per-fragment input array the compiled sources index into.
+enum Slot : u8 {
+    SLOT_PRIMARY_COLOR = 0,
+    SLOT_PRIMARY_FRAGMENT_COLOR = 1,
+    SLOT_SECONDARY_FRAGMENT_COLOR = 2,
+    SLOT_TEXTURE0 = 3,
+    SLOT_PREVIOUS_BUFFER = 7,
+    SLOT_CONSTANT = 8,
+    SLOT_PREVIOUS = 9,
+    SLOT_ZERO = 10,
+    NUM_SLOTS = 11,
+};
+
+/// Upper bound on cached programs, games only use a handful of combiner setups.
+constexpr std::size_t MAX_CACHED_PROGRAMS = 1024;
+
+/// Operations 0 to AddThenMultiply get a kernel each, other values only exist as invalid
+/// register contents.
+constexpr std::size_t NUM_OPERATIONS = static_cast<std::size_t>(Operation::AddThenMultiply) + 1;
+
+u8 GetSourceSlot(Source source) {
+    switch (source) {
+    case Source::PrimaryColor:
+        return SLOT_PRIMARY_COLOR;
+    case Source::PrimaryFragmentColor:
+        return SLOT_PRIMARY_FRAGMENT_COLOR;
+    case Source::SecondaryFragmentColor:
+        return SLOT_SECONDARY_FRAGMENT_COLOR;
+    case Source::Texture0:
+    case Source::Texture1:
+    case Source::Texture2:
+    case Source::Texture3:
+        return static_cast<u8>(SLOT_TEXTURE0 + static_cast<u32>(source) -
+                               static_cast<u32>(Source::Texture0));
+    case Source::PreviousBuffer:
+        return SLOT_PREVIOUS_BUFFER;
+    case Source::Constant:
+        return SLOT_CONSTANT;
+    case Source::Previous:
+        return SLOT_PREVIOUS;
+    default:
+        LOG_ERROR(HW_GPU, "Unknown color combiner source {}", (int)source);
+        return SLOT_ZERO;
+    }
+}
+
+/// Returns true when the stage outputs the previous stage's output unchanged.
+bool IsPassthrough(const TevStageConfig& stage) {
+    return stage.color_op == TevStageConfig::Operation::Replace &&
+           stage.color_source1 == Source::Previous &&
+           stage.color_modifier1 == TevStageConfig::ColorModifier::SourceColor &&
+           stage.alpha_op == TevStageConfig::Operation::Replace &&
+           stage.alpha_source1 == Source::Previous &&
+           stage.alpha_modifier1 == TevStageConfig::AlphaModifier::SourceAlpha &&
+           stage.GetColorMultiplier() == 1 && stage.GetAlphaMultiplier() == 1;
+}
+
+/// Returns the number of combiner inputs the operation reads.
+constexpr std::size_t NumOperands(Operation op) {
+    switch (op) {
+    case Operation::Replace:
+        return 1;
+    case Operation::Lerp:
+    case Operation::MultiplyThenAdd:
+    case Operation::AddThenMultiply:
+        return 3;
+    default:
+        return 2;
+    }
+}
+
+FORCE_INLINE void WriteOutput(Common::Vec4<u8>& output, const Common::Vec3<u8>& color,
+                              u8 alpha, u32 color_multiplier, u32 alpha_multiplier) {
+    output[0] = std::min(255U, color.r() * color_multiplier);
+    output[1] = std::min(255U, color.g() * color_multiplier);
+    output[2] = std::min(255U, color.b() * color_multiplier);
+    output[3] = std::min(255U, alpha * alpha_multiplier);
+}
+
+} // Anonymous namespace
+
+TevConfig::TevConfig(const Pica::TexturingRegs& regs)
+    : stages{regs.GetTevStages()},
+      buffer_update_mask{regs.tev_combiner_buffer_input.update_mask_rgb |
+                         (regs.tev_combiner_buffer_input.update_mask_a << 4)},
+      buffer_color{regs.tev_combiner_buffer_color.raw} {}
+
+bool TevConfig::operator==(const TevConfig& other) const noexcept {
+    return std::memcmp(this, &other, sizeof(TevConfig)) == 0;
+}
+
+u64 TevConfig::Hash() const noexcept {
+    return Common::ComputeHash64(this, sizeof(TevConfig));
+}
+
+TevProgram::TevProgram(const TevConfig& config_) : config{config_}, num_stages{0} {
+    bool refresh_buffer = false;
+    for (u32 index = 0; index < config.stages.size(); ++index) {
+        const auto& tev_stage = config.stages[index];
+
+        // Only stages 0-3 can write to the combiner buffer
+        const bool update_buffer_color =
+            index < 4 && (config.buffer_update_mask & (1 << index)) != 0;
+        const bool update_buffer_alpha =
+            index < 4 && (config.buffer_update_mask & (0x10 << index)) != 0;
+
+        // A stage which outputs the previous output unchanged only moves the pending combiner
+        // buffer value into place, which the next stage that is kept does instead. Trailing
+        // passthrough stages do not affect the output and are dropped entirely.
+        if (index != 0 && IsPassthrough(tev_stage) && !update_buffer_color &&
+            !update_buffer_alpha) {
+            refresh_buffer = true;
+            continue;
+        }
+
+        auto& stage = stages[num_stages++];
+        stage.refresh_buffer = std::exchange(refresh_buffer, false);
+        stage.update_buffer_color = update_buffer_color;
+        stage.update_buffer_alpha = update_buffer_alpha;
+
+        // The first stage has no previous output, color sources 1 and 2 fall back to source 3.
+        const auto source1 = index == 0 && tev_stage.color_source1 == Source::Previous
+                                 ? tev_stage.color_source3.Value()
+                                 : tev_stage.color_source1.Value();
+        const auto source2 = index == 0 && tev_stage.color_source2 == Source::Previous
+                                 ? tev_stage.color_source3.Value()
+                                 : tev_stage.color_source2.Value();
+
+        stage.color_sources = {GetSourceSlot(source1), GetSourceSlot(source2),
+                               GetSourceSlot(tev_stage.color_source3)};
+        stage.alpha_sources = {GetSourceSlot(tev_stage.alpha_source1),
+                               GetSourceSlot(tev_stage.alpha_source2),
+                               GetSourceSlot(tev_stage.alpha_source3)};
+        stage.color_modifiers = {GetColorModifierFunc(tev_stage.color_modifier1),
+                                 GetColorModifierFunc(tev_stage.color_modifier2),
+                                 GetColorModifierFunc(tev_stage.color_modifier3)};
+        stage.alpha_modifiers = {GetAlphaModifierFunc(tev_stage.alpha_modifier1),
+                                 GetAlphaModifierFunc(tev_stage.alpha_modifier2),
+                                 GetAlphaModifierFunc(tev_stage.alpha_modifier3)};
+        stage.color_op = tev_stage.color_op;
+        stage.alpha_op = tev_stage.alpha_op;
+        stage.run = GetStageFunc(stage.color_op, stage.alpha_op);
+        stage.constant = Common::MakeVec(tev_stage.const_r.Value(), tev_stage.const_g.Value(),
+                                         tev_stage.const_b.Value(), tev_stage.const_a.Value())
+                             .Cast<u8>();
+        stage.color_multiplier = tev_stage.GetColorMultiplier();
+        stage.alpha_multiplier = tev_stage.GetAlphaMultiplier();
+    }
+}
+
+Common::Vec4<u8> TevProgram::Run(std::span<const Common::Vec4<u8>, 4> texture_color,
+                                 Common::Vec4<u8> primary_color,
+                                 Common::Vec4<u8> primary_fragment_color,
+                                 Common::Vec4<u8> secondary_fragment_color) const {
+    std::array<Common::Vec4<u8>, NUM_SLOTS> inputs;
+    inputs[SLOT_PRIMARY_COLOR] = primary_color;
+    inputs[SLOT_PRIMARY_FRAGMENT_COLOR] = primary_fragment_color;
+    inputs[SLOT_SECONDARY_FRAGMENT_COLOR] = secondary_fragment_color;
+    std::copy(texture_color.begin(), texture_color.end(), inputs.begin() + SLOT_TEXTURE0);
+    inputs[SLOT_PREVIOUS_BUFFER] = {0, 0, 0, 0};
+    inputs[SLOT_PREVIOUS] = {0, 0, 0, 0};
+    inputs[SLOT_ZERO] = {0, 0, 0, 0};
+
+    auto& combiner_output = inputs[SLOT_PREVIOUS];
+    auto& combiner_buffer = inputs[SLOT_PREVIOUS_BUFFER];
+    Common::Vec4<u8> next_combiner_buffer{
+        static_cast<u8>(config.buffer_color), static_cast<u8>(config.buffer_color >> 8),
+        static_cast<u8>(config.buffer_color >> 16), static_cast<u8>(config.buffer_color >> 24)};
+
+    for (const Stage& stage : std::span{stages.data(), num_stages}) {
+        if (stage.refresh_buffer) {
+            combiner_buffer = next_combiner_buffer;
+        }
+        inputs[SLOT_CONSTANT] = stage.constant;
+        stage.run(stage, inputs.data());
+
+        combiner_buffer = next_combiner_buffer;
+
+        if (stage.update_buffer_color) {
+            next_combiner_buffer.r() = combiner_output.r();
+            next_combiner_buffer.g() = combiner_output.g();
+            next_combiner_buffer.b() = combiner_output.b();
+        }
+        if (stage.update_buffer_alpha) {
+            next_combiner_buffer.a() = combiner_output.a();
+        }
+    }
+
+    return combiner_output;
+}
+
+template <Operation color_op, Operation alpha_op>
+void TevProgram::RunStage(const Stage& stage, Common::Vec4<u8>* inputs) {
+    // Operands the operation does not read are never evaluated
+    constexpr std::size_t num_color_operands = NumOperands(color_op);
+    std::array<Common::Vec3<u8>, 3> color_result;
+    color_result[0] = stage.color_modifiers[0](inputs[stage.color_sources[0]]);
+    if constexpr (num_color_operands > 1) {
+        color_result[1] = stage.color_modifiers[1](inputs[stage.color_sources[1]]);
+    }
+    if constexpr (num_color_operands > 2) {
+        color_result[2] = stage.color_modifiers[2](inputs[stage.color_sources[2]]);
+    }
+    const Common::Vec3<u8> color_output = ColorCombine<color_op>(color_result);
+
+    u8 alpha_output;
+    if constexpr (color_op == Operation::Dot3_RGBA) {
+        // Result of Dot3_RGBA operation is also placed to the alpha component
+        alpha_output = color_output.x;
+    } else {
+        constexpr std::size_t num_alpha_operands = NumOperands(alpha_op);
+        std::array<u8, 3> alpha_result;
+        alpha_result[0] = stage.alpha_modifiers[0](inputs[stage.alpha_sources[0]]);
+        if constexpr (num_alpha_operands > 1) {
+            alpha_result[1] = stage.alpha_modifiers[1](inputs[stage.alpha_sources[1]]);
+        }
+        if constexpr (num_alpha_operands > 2) {
+            alpha_result[2] = stage.alpha_modifiers[2](inputs[stage.alpha_sources[2]]);
+        }
+        if constexpr (alpha_op == Operation::Dot3_RGB || alpha_op == Operation::Dot3_RGBA) {
+            // Not an alpha operation, the generic combiner reports it
+            alpha_output = AlphaCombine(alpha_op, alpha_result);
+        } else {
+            alpha_output = AlphaCombine<alpha_op>(alpha_result);
+        }
+    }
+
+    WriteOutput(inputs[SLOT_PREVIOUS], color_output, alpha_output, stage.color_multiplier,
+                stage.alpha_multiplier);
+}
+
+void TevProgram::RunStageGeneric(const Stage& stage, Common::Vec4<u8>* inputs) {
+    const std::array<Common::Vec3<u8>, 3> color_result = {
+        stage.color_modifiers[0](inputs[stage.color_sources[0]]),
+        stage.color_modifiers[1](inputs[stage.color_sources[1]]),
+        stage.color_modifiers[2](inputs[stage.color_sources[2]]),
+    };
+    const Common::Vec3<u8> color_output = ColorCombine(stage.color_op, color_result);
+
+    u8 alpha_output;
+    if (stage.color_op == Operation::Dot3_RGBA) {
+        alpha_output = color_output.x;
+    } else {
+        const std::array<u8, 3> alpha_result = {{
+            stage.alpha_modifiers[0](inputs[stage.alpha_sources[0]]),
+            stage.alpha_modifiers[1](inputs[stage.alpha_sources[1]]),
+            stage.alpha_modifiers[2](inputs[stage.alpha_sources[2]]),
+        }};
+        alpha_output = AlphaCombine(stage.alpha_op, alpha_result);
+    }
+
+    WriteOutput(inputs[SLOT_PREVIOUS], color_output, alpha_output, stage.color_multiplier,
+                stage.alpha_multiplier);
+}
+
+TevProgram::StageFunc TevProgram::GetStageFunc(Operation color_op, Operation alpha_op) {
+    static constexpr auto kernels = []<std::size_t... I>(std::index_sequence<I...>) {
+        return std::array<StageFunc, sizeof...(I)>{
+            &RunStage<static_cast<Operation>(I / NUM_OPERATIONS),
+                      static_cast<Operation>(I % NUM_OPERATIONS)>...};
+    }(std::make_index_sequence<NUM_OPERATIONS * NUM_OPERATIONS>{});
+
+    // The alpha operation of a Dot3_RGBA stage is unused, all of them share one kernel
+    if (color_op == Operation::Dot3_RGBA) {
+        alpha_op = Operation::Replace;
+    }
+    const auto color_index = static_cast<std::size_t>(color_op);
+    const auto alpha_index = static_cast<std::size_t>(alpha_op);
+    if (color_index >= NUM_OPERATIONS || alpha_index >= NUM_OPERATIONS) [[unlikely]] {
+        return &RunStageGeneric;
+    }
+    return kernels[color_index * NUM_OPERATIONS + alpha_index];
+}
+
+TevProgramCache::TevProgramCache() = default;
+
+TevProgramCache::~TevProgramCache() = default;
+
+const TevProgram* TevProgramCache::Get(const Pica::TexturingRegs& regs) {
+    const TevConfig config{regs};
+    const u64 hash = config.Hash();
+    if (const auto it = programs.find(hash); it != programs.end()) [[likely]] {
+        if (it->second->Config() == config) {
+            return it->second.get();
+        }
+    }
+    if (programs.size() >= MAX_CACHED_PROGRAMS) [[unlikely]] {
+        programs.clear();
+    }
+    auto& program = programs[hash];
+    program = std::make_unique<TevProgram>(config);
+    return program.get();
+}
+
+} // namespace SwRenderer
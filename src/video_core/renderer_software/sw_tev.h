@@ -0,0 +1,96 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/pica/regs_texturing.h"
+#include "video_core/renderer_software/sw_texturing.h"
+
+namespace SwRenderer {
+
+/// Texture environment register state a TevProgram is specialized for.
+struct TevConfig {
+    explicit TevConfig(const Pica::TexturingRegs& regs);
+
+    bool operator==(const TevConfig& other) const noexcept;
+    u64 Hash() const noexcept;
+
+    std::array<Pica::TexturingRegs::TevStageConfig, 6> stages;
+    u32 buffer_update_mask;
+    u32 buffer_color;
+};
+
+/**
+ * The texture environment with all per-fragment decisions resolved ahead of time. Sources are
+ * turned into indices and modifiers into specialized functions. Each stage runs a kernel
+ * instantiated for its color and alpha operations, which only evaluates the inputs the
+ * operations read. Stages which pass the previous output through unchanged are removed, leaving
+ * a flat list of stages to run.
+ **/
+class TevProgram {
+public:
+    explicit TevProgram(const TevConfig& config);
+
+    /// Runs the combiner stages for a single fragment and returns the combiner output.
+    Common::Vec4<u8> Run(std::span<const Common::Vec4<u8>, 4> texture_color,
+                         Common::Vec4<u8> primary_color, Common::Vec4<u8> primary_fragment_color,
+                         Common::Vec4<u8> secondary_fragment_color) const;
+
+    const TevConfig& Config() const {
+        return config;
+    }
+
+private:
+    struct Stage;
+    /// Writes the output of the stage to inputs[SLOT_PREVIOUS].
+    using StageFunc = void (*)(const Stage& stage, Common::Vec4<u8>* inputs);
+
+    struct Stage {
+        StageFunc run;
+        std::array<u8, 3> color_sources;
+        std::array<u8, 3> alpha_sources;
+        std::array<ColorModifierFunc, 3> color_modifiers;
+        std::array<AlphaModifierFunc, 3> alpha_modifiers;
+        Pica::TexturingRegs::TevStageConfig::Operation color_op;
+        Pica::TexturingRegs::TevStageConfig::Operation alpha_op;
+        Common::Vec4<u8> constant;
+        u32 color_multiplier;
+        u32 alpha_multiplier;
+        bool refresh_buffer; ///< Removed passthrough stages precede this one
+        bool update_buffer_color;
+        bool update_buffer_alpha;
+    };
+
+    template <Pica::TexturingRegs::TevStageConfig::Operation color_op,
+              Pica::TexturingRegs::TevStageConfig::Operation alpha_op>
+    static void RunStage(const Stage& stage, Common::Vec4<u8>* inputs);
+    static void RunStageGeneric(const Stage& stage, Common::Vec4<u8>* inputs);
+    static StageFunc GetStageFunc(Pica::TexturingRegs::TevStageConfig::Operation color_op,
+                                  Pica::TexturingRegs::TevStageConfig::Operation alpha_op);
+
+    TevConfig config;
+    std::array<Stage, 6> stages; ///< Only the first num_stages entries are used
+    u32 num_stages;
+};
+
+/// Caches the TevPrograms compiled for each texture environment configuration.
+class TevProgramCache {
+public:
+    TevProgramCache();
+    ~TevProgramCache();
+
+    /// Returns the program for the current texture environment state, compiling it if needed.
+    const TevProgram* Get(const Pica::TexturingRegs& regs);
+
+private:
+    std::unordered_map<u64, std::unique_ptr<TevProgram>> programs;
+};
+
+} // namespace SwRenderer
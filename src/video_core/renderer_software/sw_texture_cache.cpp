@@ -0,0 +1,123 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include "common/assert.h"
+#include "common/literals.h"
+#include "common/profiling.h"
+#include "core/memory.h"
+#include "video_core/renderer_software/sw_texture_cache.h"
+
+namespace SwRenderer {
+
+using namespace Common::Literals;
+using Pica::Texture::TextureInfo;
+
+namespace {
+
+// Decoded textures are twice the size of RGBA4 and eight times the size of ETC1 data,
+// so keep the total bounded and start over once it is exceeded.
+constexpr std::size_t MAX_DECODED_SIZE = 64_MiB;
+
+u64 MakeKey(const TextureInfo& info) {
+    return static_cast<u64>(info.physical_address) | static_cast<u64>(info.width) << 32 |
+           static_cast<u64>(info.height) << 44 | static_cast<u64>(info.format) << 56;
+}
+
+} // Anonymous namespace
+
+TextureCache::TextureCache(Memory::MemorySystem& memory_, bool enabled_)
+    : memory{memory_}, enabled{enabled_} {}
+
+TextureCache::~TextureCache() {
+    InvalidateAll();
+}
+
+const DecodedTexture* TextureCache::GetTexture(const TextureInfo& info) {
+    const u64 key = MakeKey(info);
+    if (const auto it = textures.find(key); it != textures.end()) [[likely]] {
+        return it->second.get();
+    }
+
+    const u32 size = static_cast<u32>(info.stride * (info.height / 8));
+    const u8* source = memory.GetPhysicalPointer(info.physical_address);
+    if (!enabled || info.width == 0 || info.height == 0 || !source) [[unlikely]] {
+        return nullptr;
+    }
+
+    BORKED3DS_PROFILE("Software", "Texture Decode");
+
+    const std::size_t num_texels = static_cast<std::size_t>(info.width) * info.height;
+    auto texture = std::make_unique<DecodedTexture>();
+    texture->address = info.physical_address;
+    texture->size = size;
+    texture->width = info.width;
+    texture->height = info.height;
+    texture->texels.resize(num_texels);
+    for (u32 t = 0; t < info.height; t++) {
+        for (u32 s = 0; s < info.width; s++) {
+            texture->texels[t * info.width + s] = Pica::Texture::LookupTexture(source, s, t, info);
+        }
+    }
+
+    UpdatePagesCachedCount(texture->address, texture->size, 1);
+    decoded_size += num_texels * sizeof(Common::Vec4<u8>);
+    return textures.emplace(key, std::move(texture)).first->second.get();
+}
+
+bool TextureCache::InvalidateRegion(PAddr addr, u32 size) {
+    bool invalidated = false;
+    for (auto it = textures.begin(); it != textures.end();) {
+        const DecodedTexture& texture = *it->second;
+        if (addr < texture.address + texture.size && texture.address < addr + size) {
+            it = Erase(it);
+            invalidated = true;
+        } else {
+            ++it;
+        }
+    }
+    return invalidated;
+}
+
+void TextureCache::InvalidateAll() {
+    for (auto it = textures.begin(); it != textures.end();) {
+        it = Erase(it);
+    }
+}
+
+void TextureCache::EnforceBudget() {
+    if (decoded_size > MAX_DECODED_SIZE) {
+        InvalidateAll();
+    }
+}
+
+TextureCache::TextureMap::iterator TextureCache::Erase(TextureMap::iterator it) {
+    const DecodedTexture& texture = *it->second;
+    UpdatePagesCachedCount(texture.address, texture.size, -1);
+    decoded_size -= texture.texels.size() * sizeof(Common::Vec4<u8>);
+    return textures.erase(it);
+}
+
+void TextureCache::UpdatePagesCachedCount(PAddr addr, u32 size, int delta) {
+    if (size == 0) {
+        return;
+    }
+    const u32 page_start = addr >> Memory::BORKED3DS_PAGE_BITS;
+    const u32 page_end = ((addr + size - 1) >> Memory::BORKED3DS_PAGE_BITS) + 1;
+    for (u32 page = page_start; page < page_end; page++) {
+        u32& count = cached_pages[page];
+        if (delta > 0 && count++ == 0) {
+            memory.RasterizerMarkRegionCached(page << Memory::BORKED3DS_PAGE_BITS,
+                                              Memory::BORKED3DS_PAGE_SIZE, true);
+        } else if (delta < 0) {
+            ASSERT(count > 0);
+            if (--count == 0) {
+                memory.RasterizerMarkRegionCached(page << Memory::BORKED3DS_PAGE_BITS,
+                                                  Memory::BORKED3DS_PAGE_SIZE, false);
+                cached_pages.erase(page);
+            }
+        }
+    }
+}
+
+} // namespace SwRenderer
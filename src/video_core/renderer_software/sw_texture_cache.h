@@ -0,0 +1,76 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "common/common_types.h"
+#include "common/vector_math.h"
+#include "video_core/texture/texture_decode.h"
+
+namespace Memory {
+class MemorySystem;
+}
+
+namespace SwRenderer {
+
+/// A texture level decoded to linear RGBA8, indexed with the same (s, t) used by LookupTexture.
+struct DecodedTexture {
+    PAddr address;
+    u32 size;
+    u32 width;
+    u32 height;
+    std::vector<Common::Vec4<u8>> texels;
+
+    [[nodiscard]] Common::Vec4<u8> Texel(u32 s, u32 t) const {
+        return texels[t * width + s];
+    }
+};
+
+/**
+ * Keeps decoded copies of the textures sampled by the software rasterizer. Guest pages backing
+ * a decoded texture are marked as rasterizer cached, so CPU writes reach InvalidateRegion and
+ * drop the stale copy.
+ *
+ * Marking pages rewrites the page tables the CPU is running on, which is only safe on the
+ * emulation thread. A cache created for another thread is disabled and caches nothing.
+ */
+class TextureCache {
+public:
+    explicit TextureCache(Memory::MemorySystem& memory, bool enabled = true);
+    ~TextureCache();
+
+    /// Returns the decoded texture described by info, decoding it on first use.
+    /// Returns nullptr when the texture cannot be cached or the cache is disabled.
+    const DecodedTexture* GetTexture(const Pica::Texture::TextureInfo& info);
+
+    /// Removes all textures overlapping the provided region. Returns true if any was removed.
+    bool InvalidateRegion(PAddr addr, u32 size);
+
+    /// Removes all textures from the cache.
+    void InvalidateAll();
+
+    /// Removes all textures if the decoded size exceeds the cache budget.
+    void EnforceBudget();
+
+private:
+    /// Increase/decrease the number of textures in pages touching the specified region
+    void UpdatePagesCachedCount(PAddr addr, u32 size, int delta);
+
+    using TextureMap = std::unordered_map<u64, std::unique_ptr<DecodedTexture>>;
+
+    /// Removes the texture pointed to by the iterator and returns the next one.
+    TextureMap::iterator Erase(TextureMap::iterator it);
+
+private:
+    Memory::MemorySystem& memory;
+    bool enabled;
+    TextureMap textures;
+    std::unordered_map<u32, u32> cached_pages;
+    std::size_t decoded_size{};
+};
+
+} // namespace SwRenderer
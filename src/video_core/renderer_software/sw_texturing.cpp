@@ -4,6 +4,7 @@
 // Refer to the license.txt file included.
 
 #include <algorithm>
+#include <utility>
 #include "common/assert.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
@@ -110,65 +111,25 @@ Common::Vec3<u8> ColorCombine(TevStageConfig::Operation op,
 
     switch (op) {
     case Operation::Replace:
-        return input[0];
+        return ColorCombine<Operation::Replace>(input);
     case Operation::Modulate:
-        return ((input[0] * input[1]) / 255).Cast<u8>();
-    case Operation::Add: {
-        auto result = input[0] + input[1];
-        result.r() = std::min(255, result.r());
-        result.g() = std::min(255, result.g());
-        result.b() = std::min(255, result.b());
-        return result.Cast<u8>();
-    }
-    case Operation::AddSigned: {
-        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to
-        // (byte) 128 is correct
-        Common::Vec3i result =
-            input[0].Cast<s32>() + input[1].Cast<s32>() - Common::MakeVec<s32>(128, 128, 128);
-        result.r() = std::clamp<s32>(result.r(), 0, 255);
-        result.g() = std::clamp<s32>(result.g(), 0, 255);
-        result.b() = std::clamp<s32>(result.b(), 0, 255);
-        return result.Cast<u8>();
-    }
+        return ColorCombine<Operation::Modulate>(input);
+    case Operation::Add:
+        return ColorCombine<Operation::Add>(input);
+    case Operation::AddSigned:
+        return ColorCombine<Operation::AddSigned>(input);
     case Operation::Lerp:
-        return ((input[0] * input[2] +
-                 input[1] * (Common::MakeVec<u8>(255, 255, 255) - input[2]).Cast<u8>()) /
-                255)
-            .Cast<u8>();
-    case Operation::Subtract: {
-        auto result = input[0].Cast<s32>() - input[1].Cast<s32>();
-        result.r() = std::max(0, result.r());
-        result.g() = std::max(0, result.g());
-        result.b() = std::max(0, result.b());
-        return result.Cast<u8>();
-    }
-    case Operation::MultiplyThenAdd: {
-        auto result = (input[0] * input[1] + 255 * input[2].Cast<s32>()) / 255;
-        result.r() = std::min(255, result.r());
-        result.g() = std::min(255, result.g());
-        result.b() = std::min(255, result.b());
-        return result.Cast<u8>();
-    }
-    case Operation::AddThenMultiply: {
-        auto result = input[0] + input[1];
-        result.r() = std::min(255, result.r());
-        result.g() = std::min(255, result.g());
-        result.b() = std::min(255, result.b());
-        result = (result * input[2].Cast<s32>()) / 255;
-        return result.Cast<u8>();
-    }
+        return ColorCombine<Operation::Lerp>(input);
+    case Operation::Subtract:
+        return ColorCombine<Operation::Subtract>(input);
+    case Operation::MultiplyThenAdd:
+        return ColorCombine<Operation::MultiplyThenAdd>(input);
+    case Operation::AddThenMultiply:
+        return ColorCombine<Operation::AddThenMultiply>(input);
     case Operation::Dot3_RGB:
-    case Operation::Dot3_RGBA: {
-        // Not fully accurate.  Worst case scenario seems to yield a +/-3 error.  Some HW results
-        // indicate that the per-component computation can't have a higher precision than 1/256,
-        // while dot3_rgb((0x80,g0,b0), (0x7F,g1,b1)) and dot3_rgb((0x80,g0,b0), (0x80,g1,b1)) give
-        // different results.
-        s32 result = ((input[0].r() * 2 - 255) * (input[1].r() * 2 - 255) + 128) / 256 +
-                     ((input[0].g() * 2 - 255) * (input[1].g() * 2 - 255) + 128) / 256 +
-                     ((input[0].b() * 2 - 255) * (input[1].b() * 2 - 255) + 128) / 256;
-        result = std::clamp(result, 0, 255);
-        return Common::Vec3{result, result, result}.Cast<u8>();
-    }
+        return ColorCombine<Operation::Dot3_RGB>(input);
+    case Operation::Dot3_RGBA:
+        return ColorCombine<Operation::Dot3_RGBA>(input);
     default:
         LOG_ERROR(HW_GPU, "Unknown color combiner operation {}", (int)op);
         UNIMPLEMENTED();
@@ -180,24 +141,21 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     switch (op) {
         using Operation = TevStageConfig::Operation;
     case Operation::Replace:
-        return input[0];
+        return AlphaCombine<Operation::Replace>(input);
     case Operation::Modulate:
-        return input[0] * input[1] / 255;
+        return AlphaCombine<Operation::Modulate>(input);
     case Operation::Add:
-        return std::min(255, input[0] + input[1]);
-    case Operation::AddSigned: {
-        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to (byte) 128 is correct
-        auto result = static_cast<s32>(input[0]) + static_cast<s32>(input[1]) - 128;
-        return static_cast<u8>(std::clamp<s32>(result, 0, 255));
-    }
+        return AlphaCombine<Operation::Add>(input);
+    case Operation::AddSigned:
+        return AlphaCombine<Operation::AddSigned>(input);
     case Operation::Lerp:
-        return (input[0] * input[2] + input[1] * (255 - input[2])) / 255;
+        return AlphaCombine<Operation::Lerp>(input);
     case Operation::Subtract:
-        return std::max(0, static_cast<s32>(input[0]) - static_cast<s32>(input[1]));
+        return AlphaCombine<Operation::Subtract>(input);
     case Operation::MultiplyThenAdd:
-        return std::min(255, (input[0] * input[1] + 255 * input[2]) / 255);
+        return AlphaCombine<Operation::MultiplyThenAdd>(input);
     case Operation::AddThenMultiply:
-        return (std::min(255, (input[0] + input[1])) * input[2]) / 255;
+        return AlphaCombine<Operation::AddThenMultiply>(input);
     default:
         LOG_ERROR(HW_GPU, "Unknown alpha combiner operation {}", (int)op);
         UNIMPLEMENTED();
@@ -205,4 +163,42 @@ u8 AlphaCombine(TevStageConfig::Operation op, const std::array<u8, 3>& input) {
     }
 };
 
+namespace {
+
+// The enums below are stored in 4 or 3 bit register fields. Every raw value gets an entry, so
+// invalid values keep the behaviour of the generic functions.
+
+template <TevStageConfig::ColorModifier factor>
+Common::Vec3<u8> ColorModifierImpl(const Common::Vec4<u8>& values) {
+    return GetColorModifier(factor, values);
+}
+
+template <TevStageConfig::AlphaModifier factor>
+u8 AlphaModifierImpl(const Common::Vec4<u8>& values) {
+    return GetAlphaModifier(factor, values);
+}
+
+template <std::size_t... I>
+constexpr auto MakeColorModifierTable(std::index_sequence<I...>) {
+    return std::array{&ColorModifierImpl<static_cast<TevStageConfig::ColorModifier>(I)>...};
+}
+
+template <std::size_t... I>
+constexpr auto MakeAlphaModifierTable(std::index_sequence<I...>) {
+    return std::array{&AlphaModifierImpl<static_cast<TevStageConfig::AlphaModifier>(I)>...};
+}
+
+constexpr auto COLOR_MODIFIER_TABLE = MakeColorModifierTable(std::make_index_sequence<16>{});
+constexpr auto ALPHA_MODIFIER_TABLE = MakeAlphaModifierTable(std::make_index_sequence<8>{});
+
+} // Anonymous namespace
+
+ColorModifierFunc GetColorModifierFunc(TevStageConfig::ColorModifier factor) {
+    return COLOR_MODIFIER_TABLE[static_cast<u32>(factor) & 0xF];
+}
+
+AlphaModifierFunc GetAlphaModifierFunc(TevStageConfig::AlphaModifier factor) {
+    return ALPHA_MODIFIER_TABLE[static_cast<u32>(factor) & 0x7];
+}
+
 } // namespace SwRenderer
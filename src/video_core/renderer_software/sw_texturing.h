@@ -5,8 +5,11 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <span>
 
+#include "common/common_funcs.h"
 #include "common/common_types.h"
 #include "common/vector_math.h"
 #include "video_core/pica/regs_texturing.h"
@@ -26,4 +29,102 @@ Common::Vec3<u8> ColorCombine(Pica::TexturingRegs::TevStageConfig::Operation op,
 
 u8 AlphaCombine(Pica::TexturingRegs::TevStageConfig::Operation op, const std::array<u8, 3>& input);
 
+/// ColorCombine for an operation known at compile time, which callers can inline.
+template <Pica::TexturingRegs::TevStageConfig::Operation op>
+FORCE_INLINE Common::Vec3<u8> ColorCombine(std::span<const Common::Vec3<u8>, 3> input) {
+    using Operation = Pica::TexturingRegs::TevStageConfig::Operation;
+
+    if constexpr (op == Operation::Replace) {
+        return input[0];
+    } else if constexpr (op == Operation::Modulate) {
+        return ((input[0] * input[1]) / 255).Cast<u8>();
+    } else if constexpr (op == Operation::Add) {
+        auto result = input[0] + input[1];
+        result.r() = std::min(255, result.r());
+        result.g() = std::min(255, result.g());
+        result.b() = std::min(255, result.b());
+        return result.Cast<u8>();
+    } else if constexpr (op == Operation::AddSigned) {
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to
+        // (byte) 128 is correct
+        Common::Vec3i result =
+            input[0].Cast<s32>() + input[1].Cast<s32>() - Common::MakeVec<s32>(128, 128, 128);
+        result.r() = std::clamp<s32>(result.r(), 0, 255);
+        result.g() = std::clamp<s32>(result.g(), 0, 255);
+        result.b() = std::clamp<s32>(result.b(), 0, 255);
+        return result.Cast<u8>();
+    } else if constexpr (op == Operation::Lerp) {
+        return ((input[0] * input[2] +
+                 input[1] * (Common::MakeVec<u8>(255, 255, 255) - input[2]).Cast<u8>()) /
+                255)
+            .Cast<u8>();
+    } else if constexpr (op == Operation::Subtract) {
+        auto result = input[0].Cast<s32>() - input[1].Cast<s32>();
+        result.r() = std::max(0, result.r());
+        result.g() = std::max(0, result.g());
+        result.b() = std::max(0, result.b());
+        return result.Cast<u8>();
+    } else if constexpr (op == Operation::MultiplyThenAdd) {
+        auto result = (input[0] * input[1] + 255 * input[2].Cast<s32>()) / 255;
+        result.r() = std::min(255, result.r());
+        result.g() = std::min(255, result.g());
+        result.b() = std::min(255, result.b());
+        return result.Cast<u8>();
+    } else if constexpr (op == Operation::AddThenMultiply) {
+        auto result = input[0] + input[1];
+        result.r() = std::min(255, result.r());
+        result.g() = std::min(255, result.g());
+        result.b() = std::min(255, result.b());
+        result = (result * input[2].Cast<s32>()) / 255;
+        return result.Cast<u8>();
+    } else {
+        static_assert(op == Operation::Dot3_RGB || op == Operation::Dot3_RGBA);
+        // Not fully accurate.  Worst case scenario seems to yield a +/-3 error.  Some HW results
+        // indicate that the per-component computation can't have a higher precision than 1/256,
+        // while dot3_rgb((0x80,g0,b0), (0x7F,g1,b1)) and dot3_rgb((0x80,g0,b0), (0x80,g1,b1)) give
+        // different results.
+        s32 result = ((input[0].r() * 2 - 255) * (input[1].r() * 2 - 255) + 128) / 256 +
+                     ((input[0].g() * 2 - 255) * (input[1].g() * 2 - 255) + 128) / 256 +
+                     ((input[0].b() * 2 - 255) * (input[1].b() * 2 - 255) + 128) / 256;
+        result = std::clamp(result, 0, 255);
+        return Common::Vec3{result, result, result}.Cast<u8>();
+    }
+}
+
+/// AlphaCombine for an operation known at compile time, which callers can inline.
+template <Pica::TexturingRegs::TevStageConfig::Operation op>
+FORCE_INLINE u8 AlphaCombine(const std::array<u8, 3>& input) {
+    using Operation = Pica::TexturingRegs::TevStageConfig::Operation;
+
+    if constexpr (op == Operation::Replace) {
+        return input[0];
+    } else if constexpr (op == Operation::Modulate) {
+        return input[0] * input[1] / 255;
+    } else if constexpr (op == Operation::Add) {
+        return std::min(255, input[0] + input[1]);
+    } else if constexpr (op == Operation::AddSigned) {
+        // TODO(bunnei): Verify that the color conversion from (float) 0.5f to (byte) 128 is correct
+        auto result = static_cast<s32>(input[0]) + static_cast<s32>(input[1]) - 128;
+        return static_cast<u8>(std::clamp<s32>(result, 0, 255));
+    } else if constexpr (op == Operation::Lerp) {
+        return (input[0] * input[2] + input[1] * (255 - input[2])) / 255;
+    } else if constexpr (op == Operation::Subtract) {
+        return std::max(0, static_cast<s32>(input[0]) - static_cast<s32>(input[1]));
+    } else if constexpr (op == Operation::MultiplyThenAdd) {
+        return std::min(255, (input[0] * input[1] + 255 * input[2]) / 255);
+    } else {
+        static_assert(op == Operation::AddThenMultiply);
+        return (std::min(255, (input[0] + input[1])) * input[2]) / 255;
+    }
+}
+
+using ColorModifierFunc = Common::Vec3<u8> (*)(const Common::Vec4<u8>& values);
+using AlphaModifierFunc = u8 (*)(const Common::Vec4<u8>& values);
+
+/// Returns GetColorModifier specialized for the provided factor.
+ColorModifierFunc GetColorModifierFunc(Pica::TexturingRegs::TevStageConfig::ColorModifier factor);
+
+/// Returns GetAlphaModifier specialized for the provided factor.
+AlphaModifierFunc GetAlphaModifierFunc(Pica::TexturingRegs::TevStageConfig::AlphaModifier factor);
+
 } // namespace SwRenderer
@@ -6,10 +6,13 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "common/common_types.h"
+#include "video_core/pica/output_vertex.h"
 
 namespace Pica {
 
+struct ShaderRegs;
 struct ShaderSetup;
 struct ShaderUnit;
 
@@ -30,6 +33,29 @@ public:
      * @param state Shader unit state, must be setup with input data before each shader invocation.
      */
     virtual void Run(const ShaderSetup& setup, ShaderUnit& state) const = 0;
+
+    /**
+     * Runs the currently setup shader for several vertices on a single unit, amortizing the
+     * per-invocation dispatch and setup costs over the batch. The unit keeps its registers from
+     * one invocation to the next, so only the inputs and outputs are copied per vertex.
+     *
+     * @param setup Shader engine state, must be setup with SetupBatch on each shader change.
+     * @param config Shader configuration mapping the attributes to the input and output registers.
+     * @param state Shader unit state, left with the registers of the last invocation.
+     * @param inputs Input attributes of each invocation.
+     * @param outputs Destination of the output attributes of each invocation.
+     */
+    virtual void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                          std::span<const AttributeBuffer> inputs,
+                          std::span<AttributeBuffer* const> outputs) const = 0;
+
+    /**
+     * Loads the shaders recorded for the title in previous sessions, so that engines which
+     * compile shaders can prepare them ahead of their first use.
+     *
+     * @param title_id Program ID of the running title.
+     */
+    virtual void LoadDiskCache([[maybe_unused]] u64 title_id) {}
 };
 
 std::unique_ptr<ShaderEngine> CreateEngine(bool use_jit);
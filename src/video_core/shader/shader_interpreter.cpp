@@ -45,12 +45,27 @@ struct LoopStackElement {
     u8 previous_aL;
 };
 
+/// Flow control stacks of a shader invocation, reusable across invocations to avoid allocations.
+struct ControlStacks {
+    boost::circular_buffer<IfStackElement> if_stack{8};
+    boost::circular_buffer<CallStackElement> call_stack{4};
+    boost::circular_buffer<LoopStackElement> loop_stack{4};
+
+    void Clear() {
+        if_stack.clear();
+        call_stack.clear();
+        loop_stack.clear();
+    }
+};
+
 template <bool Debug>
 static void RunInterpreter(const ShaderSetup& setup, ShaderUnit& state,
-                           DebugData<Debug>& debug_data, unsigned entry_point) {
-    boost::circular_buffer<IfStackElement> if_stack(8);
-    boost::circular_buffer<CallStackElement> call_stack(4);
-    boost::circular_buffer<LoopStackElement> loop_stack(4);
+                           DebugData<Debug>& debug_data, ControlStacks& stacks,
+                           unsigned entry_point) {
+    stacks.Clear();
+    auto& if_stack = stacks.if_stack;
+    auto& call_stack = stacks.call_stack;
+    auto& loop_stack = stacks.loop_stack;
     u32 program_counter = entry_point;
 
     const auto do_if = [&](Instruction instr, bool condition) {
@@ -730,7 +745,22 @@ void InterpreterEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     BORKED3DS_PROFILE("Shader", "Shader Interpreter");
 
     DebugData<false> dummy_debug_data;
-    RunInterpreter(setup, state, dummy_debug_data, setup.entry_point);
+    ControlStacks stacks;
+    RunInterpreter(setup, state, dummy_debug_data, stacks, setup.entry_point);
+}
+
+void InterpreterEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config,
+                                 ShaderUnit& state, std::span<const AttributeBuffer> inputs,
+                                 std::span<AttributeBuffer* const> outputs) const {
+    BORKED3DS_PROFILE("Shader", "Shader Interpreter");
+
+    DebugData<false> dummy_debug_data;
+    ControlStacks stacks;
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        state.LoadInput(config, inputs[i]);
+        RunInterpreter(setup, state, dummy_debug_data, stacks, setup.entry_point);
+        state.WriteOutput(config, *outputs[i]);
+    }
 }
 
 DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
@@ -742,7 +772,8 @@ DebugData<true> InterpreterEngine::ProduceDebugInfo(const ShaderSetup& setup,
     // Setup input register table
     state.input.fill(Common::Vec4<f24>::AssignToAll(f24::Zero()));
     state.LoadInput(config, input);
-    RunInterpreter(setup, state, debug_data, setup.entry_point);
+    ControlStacks stacks;
+    RunInterpreter(setup, state, debug_data, stacks, setup.entry_point);
     return debug_data;
 }
 
@@ -6,11 +6,15 @@
 #include "common/arch.h"
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 
+#include <algorithm>
+#include <chrono>
 #include "common/assert.h"
 #include "common/hash.h"
+#include "common/logging/log.h"
 #include "common/profiling.h"
 #include "video_core/shader/shader.h"
 #include "video_core/shader/shader_jit.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
 #if BORKED3DS_ARCH(arm64)
 #include "video_core/shader/shader_jit_a64_compiler.h"
 #endif
@@ -20,8 +24,26 @@
 
 namespace Pica::Shader {
 
-JitEngine::JitEngine() = default;
-JitEngine::~JitEngine() = default;
+/// Snapshot of the shader program handed to the compile worker.
+struct JitEngine::CompileJob {
+    ProgramCode program_code;
+    SwizzleData swizzle_data;
+    std::unique_ptr<JitShader> shader;
+    std::atomic<bool> done{};
+};
+
+JitEngine::JitEngine(std::size_t capacity_)
+    // Keep at least the vertex and geometry shaders of the current draw resident.
+    : capacity{std::max<std::size_t>(capacity_, 2)}, compile_worker{1, "ShaderJit"} {}
+
+JitEngine::~JitEngine() {
+    const Stats stats = GetStats();
+    LOG_DEBUG(HW_GPU,
+              "Shader JIT: {} hits, {} misses, {} evictions, {} interpreted batches, {} shaders "
+              "compiled in {} us, {} loaded from disk",
+              stats.cache_hits, stats.cache_misses, stats.evictions, stats.interpreted_batches,
+              stats.compiled_shaders, stats.compile_time_us, stats.disk_cache_entries);
+}
 
 void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     ASSERT(entry_point < MAX_PROGRAM_CODE_LENGTH);
@@ -31,19 +53,113 @@ void JitEngine::SetupBatch(ShaderSetup& setup, u32 entry_point) {
     const u64 swizzle_hash = setup.GetSwizzleDataHash();
 
     const u64 cache_key = Common::HashCombine(code_hash, swizzle_hash);
-    auto iter = cache.find(cache_key);
-    if (iter != cache.end()) {
-        setup.cached_shader = iter->second.get();
-    } else {
+    if (const auto iter = cache.find(cache_key); iter != cache.end()) {
+        lru.splice(lru.begin(), lru, iter->second);
+        setup.cached_shader = iter->second->shader.get();
+        cache_hits.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Until the shader has been compiled, batches using it are run by the interpreter.
+    setup.cached_shader = nullptr;
+
+    if (const auto iter = pending.find(cache_key); iter != pending.end()) {
+        if (iter->second->done.load(std::memory_order_acquire)) {
+            setup.cached_shader = Insert(cache_key, std::move(iter->second->shader));
+            pending.erase(iter);
+        }
+        return;
+    }
+
+    cache_misses.fetch_add(1, std::memory_order_relaxed);
+    auto job = std::make_shared<CompileJob>();
+    job->program_code = setup.program_code;
+    job->swizzle_data = setup.swizzle_data;
+    QueueCompile(cache_key, std::move(job), true);
+}
+
+void JitEngine::LoadDiskCache(u64 title_id) {
+    if (title_id == 0) {
+        return;
+    }
+
+    disk_cache = std::make_unique<JitDiskCache>(JitDiskCache::GetPath(title_id));
+    const std::vector<JitDiskCache::Entry> entries = disk_cache->Load();
+
+    // Only precompile as many of the most recently recorded shaders as the cache can hold.
+    const std::size_t first = entries.size() > capacity ? entries.size() - capacity : 0;
+    for (std::size_t i = first; i < entries.size(); i++) {
+        const JitDiskCache::Entry& entry = entries[i];
+        if (cache.contains(entry.key) || pending.contains(entry.key)) {
+            continue;
+        }
+        auto job = std::make_shared<CompileJob>();
+        job->program_code = entry.program_code;
+        job->swizzle_data = entry.swizzle_data;
+        QueueCompile(entry.key, std::move(job), false);
+        disk_cache_entries.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void JitEngine::QueueCompile(u64 key, std::shared_ptr<CompileJob> job, bool record) {
+    pending.emplace(key, job);
+
+    compile_worker.QueueWork([this, key, job, record] {
+        const auto start = std::chrono::steady_clock::now();
         auto shader = std::make_unique<JitShader>();
-        shader->Compile(&setup.program_code, &setup.swizzle_data);
-        setup.cached_shader = shader.get();
-        cache.emplace_hint(iter, cache_key, std::move(shader));
+        shader->Compile(&job->program_code, &job->swizzle_data);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        compile_time_us.fetch_add(
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count(),
+            std::memory_order_relaxed);
+        compiled_shaders.fetch_add(1, std::memory_order_relaxed);
+
+        // The disk cache is only written from the compile worker.
+        if (record && disk_cache) {
+            disk_cache->Append(key, job->program_code, job->swizzle_data);
+        }
+
+        job->shader = std::move(shader);
+        job->done.store(true, std::memory_order_release);
+    });
+}
+
+JitShader* JitEngine::Insert(u64 key, std::unique_ptr<JitShader> shader) {
+    while (cache.size() >= capacity) {
+        cache.erase(lru.back().key);
+        lru.pop_back();
+        evictions.fetch_add(1, std::memory_order_relaxed);
     }
+
+    JitShader* const result = shader.get();
+    lru.push_front(CacheEntry{key, std::move(shader)});
+    cache.emplace(key, lru.begin());
+    return result;
+}
+
+void JitEngine::WaitForCompilation() {
+    compile_worker.WaitForRequests();
+}
+
+JitEngine::Stats JitEngine::GetStats() const {
+    return Stats{
+        .cache_hits = cache_hits.load(std::memory_order_relaxed),
+        .cache_misses = cache_misses.load(std::memory_order_relaxed),
+        .evictions = evictions.load(std::memory_order_relaxed),
+        .interpreted_batches = interpreted_batches.load(std::memory_order_relaxed),
+        .compiled_shaders = compiled_shaders.load(std::memory_order_relaxed),
+        .compile_time_us = compile_time_us.load(std::memory_order_relaxed),
+        .disk_cache_entries = disk_cache_entries.load(std::memory_order_relaxed),
+    };
 }
 
 void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
-    ASSERT(setup.cached_shader != nullptr);
+    if (!setup.cached_shader) {
+        interpreted_batches.fetch_add(1, std::memory_order_relaxed);
+        interpreter.Run(setup, state);
+        return;
+    }
 
     BORKED3DS_PROFILE("Shader", "Shader JIT");
 
@@ -51,6 +167,25 @@ void JitEngine::Run(const ShaderSetup& setup, ShaderUnit& state) const {
     shader->Run(setup, state, setup.entry_point);
 }
 
+void JitEngine::RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                         std::span<const AttributeBuffer> inputs,
+                         std::span<AttributeBuffer* const> outputs) const {
+    if (!setup.cached_shader) {
+        interpreted_batches.fetch_add(1, std::memory_order_relaxed);
+        interpreter.RunBatch(setup, config, state, inputs, outputs);
+        return;
+    }
+
+    BORKED3DS_PROFILE("Shader", "Shader JIT");
+
+    const JitShader* shader = static_cast<const JitShader*>(setup.cached_shader);
+    for (std::size_t i = 0; i < inputs.size(); ++i) {
+        state.LoadInput(config, inputs[i]);
+        shader->Run(setup, state, setup.entry_point);
+        state.WriteOutput(config, *outputs[i]);
+    }
+}
+
 } // namespace Pica::Shader
 
 #endif // BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
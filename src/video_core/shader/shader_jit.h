@@ -8,25 +8,86 @@
 #include "common/arch.h"
 #if BORKED3DS_ARCH(x86_64) || BORKED3DS_ARCH(arm64)
 
+#include <atomic>
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include "common/common_types.h"
+#include "common/thread_worker.h"
 #include "video_core/shader/shader.h"
+#include "video_core/shader/shader_interpreter.h"
 
 namespace Pica::Shader {
 
+class JitDiskCache;
 class JitShader;
 
+/// Number of compiled shaders kept by the JIT engine before the least recently used are evicted.
+constexpr std::size_t DefaultJitCacheCapacity = 1024;
+
+/**
+ * Shader engine that runs shaders compiled to host code. Shaders are compiled on a background
+ * worker; batches that use a shader that is not ready yet are run by the interpreter instead.
+ */
 class JitEngine final : public ShaderEngine {
 public:
-    JitEngine();
+    struct Stats {
+        u64 cache_hits;
+        u64 cache_misses;
+        u64 evictions;
+        u64 interpreted_batches;
+        u64 compiled_shaders;
+        u64 compile_time_us;
+        u64 disk_cache_entries;
+    };
+
+    explicit JitEngine(std::size_t capacity = DefaultJitCacheCapacity);
     ~JitEngine() override;
 
     void SetupBatch(ShaderSetup& setup, u32 entry_point) override;
     void Run(const ShaderSetup& setup, ShaderUnit& state) const override;
+    void RunBatch(const ShaderSetup& setup, const ShaderRegs& config, ShaderUnit& state,
+                  std::span<const AttributeBuffer> inputs,
+                  std::span<AttributeBuffer* const> outputs) const override;
+    void LoadDiskCache(u64 title_id) override;
+
+    /// Blocks until all queued shader compilations have finished.
+    void WaitForCompilation();
+
+    /// Returns a snapshot of the cache and compilation counters.
+    [[nodiscard]] Stats GetStats() const;
 
 private:
-    std::unordered_map<u64, std::unique_ptr<JitShader>> cache;
+    struct CompileJob;
+
+    struct CacheEntry {
+        u64 key;
+        std::unique_ptr<JitShader> shader;
+    };
+
+    /// Queues the compilation of a shader program on the compile worker.
+    void QueueCompile(u64 key, std::shared_ptr<CompileJob> job, bool record);
+
+    /// Moves a finished compilation into the cache, evicting the least recently used entries.
+    JitShader* Insert(u64 key, std::unique_ptr<JitShader> shader);
+
+    std::size_t capacity;
+    std::list<CacheEntry> lru;
+    std::unordered_map<u64, std::list<CacheEntry>::iterator> cache;
+    std::unordered_map<u64, std::shared_ptr<CompileJob>> pending;
+    InterpreterEngine interpreter;
+    std::unique_ptr<JitDiskCache> disk_cache;
+
+    std::atomic<u64> cache_hits{};
+    std::atomic<u64> cache_misses{};
+    std::atomic<u64> evictions{};
+    mutable std::atomic<u64> interpreted_batches{};
+    std::atomic<u64> compiled_shaders{};
+    std::atomic<u64> compile_time_us{};
+    std::atomic<u64> disk_cache_entries{};
+
+    /// Declared last so that queued compilations stop before the state they use is destroyed.
+    Common::ThreadWorker compile_worker;
 };
 
 } // namespace Pica::Shader
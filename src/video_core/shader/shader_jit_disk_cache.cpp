@@ -0,0 +1,255 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include "common/arch.h"
+#include "common/common_paths.h"
+#include "common/hash.h"
+#include "common/logging/log.h"
+#include "common/scm_rev.h"
+#include "video_core/shader/shader_jit_disk_cache.h"
+
+namespace Pica::Shader {
+
+namespace {
+
+constexpr u32 CacheMagic = 0x5449'4A50; // "PJIT"
+constexpr u32 CacheVersion = 2;
+
+#if BORKED3DS_ARCH(x86_64)
+constexpr u32 HostIsa = 1;
+#elif BORKED3DS_ARCH(arm64)
+constexpr u32 HostIsa = 2;
+#else
+constexpr u32 HostIsa = 0;
+#endif
+
+struct CacheHeader {
+    u32 magic;
+    u32 version;
+    u32 host_isa;
+    u32 reserved;
+    u64 build_revision;
+};
+static_assert(sizeof(CacheHeader) == 24, "CacheHeader has incorrect size");
+
+struct EntryHeader {
+    u64 key;
+    u32 program_code_length;
+    u32 swizzle_data_length;
+};
+static_assert(sizeof(EntryHeader) == 16, "EntryHeader has incorrect size");
+
+/// Returns the number of words up to and including the last non-zero one.
+template <std::size_t N>
+u32 TrimmedLength(const std::array<u32, N>& data) {
+    const auto last = std::find_if(data.rbegin(), data.rend(), [](u32 word) { return word != 0; });
+    return static_cast<u32>(std::distance(last, data.rend()));
+}
+
+/// Returns the number of bytes the entry takes in the cache file.
+std::size_t EntrySize(const ProgramCode& program_code, const SwizzleData& swizzle_data) {
+    return sizeof(EntryHeader) +
+           (TrimmedLength(program_code) + TrimmedLength(swizzle_data)) * sizeof(u32);
+}
+
+/// Identifies the build, as programs recorded by other builds may no longer be wanted.
+u64 BuildRevision() {
+    return Common::ComputeHash64(Common::g_scm_rev, std::strlen(Common::g_scm_rev));
+}
+
+} // Anonymous namespace
+
+JitDiskCache::JitDiskCache(std::string path_, std::size_t max_size_)
+    : path{std::move(path_)}, max_size{max_size_} {}
+
+JitDiskCache::~JitDiskCache() = default;
+
+std::vector<JitDiskCache::Entry> JitDiskCache::Load() {
+    std::vector<Entry> entries;
+    std::size_t valid_size = sizeof(CacheHeader);
+    stored_keys.clear();
+
+    FileUtil::IOFile in{path, "rb"};
+    CacheHeader header{};
+    if (!in.IsOpen() || in.ReadBytes(&header, sizeof(header)) != sizeof(header) ||
+        header.magic != CacheMagic || header.version != CacheVersion ||
+        header.host_isa != HostIsa || header.build_revision != BuildRevision()) {
+        if (in.IsOpen()) {
+            LOG_INFO(HW_GPU, "Shader JIT disk cache {} is outdated, discarding", path);
+        }
+        in.Close();
+        Reset();
+        return entries;
+    }
+
+    while (true) {
+        EntryHeader entry_header{};
+        if (in.ReadBytes(&entry_header, sizeof(entry_header)) != sizeof(entry_header)) {
+            break;
+        }
+        if (entry_header.program_code_length > MAX_PROGRAM_CODE_LENGTH ||
+            entry_header.swizzle_data_length > MAX_SWIZZLE_DATA_LENGTH) {
+            break;
+        }
+
+        Entry& entry = entries.emplace_back();
+        entry.key = entry_header.key;
+        entry.program_code.fill(0);
+        entry.swizzle_data.fill(0);
+        if (in.ReadArray(entry.program_code.data(), entry_header.program_code_length) !=
+                entry_header.program_code_length ||
+            in.ReadArray(entry.swizzle_data.data(), entry_header.swizzle_data_length) !=
+                entry_header.swizzle_data_length) {
+            entries.pop_back();
+            break;
+        }
+
+        // Drop entries whose key does not match their contents.
+        const u64 key =
+            Common::HashCombine(Common::ComputeHash64(&entry.program_code, sizeof(ProgramCode)),
+                                Common::ComputeHash64(&entry.swizzle_data, sizeof(SwizzleData)));
+        if (key != entry.key) {
+            entries.pop_back();
+            break;
+        }
+        valid_size = static_cast<std::size_t>(in.Tell());
+    }
+    in.Close();
+
+    // Keep the most recently recorded programs that fit in half of the maximum size once the
+    // file is nearly full, so that the session can record its programs. Files written before
+    // keys were deduplicated are compacted as well.
+    const bool has_duplicates = [&] {
+        std::unordered_set<u64> keys;
+        return !std::all_of(entries.begin(), entries.end(),
+                            [&](const Entry& entry) { return keys.insert(entry.key).second; });
+    }();
+    if (has_duplicates || valid_size > max_size / 4 * 3) {
+        std::vector<Entry> kept;
+        std::unordered_set<u64> kept_keys;
+        std::size_t kept_size = sizeof(CacheHeader);
+        for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+            if (kept_keys.contains(it->key)) {
+                continue;
+            }
+            const std::size_t entry_size = EntrySize(it->program_code, it->swizzle_data);
+            if (kept_size + entry_size > max_size / 2) {
+                break;
+            }
+            kept_keys.insert(it->key);
+            kept_size += entry_size;
+            kept.push_back(std::move(*it));
+        }
+        std::reverse(kept.begin(), kept.end());
+
+        LOG_INFO(HW_GPU, "Compacting shader JIT disk cache {} from {} to {} shaders", path,
+                 entries.size(), kept.size());
+        entries = std::move(kept);
+        if (!Compact(entries)) {
+            return entries;
+        }
+    } else {
+        // Cut off anything after the last valid entry, for example a partial write.
+        file = FileUtil::IOFile{path, "r+b"};
+        if (!file.IsOpen() || !file.Resize(valid_size) || !file.Seek(0, SEEK_END)) {
+            LOG_ERROR(HW_GPU, "Failed to open shader JIT disk cache {}", path);
+            file.Close();
+            return entries;
+        }
+        file_size = valid_size;
+    }
+
+    for (const Entry& entry : entries) {
+        stored_keys.insert(entry.key);
+    }
+    LOG_INFO(HW_GPU, "Loaded {} shaders from the shader JIT disk cache", entries.size());
+    return entries;
+}
+
+void JitDiskCache::Append(u64 key, const ProgramCode& program_code,
+                          const SwizzleData& swizzle_data) {
+    // Programs evicted from the JIT cache and compiled again are already stored.
+    if (!file.IsOpen() || stored_keys.contains(key)) {
+        return;
+    }
+
+    const std::size_t entry_size = EntrySize(program_code, swizzle_data);
+    if (file_size + entry_size > max_size) {
+        LOG_DEBUG(HW_GPU, "Shader JIT disk cache {} is full", path);
+        return;
+    }
+    if (!WriteEntry(key, program_code, swizzle_data)) {
+        LOG_ERROR(HW_GPU, "Failed to write to shader JIT disk cache {}", path);
+        file.Close();
+        return;
+    }
+    file.Flush();
+    file_size += entry_size;
+    stored_keys.insert(key);
+}
+
+std::string JitDiskCache::GetPath(u64 title_id) {
+    return fmt::format("{}jit" DIR_SEP "{:016X}.bin",
+                       FileUtil::GetUserPath(FileUtil::UserPath::ShaderDir), title_id);
+}
+
+bool JitDiskCache::Reset() {
+    const std::string dir = path.substr(0, path.find_last_of(DIR_SEP_CHR) + 1);
+    if (!FileUtil::CreateFullPath(dir)) {
+        LOG_ERROR(HW_GPU, "Failed to create directory {}", dir);
+        return false;
+    }
+
+    file = FileUtil::IOFile{path, "wb"};
+    const CacheHeader header{
+        .magic = CacheMagic,
+        .version = CacheVersion,
+        .host_isa = HostIsa,
+        .reserved = 0,
+        .build_revision = BuildRevision(),
+    };
+    if (!file.IsOpen() || file.WriteObject(header) != 1) {
+        LOG_ERROR(HW_GPU, "Failed to create shader JIT disk cache {}", path);
+        file.Close();
+        return false;
+    }
+    file.Flush();
+    file_size = sizeof(CacheHeader);
+    return true;
+}
+
+bool JitDiskCache::WriteEntry(u64 key, const ProgramCode& program_code,
+                              const SwizzleData& swizzle_data) {
+    const EntryHeader entry_header{
+        .key = key,
+        .program_code_length = TrimmedLength(program_code),
+        .swizzle_data_length = TrimmedLength(swizzle_data),
+    };
+    return file.WriteObject(entry_header) == 1 &&
+           file.WriteArray(program_code.data(), entry_header.program_code_length) ==
+               entry_header.program_code_length &&
+           file.WriteArray(swizzle_data.data(), entry_header.swizzle_data_length) ==
+               entry_header.swizzle_data_length;
+}
+
+bool JitDiskCache::Compact(const std::vector<Entry>& entries) {
+    if (!Reset()) {
+        return false;
+    }
+    for (const Entry& entry : entries) {
+        if (!WriteEntry(entry.key, entry.program_code, entry.swizzle_data)) {
+            LOG_ERROR(HW_GPU, "Failed to compact shader JIT disk cache {}", path);
+            file.Close();
+            return false;
+        }
+        file_size += EntrySize(entry.program_code, entry.swizzle_data);
+    }
+    file.Flush();
+    return true;
+}
+
+} // namespace Pica::Shader
@@ -0,0 +1,65 @@
+// Copyright 2024 Borked3DS Emulator Project
+// Licensed under GPLv2 or any later version
+// Refer to the license.txt file included.
+
+#pragma once
+
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "common/common_types.h"
+#include "common/file_util.h"
+#include "video_core/pica/shader_setup.h"
+
+namespace Pica::Shader {
+
+/**
+ * Per-title record of the shader programs the JIT has compiled. The programs are stored in their
+ * PICA form, keyed by the JIT cache key, so that the next session can compile them before they
+ * are first used. The file is discarded if it was written by a different build, for a different
+ * host ISA or in a different format.
+ *
+ * Every key is stored once and the file never grows past its maximum size. When loading a file
+ * that is close to the limit, only the most recently recorded programs are kept, to leave room
+ * for the programs of the session.
+ */
+class JitDiskCache {
+public:
+    static constexpr std::size_t DefaultMaxSize = 8 * 1024 * 1024;
+
+    struct Entry {
+        u64 key;
+        ProgramCode program_code;
+        SwizzleData swizzle_data;
+    };
+
+    explicit JitDiskCache(std::string path, std::size_t max_size = DefaultMaxSize);
+    ~JitDiskCache();
+
+    /// Reads all valid entries of the cache file, oldest first, and opens it for appending.
+    [[nodiscard]] std::vector<Entry> Load();
+
+    /// Appends a program to the cache file, unless its key is already stored or it does not fit.
+    void Append(u64 key, const ProgramCode& program_code, const SwizzleData& swizzle_data);
+
+    /// Returns the path of the cache file for the title.
+    [[nodiscard]] static std::string GetPath(u64 title_id);
+
+private:
+    /// Truncates the cache file and writes a fresh header.
+    bool Reset();
+
+    /// Writes an entry at the current position of the cache file.
+    bool WriteEntry(u64 key, const ProgramCode& program_code, const SwizzleData& swizzle_data);
+
+    /// Rewrites the cache file with the given entries only.
+    bool Compact(const std::vector<Entry>& entries);
+
+    std::string path;
+    std::size_t max_size;
+    FileUtil::IOFile file;
+    std::size_t file_size = 0;
+    std::unordered_set<u64> stored_keys;
+};
+
+} // namespace Pica::Shader